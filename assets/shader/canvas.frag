@@ -0,0 +1,23 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec3 fTexCoord;
+layout(location = 1) in vec4 fColor;
+
+layout(binding = 1) uniform sampler2D tex;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	// z of the texture coordinate selects how the page is sampled
+	if (fTexCoord.z < -0.5) {
+		// Solid color
+		outColor = fColor;
+	} else if (fTexCoord.z < 0.5) {
+		// Coverage in the red channel (font atlas)
+		outColor = vec4(fColor.rgb, fColor.a * texture(tex, fTexCoord.xy).r);
+	} else {
+		// Color image tinted by the vertex color
+		outColor = fColor * texture(tex, fTexCoord.xy);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec3 texCoord;
+layout(location = 2) in vec4 color;
+
+layout(binding = 0) uniform CameraUBO
+{
+	mat4 ortho;
+	mat4 baseView;
+} camera;
+
+layout(location = 0) out vec3 fTexCoord;
+layout(location = 1) out vec4 fColor;
+
+void main()
+{
+	// Positions are already transformed into the world on the cpu
+	gl_Position = camera.ortho * camera.baseView * vec4(position, 0.0, 1.0);
+	fTexCoord = texCoord;
+	fColor = color;
+}
\ No newline at end of file
@@ -5,12 +5,16 @@ layout(location = 0) in vec3 position;
 
 layout(binding = 0) uniform UBO
 {
-	mat4 ortho;
-	mat4 baseView;
 	mat4 world;
 } ubo;
 
+layout(binding = 2) uniform CameraUBO
+{
+	mat4 ortho;
+	mat4 baseView;
+} camera;
+
 void main()
 {
-	gl_Position = ubo.ortho * ubo.baseView * ubo.world * vec4(position, 1.0);
+	gl_Position = camera.ortho * camera.baseView * ubo.world * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include "coretools/Window.h"
 #include "coretools/Graphics.h"
 #include "vkcore/vulkanObject.h"
+#include "eeprofiler.h"
 
 
 /* @brief Foreward declaration of the high level resize method and definition of the user data we pass in */
@@ -70,13 +71,31 @@ void EEApplication::Draw(EEColor const& color)
 	m_pGraphics->Draw(color);
 }
 
-EEMesh EEApplication::CreateMesh(void const* pVertices, size_t amountVertices, std::vector<uint32_t> const& indices)
+EEMesh EEApplication::CreateMesh(void const* pVertices, size_t amountVertices, std::vector<uint32_t> const& indices, EEVertexInput const* pVertexInput)
 {
 	if (!isCreated) {
 		EE_PRINT("[EEAPPLICATION] Tried to create a mesh without a created application...!\n");
 		EE_INVARIANT(isCreated);
 	}
-	return m_pGraphics->CreateMesh(pVertices, amountVertices, indices);
+	return m_pGraphics->CreateMesh(pVertices, amountVertices, indices, pVertexInput);
+}
+
+EEMesh EEApplication::CreateMesh(char const* fileName)
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to create a mesh without a created application...!\n");
+		EE_INVARIANT(isCreated);
+	}
+	return m_pGraphics->CreateMesh(fileName);
+}
+
+EEMesh EEApplication::CreateMeshFromFile(char const* fileName)
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to create a mesh without a created application...!\n");
+		EE_INVARIANT(isCreated);
+	}
+	return m_pGraphics->CreateMeshFromFile(fileName);
 }
 
 EEBuffer EEApplication::CreateBuffer(size_t bufferSize)
@@ -142,11 +161,50 @@ void EEApplication::UpdateMesh(EEMesh mesh, void const* pVertices, size_t buffer
 	m_pGraphics->UpdateMesh(mesh, pVertices, bufferSize, indices);
 }
 
+bool EEApplication::UpdateMeshRange(EEMesh mesh, void const* pVertices, size_t offset, size_t size, uint32_t indexCount)
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to update a mesh range without a created application...!\n");
+		EE_INVARIANT(isCreated);
+	}
+	return m_pGraphics->UpdateMeshRange(mesh, pVertices, offset, size, indexCount);
+}
+
 void EEApplication::SetObjectVisibility(EEObject object, EEBool32 visible)
 {
 	m_pGraphics->currentObjects[*object]->isVisible = visible;
 }
 
+void EEApplication::SetObjectDrawRange(EEObject object, uint32_t firstIndex, uint32_t indexCount)
+{
+	m_pGraphics->currentObjects[*object]->firstIndex = firstIndex;
+	m_pGraphics->currentObjects[*object]->indexCount = indexCount;
+}
+
+void EEApplication::SetObjectTexture(EEObject object, uint32_t binding, EETexture texture)
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to set an object texture without a created application...!\n");
+		EE_INVARIANT(isCreated);
+	}
+	m_pGraphics->SetObjectTexture(object, binding, texture);
+}
+
+void EEApplication::SetObjectWorld(EEObject object, glm::mat4 const& world)
+{
+	m_pGraphics->currentObjects[*object]->world = world;
+}
+
+void EEApplication::SetCamera3D(glm::mat4 const& projection, glm::mat4 const& view)
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to set the 3d camera without creating the application!\n");
+		EE_INVARIANT(isCreated);
+	}
+	m_pGraphics->camera3D.viewProjection = projection * view;
+	m_pGraphics->camera3D.isSet = true;
+}
+
 bool EEApplication::IsWindowFocused()
 {
 	if (!isCreated) {
@@ -211,9 +269,9 @@ bool EEApplication::KeyPressed(EEKey key)
 	return m_pWindow->input.keysPressed[key];
 }
 
-uint32_t EEApplication::TextInput()
+uint32_t EEApplication::TextInput(uint32_t index)
 {
-	return m_pWindow->input.textUTF8;
+	return (index < m_pWindow->input.textUTF8.size()) ? m_pWindow->input.textUTF8[index] : 0u;
 }
 
 EEPoint64F EEApplication::MousePosition()
@@ -223,7 +281,7 @@ EEPoint64F EEApplication::MousePosition()
 
 EEPoint64F EEApplication::MouseMovement()
 {
-	return { m_pWindow->input.mouseXDelta, m_pWindow->input.mouseXDelta };
+	return { m_pWindow->input.mouseXDelta, m_pWindow->input.mouseYDelta };
 }
 
 EEBool32 EEApplication::MouseHit(EEMouseButton button)
@@ -236,6 +294,11 @@ EEBool32 EEApplication::MouseDown(EEMouseButton button)
 	return (m_pWindow->input.mouseDown & button);
 }
 
+size_t EEApplication::PollInputEvents(std::vector<EEInputEvent>& eventsOut)
+{
+	return m_pWindow->PopEvents(eventsOut);
+}
+
 glm::mat4 EEApplication::AcquireOrthoMatrixLH()
 {
 	if (!isCreated) {
@@ -303,7 +366,7 @@ EEShader EEApplication::AcquireShaderColor2D()
 		shaderInput.pInputDescs = inputDescs.data();
 		shaderInput.inputStride = sizeof(EEShaderColor2D::VertexInputType);
 
-		std::vector<EEDescriptorDesc> descriptors(2);
+		std::vector<EEDescriptorDesc> descriptors(3);
 		descriptors[0].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		descriptors[0].shaderStage = EE_SHADER_STAGE_VERTEX;
 		descriptors[0].binding = 0u;
@@ -312,6 +375,10 @@ EEShader EEApplication::AcquireShaderColor2D()
 		descriptors[1].shaderStage = EE_SHADER_STAGE_FRAGMENT;
 		descriptors[1].binding = 1u;
 
+		descriptors[2].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		descriptors[2].shaderStage = EE_SHADER_STAGE_VERTEX;
+		descriptors[2].binding = 2u;
+
 		std::string vert = EE_ASSETS_DIR("shader/color2DVert.spv");
 		std::string frag = EE_ASSETS_DIR("shader/color2DFrag.spv");
 		EEShaderCreateInfo shaderCInfo;
@@ -326,11 +393,27 @@ EEShader EEApplication::AcquireShaderColor2D()
 		shaderCInfo.is2DShader = EE_TRUE;
 		shaderCInfo.wireframe = EE_FALSE;
 		shaderCInfo.clockwise = EE_TRUE;
+		shaderCInfo.indirectDraw = EE_FALSE;
 		m_pGraphics->shader.color2D = CreateShader(shaderCInfo);
 	}
 	return m_pGraphics->shader.color2D;
 }
 
+EEBuffer EEApplication::AcquireCameraBuffer2D()
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to get the camera buffer without creating the application!\n");
+		EE_INVARIANT(isCreated);
+	}
+	if (!m_pGraphics->buffer.camera2D) {
+		m_pGraphics->buffer.camera2D = CreateBuffer(sizeof(EEShaderColor2D::CameraUBO));
+
+		EEShaderColor2D::CameraUBO camera{ m_pGraphics->matrices.orthoLH, m_pGraphics->matrices.baseViewLH };
+		UpdateBuffer(m_pGraphics->buffer.camera2D, &camera);
+	}
+	return m_pGraphics->buffer.camera2D;
+}
+
 EERect32U EEApplication::GetWindowExtent()
 {
 	if (!isCreated) {
@@ -340,6 +423,29 @@ EERect32U EEApplication::GetWindowExtent()
 	return { m_pGraphics->pSwapchain->settings.extent.width,m_pGraphics->pSwapchain->settings.extent.height };
 }
 
+EEFrameStats EEApplication::GetFrameStats()
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to get the frame stats without creating the application!\n");
+		EE_INVARIANT(isCreated);
+	}
+	return m_pGraphics->GetFrameStats();
+}
+
+bool EEApplication::WriteProfileTrace(char const* fileName)
+{
+	return EE::tools::writeProfileTrace(fileName);
+}
+
+EEMemoryStats EEApplication::GetMemoryStats()
+{
+	if (!isCreated) {
+		EE_PRINT("[EEAPPLICATION] Tried to get the memory stats without creating the application!\n");
+		EE_INVARIANT(isCreated);
+	}
+	return m_pGraphics->pDevice->GetMemoryStats();
+}
+
 void Resize(GLFWwindow* window, int w, int h, void* userData)
 {
 	if (w <= 0 || h <= 0) return;
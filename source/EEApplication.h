@@ -27,6 +27,16 @@ public:
 	void Release();
 
 	bool PollEvent();
+
+	/**
+	 * Draws all visible objects. If the application was created with renderThread this only
+	 * publishes a snapshot of the visible objects, their draw ranges and the buffer and mesh updates
+	 * made since the last call. The render thread uploads the updates and records and presents the
+	 * frame while the caller already prepares the next one, if the render thread is still busy with
+	 * the previous frame this waits.
+	 *
+	 * @param color		Clear color of the frame (defaulted to black)
+	 **/
 	void Draw(EEColor const& color = { 0.0f, 0.0f, 0.0f, 1.0f });
 
 	/**
@@ -34,16 +44,42 @@ public:
 	 * In order to make a shader work with such a mes(s)h you need to set its shaderInputType
 	 * to EE_SHADER_INPUT_TYPE_CUSTOM and define your own shaderInput.
 	 * 
+	 * The vertex input is optional, if passed in the position (location 0, float2 or float3)
+	 * is read from the data to compute the bounds of the mesh, only meshes with bounds are culled.
+	 *
 	 * @param pVertices				Void pointer for all kinds of vertex data
 	 * @param bufferSize			Size of the vertex data in bytes
 	 * @param indices					List of the indices describing the faces
+	 * @param pVertexInput		The vertex input of the shader the mesh is used with (defaulted)
 	 *
 	 * @return Handle to the created mesh (nullptr if an error occured)
 	 **/
 	EEMesh CreateMesh(
 		void const*									 pVertices,
 		size_t											 bufferSize,
-		std::vector<uint32_t> const& indices);
+		std::vector<uint32_t> const& indices,
+		EEVertexInput const*				 pVertexInput = nullptr);
+
+	/**
+	 * Creates a MESH from a wavefront obj file. The vertices are EEPredefinedVertex, so the
+	 * mesh matches shaders created with EE_SHADER_INPUT_TYPE_OBJ_MESH.
+	 *
+	 * @param fileName				Destination of the obj file
+	 *
+	 * @return Handle to the created mesh (nullptr if the file couldn't be loaded)
+	 **/
+	EEMesh CreateMesh(char const* fileName);
+
+	/**
+	 * Creates a MESH from a binary mesh file written by the EEMeshConverter tool. The file is
+	 * mapped into memory and the data is copied from it straight into the staging buffers,
+	 * the vertex layout and the bounds are stored in the file.
+	 *
+	 * @param fileName				Destination of the mesh file
+	 *
+	 * @return Handle to the created mesh (nullptr if the file isn't a valid mesh file)
+	 **/
+	EEMesh CreateMeshFromFile(char const* fileName);
 
 	/**
 	 * Creates a BUFFER handle being able to store the passed in size of data
@@ -55,7 +91,8 @@ public:
 	EEBuffer CreateBuffer(size_t bufferSize);
 
 	/**
-	 * Creates a TEXTURE from the file passed in.
+	 * Creates a TEXTURE from the file passed in. KTX2 and DDS files (BCn, ETC2 or RGBA8) are
+	 * uploaded with the mip levels they contain, without decoding them.
 	 *
 	 * @param fileName								Destination of the texture file to read in
 	 * @param enableMipMapping				If set to true different mipmap levels will be generated and used
@@ -81,6 +118,17 @@ public:
 	 * Creates a SHADER with the settings specified in the EEShaderCreateInfo. Does only use
 	 * compiled shader in Spir-V (possible @TODO here).
 	 *
+	 * Objects of a shader created with indirectDraw whose meshes lie in the same vertex and index
+	 * buffers of the geometry heap are drawn with one indirect draw, one command per object and mesh
+	 * range. Only the descriptor set of the first object is bound, so the other resources have to be
+	 * the same and only the world matrices set with SetObjectWorld differ. 3d objects are grouped
+	 * regardless of their order, so the order they are submitted in changes. 2d objects are only
+	 * grouped with their neighbours in the draw order, so their z-order stays the same.
+	 * The vertex shader reads the world matrices from set 1 like this:
+	 *	 layout(set = 1, binding = 0) readonly buffer DrawData { mat4 world[]; } drawData;
+	 *	 ...
+	 *	 gl_Position = camera.proj * camera.view * drawData.world[gl_InstanceIndex] * vec4(position, 1.0);
+	 *
 	 * @param shaderCInfo		Struct that holds the description of the desired shader
 	 *
 	 * @return Handle to the shader, that can be used to create an object (nullptr if an error occured)
@@ -95,7 +143,8 @@ public:
 	 * @param shader				The shader that will be used to render
 	 * @param mesh					The mesh that will be rendered
 	 * @param bindings			The actual resources that will be bound to the shader
-	 * @param splitscreen		Which of the splitted screens should this object be rendered on (defaults)
+	 * @param splitscreen		Which of the splitted screens should this object be rendered on (defaults),
+	 *											EE_SPLITSCREEN_ALL renders it on every screen
 	 *
 	 * @return Handle to the created object (nullptr if an error occured)
 	 **/
@@ -127,6 +176,25 @@ public:
 		size_t											 bufferSize,
 		std::vector<uint32_t> const& indices);
 
+	/**
+	 * UPDATES only a range of the vertex data of a mesh and the amount of indices that are drawn.
+	 * No buffer will be reallocated, so the mesh needs to be created with enough spare capacity.
+	 *
+	 * @param mesh				Handle to the mesh that should be updated
+	 * @param pVertices		New vertex data for the range
+	 * @param offset			Offset in bytes into the vertex data where the range starts
+	 * @param size				Size of the range in bytes
+	 * @param indexCount	Amount of indices (from the start) that will be drawn
+	 *
+	 * @return False if the capacity of the mesh is exceeded (nothing will be updated then)
+	 **/
+	bool UpdateMeshRange(
+		EEMesh			mesh,
+		void const*	pVertices,
+		size_t			offset,
+		size_t			size,
+		uint32_t		indexCount);
+
 	/**
 	 * If set to true the passed in object won't be rendered
 	 *
@@ -135,6 +203,45 @@ public:
 	 **/
 	void SetObjectVisibility(EEObject object, EEBool32 visible);
 
+	/**
+	 * Limits the object to draw only a range of its mesh' indices. This way multiple objects
+	 * (i.e. with different textures bound) can share one mesh.
+	 *
+	 * @param object			The object which draw range is set
+	 * @param firstIndex	First index of the mesh to draw
+	 * @param indexCount	Amount of indices to draw (zero draws every index behind firstIndex)
+	 **/
+	void SetObjectDrawRange(EEObject object, uint32_t firstIndex, uint32_t indexCount);
+
+	/**
+	 * Binds another texture to a sampler of the object, its other resources and its place in the
+	 * draw order stay the same. Will wait till queue is idle.
+	 *
+	 * @param object			The object which texture is exchanged
+	 * @param binding			Binding of the sampler in the object's shader
+	 * @param texture			The texture that will be bound
+	 **/
+	void SetObjectTexture(EEObject object, uint32_t binding, EETexture texture);
+
+	/**
+	 * Sets the world matrix the object is culled with. It should match the world matrix
+	 * the object's shader uses, which still needs to be updated through its buffer.
+	 * Objects are only culled if their mesh was created with its vertex input.
+	 *
+	 * @param object		The object which world matrix is set
+	 * @param world			World matrix of the object (identity by default)
+	 **/
+	void SetObjectWorld(EEObject object, glm::mat4 const& world);
+
+	/**
+	 * Sets the camera the 3d objects are culled with, objects outside of its frustum aren't
+	 * recorded. Without a camera no 3d object is culled, nor while splitscreen is used.
+	 *
+	 * @param projection	Projection matrix of the camera (i.e. AcquirePerspectiveMatrixLH())
+	 * @param view				View matrix of the camera
+	 **/
+	void SetCamera3D(glm::mat4 const& projection, glm::mat4 const& view);
+
 	/**
 	 * @return Is true if the window is currently focused
 	 **/
@@ -184,9 +291,13 @@ public:
 	bool KeyPressed(EEKey key);
 
 	/**
-	 * @return The code point of the character (text) in UTF-8 pressed this frame
+	 * Returns the characters typed since the previous frame, so none is lost at low frame rates.
+	 *
+	 * @param index		Index of the character typed this frame (defaulted to the first one)
+	 *
+	 * @return The code point of the character or zero if less characters were typed
 	 **/
-	uint32_t TextInput();
+	uint32_t TextInput(uint32_t index = 0u);
 
 	/**
 	 * @return The current position
@@ -210,6 +321,17 @@ public:
 	 * @param button		Number identifying the mouse button to check
 	 **/
 	EEBool32 MouseDown(EEMouseButton button);
+
+	/**
+	 * Moves every input event (key, character, mouse movement/button, scroll) received since
+	 * the previous call in the order they occurred to the end of the vector passed in. Events are
+	 * timestamped when they are received, so no input is lost or merged even if a frame takes long.
+	 *
+	 * @param eventsOut		Vector the events will be appended to
+	 *
+	 * @return The amount of events that were appended
+	 **/
+	size_t PollInputEvents(std::vector<EEInputEvent>& eventsOut);
 	
 	/**
 	 * Returns an orthogonal left handed projection matrix for 2d rendering with the current
@@ -251,11 +373,43 @@ public:
 	 **/
 	EEShader AcquireShaderColor2D();
 
+	/**
+	 * Returns a handle to the buffer holding the left handed ortho and base view matrix (EEShaderColor2D::CameraUBO).
+	 * It is shared by all 2d objects and only updated when the window is resized, so it
+	 * needs to be bound to binding 2 of objects using the color 2d shader.
+	 **/
+	EEBuffer AcquireCameraBuffer2D();
+
 	/**
 	 * Returns the current size of the actual drawing field
 	 **/
 	EERect32U GetWindowExtent();
 
+	/**
+	 * Returns the amount of draw calls, pipeline and descriptor binds recorded for the last frame and the
+	 * time the gpu spent in the 3d and 2d pass. The gpu timings are read back without waiting, so they
+	 * are a swapchain length (two or three frames) old. gpuTimingsValid is false if the gpu doesn't support timestamps.
+	 * Objects that were skipped since they are outside of the screen are counted as culled.
+	 **/
+	EEFrameStats GetFrameStats();
+
+	/**
+	 * Writes the cpu profiling zones (EE_PROFILE_SCOPE) of all threads recorded so far as chrome
+	 * trace_event json. Only records anything if the engine was built with EE_PROFILE defined.
+	 *
+	 * @param fileName	Destination of the json file
+	 *
+	 * @return False if the file couldn't be written or profiling is compiled out
+	 **/
+	bool WriteProfileTrace(char const* fileName);
+
+	/**
+	 * Returns the device memory the engine allocated per category (meshes, textures, buffers, ...)
+	 * and per heap. If the driver supports VK_EXT_memory_budget hasBudget is true and every heap
+	 * also contains the usage of the whole process and the budget the driver grants it.
+	 **/
+	EEMemoryStats GetMemoryStats();
+
 private:
 	EE::Window* m_pWindow;
 	EE::Graphics* m_pGraphics;
@@ -0,0 +1,434 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: AABBTree.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "AABBTree.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+# define AABBTREE_SSE
+# include <xmmintrin.h>
+#endif
+
+/* @brief Part of the box' extent the stored box is enlarged by (and a minimum) */
+#define FAT_FACTOR 0.1f
+#define FAT_MINIMUM 0.01f
+
+using namespace CORETOOLS;
+
+namespace {
+
+	enum FrustumTest { OUTSIDE, INTERSECTING, INSIDE };
+
+	AABB combine(AABB const& a, AABB const& b)
+	{
+		AABB result;
+		for (int i = 0; i < 3; i++) {
+			result.min[i] = std::min(a.min[i], b.min[i]);
+			result.max[i] = std::max(a.max[i], b.max[i]);
+		}
+		return result;
+	}
+
+	/* @brief Half the surface area, the cost of a box in the tree */
+	float perimeter(AABB const& aabb)
+	{
+		float wx = aabb.max[0] - aabb.min[0];
+		float wy = aabb.max[1] - aabb.min[1];
+		float wz = aabb.max[2] - aabb.min[2];
+		return wx * wy + wy * wz + wz * wx;
+	}
+
+	bool contains(AABB const& outer, AABB const& inner)
+	{
+		for (int i = 0; i < 3; i++) {
+			if (inner.min[i] < outer.min[i] || inner.max[i] > outer.max[i]) return false;
+		}
+		return true;
+	}
+
+	/* @brief Planes in structure of arrays, padded to eight with planes that contain everything */
+	struct FrustumSoA {
+		alignas(16) float a[8];
+		alignas(16) float b[8];
+		alignas(16) float c[8];
+		alignas(16) float d[8];
+	};
+
+	FrustumSoA toSoA(Frustum const& frustum)
+	{
+		FrustumSoA soa;
+		for (int i = 0; i < 8; i++) {
+			soa.a[i] = (i < 6) ? frustum.planes[i][0] : 0.0f;
+			soa.b[i] = (i < 6) ? frustum.planes[i][1] : 0.0f;
+			soa.c[i] = (i < 6) ? frustum.planes[i][2] : 0.0f;
+			soa.d[i] = (i < 6) ? frustum.planes[i][3] : 1.0f;
+		}
+		return soa;
+	}
+
+	/**
+	 * Distance of the box' center to each plane compared with the box' extent projected onto the
+	 * plane normal. Four planes are tested at once.
+	 **/
+	FrustumTest testFrustum(FrustumSoA const& frustum, AABB const& aabb)
+	{
+		float cx = (aabb.max[0] + aabb.min[0]) * 0.5f, ex = (aabb.max[0] - aabb.min[0]) * 0.5f;
+		float cy = (aabb.max[1] + aabb.min[1]) * 0.5f, ey = (aabb.max[1] - aabb.min[1]) * 0.5f;
+		float cz = (aabb.max[2] + aabb.min[2]) * 0.5f, ez = (aabb.max[2] - aabb.min[2]) * 0.5f;
+
+#if defined(AABBTREE_SSE)
+		__m128 const signMask = _mm_set1_ps(-0.0f);
+		__m128 centerX = _mm_set1_ps(cx), centerY = _mm_set1_ps(cy), centerZ = _mm_set1_ps(cz);
+		__m128 extentX = _mm_set1_ps(ex), extentY = _mm_set1_ps(ey), extentZ = _mm_set1_ps(ez);
+
+		int outside = 0, intersecting = 0;
+		for (int i = 0; i < 8; i += 4) {
+			__m128 a = _mm_load_ps(frustum.a + i);
+			__m128 b = _mm_load_ps(frustum.b + i);
+			__m128 c = _mm_load_ps(frustum.c + i);
+			__m128 d = _mm_load_ps(frustum.d + i);
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, centerX), _mm_mul_ps(b, centerY)),
+				_mm_add_ps(_mm_mul_ps(c, centerZ), d));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, a), extentX),
+				_mm_mul_ps(_mm_andnot_ps(signMask, b), extentY)), _mm_mul_ps(_mm_andnot_ps(signMask, c), extentZ));
+
+			outside |= _mm_movemask_ps(_mm_cmplt_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+			intersecting |= _mm_movemask_ps(_mm_cmplt_ps(distance, radius));
+		}
+		if (outside) return OUTSIDE;
+		return (intersecting) ? INTERSECTING : INSIDE;
+#else
+		bool intersecting = false;
+		for (int i = 0; i < 6; i++) {
+			float distance = frustum.a[i] * cx + frustum.b[i] * cy + frustum.c[i] * cz + frustum.d[i];
+			float radius = std::fabs(frustum.a[i]) * ex + std::fabs(frustum.b[i]) * ey + std::fabs(frustum.c[i]) * ez;
+			if (distance < -radius) return OUTSIDE;
+			if (distance < radius) intersecting = true;
+		}
+		return (intersecting) ? INTERSECTING : INSIDE;
+#endif
+	}
+}
+
+
+AABBTree::AABBTree()
+{
+	m_nodes.reserve(64u);
+}
+
+AABBTree::Proxy AABBTree::CreateProxy(AABB const& aabb, void* pUserData)
+{
+	int32_t leaf = AllocateNode();
+
+	// Enlarge the box so small moves stay inside of it
+	for (int i = 0; i < 3; i++) {
+		float margin = std::max((aabb.max[i] - aabb.min[i]) * FAT_FACTOR, FAT_MINIMUM);
+		m_nodes[leaf].aabb.min[i] = aabb.min[i] - margin;
+		m_nodes[leaf].aabb.max[i] = aabb.max[i] + margin;
+	}
+	m_nodes[leaf].pUserData = pUserData;
+	m_nodes[leaf].height = 0;
+
+	InsertLeaf(leaf);
+	m_amountProxies++;
+
+	return leaf;
+}
+
+void AABBTree::DestroyProxy(Proxy proxy)
+{
+	assert(proxy >= 0 && proxy < int32_t(m_nodes.size()) && m_nodes[proxy].IsLeaf());
+
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	m_amountProxies--;
+}
+
+bool AABBTree::MoveProxy(Proxy proxy, AABB const& aabb)
+{
+	assert(proxy >= 0 && proxy < int32_t(m_nodes.size()) && m_nodes[proxy].IsLeaf());
+
+	// Still within the enlarged box, as long as it didn't shrink a lot
+	AABB const& fat = m_nodes[proxy].aabb;
+	if (contains(fat, aabb) && perimeter(fat) < 4.0f * perimeter(aabb) + FAT_MINIMUM) return false;
+
+	RemoveLeaf(proxy);
+	for (int i = 0; i < 3; i++) {
+		float margin = std::max((aabb.max[i] - aabb.min[i]) * FAT_FACTOR, FAT_MINIMUM);
+		m_nodes[proxy].aabb.min[i] = aabb.min[i] - margin;
+		m_nodes[proxy].aabb.max[i] = aabb.max[i] + margin;
+	}
+	InsertLeaf(proxy);
+
+	return true;
+}
+
+void AABBTree::Query(Frustum const& frustum, std::vector<void*>& userDataOut) const
+{
+	if (m_root == NULL_PROXY) return;
+
+	FrustumSoA soa = toSoA(frustum);
+
+	m_stack.clear();
+	m_stack.push_back(m_root);
+	while (!m_stack.empty()) {
+		int32_t node = m_stack.back();
+		m_stack.pop_back();
+
+		FrustumTest result = testFrustum(soa, m_nodes[node].aabb);
+		if (result == OUTSIDE) continue;
+
+		if (m_nodes[node].IsLeaf()) {
+			userDataOut.push_back(m_nodes[node].pUserData);
+		} else if (result == INSIDE) {
+			CollectLeafs(node, userDataOut);
+		} else {
+			m_stack.push_back(m_nodes[node].child1);
+			m_stack.push_back(m_nodes[node].child2);
+		}
+	}
+}
+
+int32_t AABBTree::AllocateNode()
+{
+	int32_t node;
+	if (m_freeList != NULL_PROXY) {
+		node = m_freeList;
+		m_freeList = m_nodes[node].parent;
+	} else {
+		node = int32_t(m_nodes.size());
+		m_nodes.push_back(Node());
+	}
+
+	m_nodes[node].pUserData = nullptr;
+	m_nodes[node].parent = NULL_PROXY;
+	m_nodes[node].child1 = NULL_PROXY;
+	m_nodes[node].child2 = NULL_PROXY;
+	m_nodes[node].height = 0;
+	return node;
+}
+
+void AABBTree::FreeNode(int32_t node)
+{
+	m_nodes[node].parent = m_freeList;
+	m_nodes[node].height = -1;
+	m_freeList = node;
+}
+
+void AABBTree::InsertLeaf(int32_t leaf)
+{
+	if (m_root == NULL_PROXY) {
+		m_root = leaf;
+		m_nodes[leaf].parent = NULL_PROXY;
+		return;
+	}
+
+	// Descend to the sibling that makes the tree grow the least
+	AABB const leafAABB = m_nodes[leaf].aabb;
+	int32_t index = m_root;
+	while (!m_nodes[index].IsLeaf()) {
+		int32_t child1 = m_nodes[index].child1;
+		int32_t child2 = m_nodes[index].child2;
+
+		float area = perimeter(m_nodes[index].aabb);
+		float combinedArea = perimeter(combine(m_nodes[index].aabb, leafAABB));
+
+		// Cost of a new parent for this node and the leaf, the ancestors grow anyway
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float cost1 = perimeter(combine(leafAABB, m_nodes[child1].aabb)) + inheritanceCost;
+		if (!m_nodes[child1].IsLeaf()) cost1 -= perimeter(m_nodes[child1].aabb);
+		float cost2 = perimeter(combine(leafAABB, m_nodes[child2].aabb)) + inheritanceCost;
+		if (!m_nodes[child2].IsLeaf()) cost2 -= perimeter(m_nodes[child2].aabb);
+
+		if (cost < cost1 && cost < cost2) break;
+		index = (cost1 < cost2) ? child1 : child2;
+	}
+	int32_t sibling = index;
+
+	// New parent of the sibling and the leaf
+	int32_t oldParent = m_nodes[sibling].parent;
+	int32_t newParent = AllocateNode();
+	m_nodes[newParent].parent = oldParent;
+	m_nodes[newParent].aabb = combine(leafAABB, m_nodes[sibling].aabb);
+	m_nodes[newParent].height = m_nodes[sibling].height + 1;
+	m_nodes[newParent].child1 = sibling;
+	m_nodes[newParent].child2 = leaf;
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	if (oldParent != NULL_PROXY) {
+		if (m_nodes[oldParent].child1 == sibling) m_nodes[oldParent].child1 = newParent;
+		else m_nodes[oldParent].child2 = newParent;
+	} else {
+		m_root = newParent;
+	}
+
+	// Refit and balance the ancestors
+	index = m_nodes[leaf].parent;
+	while (index != NULL_PROXY) {
+		index = Balance(index);
+
+		int32_t child1 = m_nodes[index].child1;
+		int32_t child2 = m_nodes[index].child2;
+		m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+		m_nodes[index].aabb = combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+
+		index = m_nodes[index].parent;
+	}
+}
+
+void AABBTree::RemoveLeaf(int32_t leaf)
+{
+	if (leaf == m_root) {
+		m_root = NULL_PROXY;
+		return;
+	}
+
+	// The sibling takes the place of the parent
+	int32_t parent = m_nodes[leaf].parent;
+	int32_t grandParent = m_nodes[parent].parent;
+	int32_t sibling = (m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+	if (grandParent != NULL_PROXY) {
+		if (m_nodes[grandParent].child1 == parent) m_nodes[grandParent].child1 = sibling;
+		else m_nodes[grandParent].child2 = sibling;
+		m_nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		// Refit and balance the ancestors
+		int32_t index = grandParent;
+		while (index != NULL_PROXY) {
+			index = Balance(index);
+
+			int32_t child1 = m_nodes[index].child1;
+			int32_t child2 = m_nodes[index].child2;
+			m_nodes[index].aabb = combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+			m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+
+			index = m_nodes[index].parent;
+		}
+	} else {
+		m_root = sibling;
+		m_nodes[sibling].parent = NULL_PROXY;
+		FreeNode(parent);
+	}
+}
+
+int32_t AABBTree::Balance(int32_t iA)
+{
+	Node& A = m_nodes[iA];
+	if (A.IsLeaf() || A.height < 2) return iA;
+
+	int32_t iB = A.child1;
+	int32_t iC = A.child2;
+	Node& B = m_nodes[iB];
+	Node& C = m_nodes[iC];
+
+	int32_t balance = C.height - B.height;
+
+	// Rotate C up
+	if (balance > 1) {
+		int32_t iF = C.child1;
+		int32_t iG = C.child2;
+		Node& F = m_nodes[iF];
+		Node& G = m_nodes[iG];
+
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		if (C.parent != NULL_PROXY) {
+			if (m_nodes[C.parent].child1 == iA) m_nodes[C.parent].child1 = iC;
+			else m_nodes[C.parent].child2 = iC;
+		} else {
+			m_root = iC;
+		}
+
+		// The higher child of C stays below C
+		if (F.height > G.height) {
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			A.aabb = combine(B.aabb, G.aabb);
+			C.aabb = combine(A.aabb, F.aabb);
+			A.height = 1 + std::max(B.height, G.height);
+			C.height = 1 + std::max(A.height, F.height);
+		} else {
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			A.aabb = combine(B.aabb, F.aabb);
+			C.aabb = combine(A.aabb, G.aabb);
+			A.height = 1 + std::max(B.height, F.height);
+			C.height = 1 + std::max(A.height, G.height);
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1) {
+		int32_t iD = B.child1;
+		int32_t iE = B.child2;
+		Node& D = m_nodes[iD];
+		Node& E = m_nodes[iE];
+
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		if (B.parent != NULL_PROXY) {
+			if (m_nodes[B.parent].child1 == iA) m_nodes[B.parent].child1 = iB;
+			else m_nodes[B.parent].child2 = iB;
+		} else {
+			m_root = iB;
+		}
+
+		// The higher child of B stays below B
+		if (D.height > E.height) {
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			A.aabb = combine(C.aabb, E.aabb);
+			B.aabb = combine(A.aabb, D.aabb);
+			A.height = 1 + std::max(C.height, E.height);
+			B.height = 1 + std::max(A.height, D.height);
+		} else {
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			A.aabb = combine(C.aabb, D.aabb);
+			B.aabb = combine(A.aabb, E.aabb);
+			A.height = 1 + std::max(C.height, D.height);
+			B.height = 1 + std::max(A.height, E.height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+void AABBTree::CollectLeafs(int32_t node, std::vector<void*>& userDataOut) const
+{
+	// Uses the end of the query stack, the entries of the query below stay untouched
+	size_t base = m_stack.size();
+	m_stack.push_back(node);
+	while (m_stack.size() > base) {
+		int32_t index = m_stack.back();
+		m_stack.pop_back();
+
+		if (m_nodes[index].IsLeaf()) {
+			userDataOut.push_back(m_nodes[index].pUserData);
+		} else {
+			m_stack.push_back(m_nodes[index].child1);
+			m_stack.push_back(m_nodes[index].child2);
+		}
+	}
+}
@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: AABBTree.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <vector>
+
+
+namespace CORETOOLS
+{
+	/* @brief Axis aligned bounding box */
+	struct AABB
+	{
+		float min[3];
+		float max[3];
+	};
+
+	/**
+	 * Six planes (left, right, bottom, top, near, far) facing inwards, stored as a, b, c, d
+	 * with a * x + b * y + c * z + d >= 0 for every point inside.
+	 **/
+	struct Frustum
+	{
+		float planes[6][4];
+	};
+
+	/**
+	 * Dynamic bounding volume hierarchy over boxes that move, appear and vanish every frame.
+	 * Every leaf (proxy) stores a box that is a bit bigger than the one passed in, so small moves
+	 * don't change the tree at all. Inserting picks the sibling that grows the tree the least,
+	 * rotations keep it balanced. Queries skip whole subtrees outside the frustum and take whole
+	 * subtrees inside of it without testing them any further.
+	 **/
+	class AABBTree
+	{
+	public:
+		/* @brief Index of a leaf, returned on creation and stays valid till the proxy is destroyed */
+		typedef int32_t Proxy;
+		static constexpr Proxy NULL_PROXY{ -1 };
+
+		AABBTree();
+
+		/**
+		 * Inserts a box into the tree
+		 *
+		 * @param aabb				The tight box of the proxy
+		 * @param pUserData		Returned by queries that find this proxy
+		 *
+		 * @return The proxy that represents the box from now on
+		 **/
+		Proxy CreateProxy(AABB const& aabb, void* pUserData);
+
+		/* @brief Removes the proxy from the tree, its index may be reused afterwards */
+		void DestroyProxy(Proxy proxy);
+
+		/**
+		 * Sets the new box of the proxy. The tree is only changed if the box left the enlarged one.
+		 *
+		 * @return True if the proxy was reinserted
+		 **/
+		bool MoveProxy(Proxy proxy, AABB const& aabb);
+
+		/**
+		 * Collects the user data of every proxy which box intersects with the frustum passed in
+		 *
+		 * @param frustum					The planes to test against
+		 * @param userDataOut			The user data of every intersecting proxy is appended
+		 **/
+		void Query(Frustum const& frustum, std::vector<void*>& userDataOut) const;
+
+		/* @brief Returns the amount of proxies currently in the tree */
+		uint32_t GetAmountProxies() const { return m_amountProxies; }
+
+	private:
+		struct Node {
+			AABB aabb;
+			void* pUserData;
+			/* @brief Parent while in the tree, next free node while in the free list */
+			int32_t parent;
+			int32_t child1;
+			int32_t child2;
+			/* @brief Leafs have a height of zero, free nodes of minus one */
+			int32_t height;
+
+			bool IsLeaf() const { return child1 == NULL_PROXY; }
+		};
+
+		int32_t AllocateNode();
+		void FreeNode(int32_t node);
+
+		void InsertLeaf(int32_t leaf);
+		void RemoveLeaf(int32_t leaf);
+
+		/* @brief Rotates the subtree if it is unbalanced, returns the new root of the subtree */
+		int32_t Balance(int32_t node);
+
+		/* @brief Appends the user data of every leaf below the node without testing */
+		void CollectLeafs(int32_t node, std::vector<void*>& userDataOut) const;
+
+	private:
+		std::vector<Node> m_nodes;
+		int32_t m_root{ NULL_PROXY };
+		int32_t m_freeList{ NULL_PROXY };
+		uint32_t m_amountProxies{ 0u };
+
+		/* @brief Scratch stack of the queries, kept to reuse its memory */
+		mutable std::vector<int32_t> m_stack;
+	};
+}
@@ -7,6 +7,8 @@
 
 #include <cassert>
 
+#include "eeprofiler.h"
+
 #include "vkcore/vulkanShader.h"
 #include "vkcore/vulkanMesh.h"
 #include "vkcore/vulkanObject.h"
@@ -26,6 +28,7 @@ Graphics::Graphics()
 
 Graphics::~Graphics()
 {
+	StopRenderThread();
 	pRenderer->WaitTillIdle();
 
 	// OBJECTS
@@ -112,18 +115,167 @@ bool Graphics::Create(Window* pWindow, EEApplicationCreateInfo const& info)
   matrices.baseViewLH = glm::lookAtLH(position, target, up);
   matrices.baseViewRH = glm::lookAtRH(-position, target, up);
 
+	// 2d objects are culled with the camera all 2d shaders use
+	pRenderer->culling.viewProjection2D = matrices.orthoLH * matrices.baseViewLH;
+
+	// Start drawing on an own thread if requested
+	settings.renderThread = (info.renderThread == EE_TRUE);
+	if (settings.renderThread) {
+		StartRenderThread();
+	}
+
 	return true;
 }
 
 void EE::Graphics::Draw(EEColor const& color)
 {
-	pRenderer->RecordDrawCommands(currentObjects, color);
-	pRenderer->Draw();
+	EE_PROFILE_SCOPE("Graphics::Draw");
+
+	if (!renderThread.isRunning) {
+		pRenderer->culling.viewProjection3D = camera3D.viewProjection;
+		pRenderer->culling.hasCamera3D = camera3D.isSet;
+		pRenderer->RecordDrawCommands(currentObjects, color);
+		pRenderer->Draw();
+		return;
+	}
+
+	// Stay at most one frame ahead, the last published frame needs to be taken by the render thread
+	{
+		std::unique_lock<std::mutex> lock(renderThread.signalMutex);
+		renderThread.signal.wait(lock, [this] { return !renderThread.snapshots.HasFresh(); });
+	}
+
+	// Store what is visible now, the objects can change while the render thread draws this frame
+	FrameSnapshot& snapshot = renderThread.snapshots.Back();
+	snapshot.clearColor = color;
+	snapshot.viewProjection3D = camera3D.viewProjection;
+	snapshot.hasCamera3D = camera3D.isSet;
+	snapshot.drawList.clear();
+	for (size_t i = 0u; i < currentObjects.size(); i++) {
+		if (currentObjects[i]->isVisible) {
+			snapshot.drawList.push_back({ currentObjects[i], currentObjects[i]->firstIndex, currentObjects[i]->indexCount, currentObjects[i]->world });
+		}
+	}
+
+	// Hand over the frame, the slot we get back was already drawn so it collects the buffer updates of the next frame
+	renderThread.snapshots.Publish();
+	FrameSnapshot& nextSnapshot = renderThread.snapshots.Back();
+	nextSnapshot.uniformWrites.clear();
+	nextSnapshot.uniformData.clear();
+	nextSnapshot.meshWrites.clear();
+	nextSnapshot.meshData.clear();
+	nextSnapshot.meshIndices.clear();
+
+	// Lock once so the render thread can't miss the notification between checking for a frame and sleeping
+	{
+		std::lock_guard<std::mutex> lock(renderThread.signalMutex);
+	}
+	renderThread.signal.notify_all();
+}
+
+void EE::Graphics::StartRenderThread()
+{
+	if (renderThread.isRunning) return;
+
+	renderThread.quit = false;
+	renderThread.thread = std::thread(&Graphics::RenderLoop, this);
+	renderThread.isRunning = true;
+}
+
+void EE::Graphics::StopRenderThread()
+{
+	if (!renderThread.isRunning) return;
+
+	{
+		std::lock_guard<std::mutex> lock(renderThread.signalMutex);
+		renderThread.quit = true;
+	}
+	renderThread.signal.notify_all();
+	renderThread.thread.join();
+	renderThread.isRunning = false;
+
+	// Updates made after the last draw are applied directly now
+	FrameSnapshot& snapshot = renderThread.snapshots.Back();
+	ApplyWrites(snapshot);
+	snapshot.uniformWrites.clear();
+	snapshot.uniformData.clear();
+	snapshot.meshWrites.clear();
+	snapshot.meshData.clear();
+	snapshot.meshIndices.clear();
+}
+
+void EE::Graphics::WaitForRenderThread()
+{
+	if (!renderThread.isRunning) return;
+
+	// Fresh is checked first, since the render thread flags itself as rendering before it takes a frame
+	std::unique_lock<std::mutex> lock(renderThread.signalMutex);
+	renderThread.signal.wait(lock, [this] { return !renderThread.snapshots.HasFresh() && !renderThread.isRendering; });
+}
+
+void EE::Graphics::RenderLoop()
+{
+	for (;;) {
+		// Sleep till a frame is published, on quit the last published frame is still drawn
+		{
+			std::unique_lock<std::mutex> lock(renderThread.signalMutex);
+			renderThread.signal.wait(lock, [this] { return renderThread.quit || renderThread.snapshots.HasFresh(); });
+			if (!renderThread.snapshots.HasFresh()) return;
+
+			renderThread.isRendering = true;
+			renderThread.snapshots.Take();
+		}
+		// The caller may wait for the frame to be taken
+		renderThread.signal.notify_all();
+
+		FrameSnapshot const& snapshot = renderThread.snapshots.Front();
+		{
+			EE_PROFILE_SCOPE("Graphics::RenderLoop frame");
+			std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+
+			// Buffer and mesh updates of this frame
+			ApplyWrites(snapshot);
+
+			pRenderer->culling.viewProjection3D = snapshot.viewProjection3D;
+			pRenderer->culling.hasCamera3D = snapshot.hasCamera3D;
+			pRenderer->RecordDrawCommands(snapshot.drawList, snapshot.clearColor);
+			pRenderer->Draw();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(renderThread.signalMutex);
+			renderThread.isRendering = false;
+			renderThread.frameStats = pRenderer->frameStats;
+		}
+		renderThread.signal.notify_all();
+	}
+}
+
+void EE::Graphics::ApplyWrites(FrameSnapshot const& snapshot)
+{
+	for (size_t i = 0u; i < snapshot.uniformWrites.size(); i++) {
+		snapshot.uniformWrites[i].pBuffer->Update(snapshot.uniformData.data() + snapshot.uniformWrites[i].offset);
+	}
+
+	for (size_t i = 0u; i < snapshot.meshWrites.size(); i++) {
+		FrameSnapshot::MeshWrite const& write = snapshot.meshWrites[i];
+		char const* pData = (write.dataSize) ? snapshot.meshData.data() + write.dataOffset : nullptr;
+		if (write.isRange) {
+			write.pMesh->UpdateRange(pData, write.rangeOffset, write.dataSize, write.indexCount);
+		} else {
+			std::vector<uint32_t> indices(snapshot.meshIndices.begin() + write.indicesOffset,
+																		snapshot.meshIndices.begin() + write.indicesOffset + write.amountIndices);
+			write.pMesh->Update(pData, write.dataSize, indices);
+		}
+	}
 }
 
 void EE::Graphics::Resize()
 {
-	pRenderer->Resize(currentObjects);
+	{
+		std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+		pRenderer->Resize(currentObjects);
+	}
 
 	// Update the drawing matrices
   matrices.orthoLH = glm::orthoLH(0.0f, float(pSwapchain->settings.extent.width), 0.0f, float(pSwapchain->settings.extent.height), settings.nearPlane, settings.farPlane);
@@ -138,15 +290,39 @@ void EE::Graphics::Resize()
 	glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
   matrices.baseViewLH = glm::lookAtLH(position, target, up);
   matrices.baseViewRH = glm::lookAtRH(-position, target, up);
+
+	{
+		std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+		pRenderer->culling.viewProjection2D = matrices.orthoLH * matrices.baseViewLH;
+	}
+
+	// The shared 2d camera is the only uniform that changes with the extent
+	if (buffer.camera2D) {
+		EEShaderColor2D::CameraUBO camera{ matrices.orthoLH, matrices.baseViewLH };
+		UpdateBuffer(buffer.camera2D, &camera);
+	}
 }
 
-EEMesh EE::Graphics::CreateMesh(void const* pVertices, size_t amountVertices, std::vector<uint32_t> const & indices)
+EEFrameStats EE::Graphics::GetFrameStats()
+{
+	// The render thread writes the renderer's stats while drawing, so the copy of the last drawn frame is read
+	if (renderThread.isRunning) {
+		std::lock_guard<std::mutex> lock(renderThread.signalMutex);
+		return renderThread.frameStats;
+	}
+	return pRenderer->frameStats;
+}
+
+EEMesh EE::Graphics::CreateMesh(void const* pVertices, size_t amountVertices, std::vector<uint32_t> const & indices, EEVertexInput const* pVertexInput)
 {
 	EE_INVARIANT(iCurrentMeshes.size() == currentMeshes.size());
 
+	// The upload uses the queue the render thread submits to
+	std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+
 	// Push back new mesh handle
 	currentMeshes.push_back(new EE::Mesh(pRenderer));
-	LAST_ELEMENT(currentMeshes)->Create(pVertices, amountVertices, indices);
+	LAST_ELEMENT(currentMeshes)->Create(pVertices, amountVertices, indices, pVertexInput);
 
 	// Push back address of the index to the new mesh
 	iCurrentMeshes.push_back(new uint32_t((uint32_t)currentMeshes.size() - 1u));
@@ -156,6 +332,52 @@ EEMesh EE::Graphics::CreateMesh(void const* pVertices, size_t amountVertices, st
 	return { LAST_ELEMENT(iCurrentMeshes) };
 }
 
+EEMesh EE::Graphics::CreateMesh(char const* fileName)
+{
+	EE_INVARIANT(iCurrentMeshes.size() == currentMeshes.size());
+
+	// The upload uses the queue the render thread submits to
+	std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+
+	EE::Mesh* pMesh = new EE::Mesh(pRenderer);
+	pMesh->Create(fileName);
+	if (!pMesh->isCreated) {
+		delete pMesh;
+		return nullptr;
+	}
+
+	// Push back new mesh handle and the address of its index
+	currentMeshes.push_back(pMesh);
+	iCurrentMeshes.push_back(new uint32_t((uint32_t)currentMeshes.size() - 1u));
+
+	EE_INVARIANT(iCurrentMeshes.size() == currentMeshes.size());
+
+	return { LAST_ELEMENT(iCurrentMeshes) };
+}
+
+EEMesh EE::Graphics::CreateMeshFromFile(char const* fileName)
+{
+	EE_INVARIANT(iCurrentMeshes.size() == currentMeshes.size());
+
+	// The upload uses the queue the render thread submits to
+	std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+
+	EE::Mesh* pMesh = new EE::Mesh(pRenderer);
+	pMesh->CreateFromMeshFile(fileName);
+	if (!pMesh->isCreated) {
+		delete pMesh;
+		return nullptr;
+	}
+
+	// Push back new mesh handle and the address of its index
+	currentMeshes.push_back(pMesh);
+	iCurrentMeshes.push_back(new uint32_t((uint32_t)currentMeshes.size() - 1u));
+
+	EE_INVARIANT(iCurrentMeshes.size() == currentMeshes.size());
+
+	return { LAST_ELEMENT(iCurrentMeshes) };
+}
+
 EEBuffer EE::Graphics::CreateBuffer(size_t bufferSize)
 {
 	EE_INVARIANT(iCurrentBuffers.size() == currentBuffers.size());
@@ -175,6 +397,9 @@ EETexture EE::Graphics::CreateTexture(char const* fileName, bool enableMipMappin
 {
 	EE_INVARIANT(iCurrentTextures.size() == currentTextures.size());
 
+	// The upload uses the queue the render thread submits to
+	std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+
 	// Push back new texture handle
 	currentTextures.push_back(new EE::Texture(pRenderer, fileName, enableMipMapping, unnormalizedCoordinates));
 	LAST_ELEMENT(currentTextures)->Upload();
@@ -191,6 +416,9 @@ EETexture EE::Graphics::CreateTexture(EETextureCreateInfo const& textureCInfo)
 {
 	EE_INVARIANT(iCurrentTextures.size() == currentTextures.size());
 
+	// The upload uses the queue the render thread submits to
+	std::lock_guard<std::mutex> lock(renderThread.resourceMutex);
+
 	// Push back new texture handle
 	currentTextures.push_back(new EE::Texture(pRenderer, textureCInfo));
 	LAST_ELEMENT(currentTextures)->Upload();
@@ -251,10 +479,12 @@ void EE::Graphics::ReleaseObject(EEObject& object)
 	uint32_t index = *object;
 	object = nullptr;
 
-	// Wait 'till queue is idle
+	// No published frame may still use the resource and the queue needs to be idle
+	WaitForRenderThread();
 	vkQueueWaitIdle(pDevice->AcquireQueue(vulkan::GRAPHICS_FAMILY));
 
 	// Release the instance of EEInternObject
+	pRenderer->RemoveFromCulling(currentObjects[index]);
 	delete currentObjects[index];
 	currentObjects.erase(currentObjects.begin() + index);
 
@@ -284,9 +514,16 @@ void EE::Graphics::ReleaseMesh(EEMesh& mesh)
 	uint32_t index = *mesh;
 	mesh = nullptr;
 
-	// Wait 'till queue is idle
+	// No published frame may still use the resource and the queue needs to be idle
+	WaitForRenderThread();
 	vkQueueWaitIdle(pDevice->AcquireQueue(vulkan::GRAPHICS_FAMILY));
 
+	// Drop updates of this mesh that weren't published yet
+	std::vector<FrameSnapshot::MeshWrite>& writes = renderThread.snapshots.Back().meshWrites;
+	for (size_t i = writes.size(); i-- > 0u;) {
+		if (writes[i].pMesh == currentMeshes[index]) writes.erase(writes.begin() + i);
+	}
+
 	// Release the instance of EEInternMesh
 	delete currentMeshes[index];
 	currentMeshes.erase(currentMeshes.begin() + index);
@@ -315,7 +552,8 @@ void EE::Graphics::ReleaseShader(EEShader& shader)
 	uint32_t index = *shader;
 	shader = nullptr;
 
-	// Wait 'till queue is idle
+	// No published frame may still use the resource and the queue needs to be idle
+	WaitForRenderThread();
 	vkQueueWaitIdle(pDevice->AcquireQueue(vulkan::GRAPHICS_FAMILY));
 
 	// Release the instance of EEInternShader
@@ -346,7 +584,8 @@ void EE::Graphics::ReleaseTexture(EETexture& texture)
 	uint32_t index = *texture;
 	texture = nullptr;
 
-	// Wait 'till queue is idle
+	// No published frame may still use the resource and the queue needs to be idle
+	WaitForRenderThread();
 	vkQueueWaitIdle(pDevice->AcquireQueue(vulkan::GRAPHICS_FAMILY));
 
 	// Release the instance of EEInternTexture
@@ -377,9 +616,16 @@ void EE::Graphics::ReleaseBuffer(EEBuffer& buffer)
 	uint32_t index = *buffer;
 	buffer = nullptr;
 
-	// Wait 'till queue is idle
+	// No published frame may still use the resource and the queue needs to be idle
+	WaitForRenderThread();
 	vkQueueWaitIdle(pDevice->AcquireQueue(vulkan::GRAPHICS_FAMILY));
 
+	// Drop updates of this buffer that weren't published yet
+	std::vector<FrameSnapshot::UniformWrite>& writes = renderThread.snapshots.Back().uniformWrites;
+	for (size_t i = writes.size(); i-- > 0u;) {
+		if (writes[i].pBuffer == currentBuffers[index]) writes.erase(writes.begin() + i);
+	}
+
 	// Release the instance of EEInternBuffer
 	delete currentBuffers[index];
 	currentBuffers.erase(currentBuffers.begin() + index);
@@ -409,12 +655,62 @@ void EE::Graphics::UpdateBuffer(EEBuffer buffer, void const * pData)
 		EE_PRINT("[GRAPHICS] Invalid buffer handle passed in to be updated!\n");
 		return;
 	}
+
+	// With a render thread the update belongs to the next drawn frame and is applied right before it is recorded
+	if (renderThread.isRunning) {
+		FrameSnapshot& snapshot = renderThread.snapshots.Back();
+		Buffer* pBuffer = currentBuffers[*buffer];
+		snapshot.uniformWrites.push_back({ pBuffer, snapshot.uniformData.size() });
+		snapshot.uniformData.insert(snapshot.uniformData.end(), (char const*)pData, (char const*)pData + pBuffer->bufferSize);
+		return;
+	}
 	currentBuffers[*buffer]->Update(pData);
 }
 
 void EE::Graphics::UpdateMesh(EEMesh mesh, void const* pVertices, size_t bufferSize, std::vector<uint32_t> const& indices)
 {
-	currentMeshes[*mesh]->Update(pVertices, bufferSize, indices);
+	Mesh* pMesh = currentMeshes[*mesh];
+
+	// Buffers are recreated with exactly the new sizes, which range updates are checked against
+	if (bufferSize) pMesh->capacity.vertexSize = static_cast<VkDeviceSize>(bufferSize);
+	if (!indices.empty()) pMesh->capacity.amountIndices = uint32_t(indices.size());
+
+	// With a render thread the update is applied right before the next drawn frame is recorded
+	if (renderThread.isRunning) {
+		FrameSnapshot& snapshot = renderThread.snapshots.Back();
+		snapshot.meshWrites.push_back({ pMesh, false, snapshot.meshData.size(), bufferSize, 0u, 0u, snapshot.meshIndices.size(), indices.size() });
+		snapshot.meshData.insert(snapshot.meshData.end(), (char const*)pVertices, (char const*)pVertices + bufferSize);
+		snapshot.meshIndices.insert(snapshot.meshIndices.end(), indices.begin(), indices.end());
+		return;
+	}
+	pMesh->Update(pVertices, bufferSize, indices);
+}
+
+bool EE::Graphics::UpdateMeshRange(EEMesh mesh, void const* pVertices, size_t offset, size_t size, uint32_t indexCount)
+{
+	Mesh* pMesh = currentMeshes[*mesh];
+
+	// Checked against the capacity including staged updates, the caller needs to do a full update if exceeded
+	if (!pMesh->isCreated || offset + size > pMesh->capacity.vertexSize || indexCount > pMesh->capacity.amountIndices) {
+		return false;
+	}
+
+	if (renderThread.isRunning) {
+		FrameSnapshot& snapshot = renderThread.snapshots.Back();
+		snapshot.meshWrites.push_back({ pMesh, true, snapshot.meshData.size(), size, offset, indexCount, 0u, 0u });
+		snapshot.meshData.insert(snapshot.meshData.end(), (char const*)pVertices, (char const*)pVertices + size);
+		return true;
+	}
+	return pMesh->UpdateRange(pVertices, offset, size, indexCount);
+}
+
+void EE::Graphics::SetObjectTexture(EEObject object, uint32_t binding, EETexture texture)
+{
+	// The descriptor set is rewritten in place, so no frame in flight may still use it
+	WaitForRenderThread();
+	vkQueueWaitIdle(pDevice->AcquireQueue(vulkan::GRAPHICS_FAMILY));
+
+	currentObjects[*object]->SetTexture(binding, currentTextures[*texture]);
 }
 
 
@@ -449,6 +745,8 @@ void Graphics::vk_instance()
 		if (settings.validation) {
 			instanceExtensions.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 		}
+		// Needed to query the memory budget of the device (dropped by the instance if not supported)
+		instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
 	}
 
 	pInstance = new vulkan::Instance(*pWindow, instanceLayers, instanceExtensions);
@@ -473,6 +771,24 @@ void Graphics::vk_device()
 
 	// Create the device handle
 	pDevice = new vulkan::Device(pInstance, pWindow, pAllocator);
+
+	// Indirect draws of indirect shaders, the renderer falls back to single or direct draws without them
+	enabledFeatures.multiDrawIndirect = pDevice->supportedFeatures.multiDrawIndirect;
+	enabledFeatures.drawIndirectFirstInstance = pDevice->supportedFeatures.drawIndirectFirstInstance;
+
+	// Block compressed textures, BC1-5 are decoded on the CPU without them
+	enabledFeatures.textureCompressionBC = pDevice->supportedFeatures.textureCompressionBC;
+	enabledFeatures.textureCompressionETC2 = pDevice->supportedFeatures.textureCompressionETC2;
+
+	// Heap usage and budget for the memory stats, if the driver can report them
+	bool hasProperties2{ false };
+	for (char const* curExtension : pInstance->enabledExtensions) {
+		if (strcmp(curExtension, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0) hasProperties2 = true;
+	}
+	if (hasProperties2 && pDevice->ExtensionSupported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+
 	VK_CHECK(pDevice->Create(enabledFeatures, layers, extensions));
 }
 
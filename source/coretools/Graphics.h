@@ -5,7 +5,13 @@
 /////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
 #include "vkcore/vulkanRenderer.h"
+#include "TripleBuffer.h"
 
 
 namespace EE {
@@ -15,6 +21,46 @@ namespace EE {
 	struct Buffer;
 	struct Texture;
 
+	/* @brief Everything the render thread needs to record and present one frame, filled when the frame is drawn */
+	struct FrameSnapshot
+	{
+		/* @brief Visible objects with the range of their mesh they had when the frame was drawn */
+		std::vector<vulkan::Renderer::DrawItem> drawList;
+		EEColor clearColor;
+		/* @brief 3d camera the objects are culled with */
+		glm::mat4 viewProjection3D;
+		bool hasCamera3D;
+
+		/* @brief Buffer updates of this frame, the data of every write is packed into uniformData */
+		struct UniformWrite {
+			Buffer* pBuffer;
+			size_t offset;
+		};
+		std::vector<UniformWrite> uniformWrites;
+		std::vector<char> uniformData;
+
+		/**
+		 * Mesh updates of this frame, applied in order before the frame is recorded so the vertices
+		 * always match the index ranges of the draw list. The vertices are packed into meshData and
+		 * the indices of full updates into meshIndices.
+		 **/
+		struct MeshWrite {
+			Mesh* pMesh;
+			bool isRange;
+			size_t dataOffset;
+			size_t dataSize;
+			/* @brief Range updates: destination of the data in the vertex buffer and the new amount of indices drawn */
+			size_t rangeOffset;
+			uint32_t indexCount;
+			/* @brief Full updates: the new indices */
+			size_t indicesOffset;
+			size_t amountIndices;
+		};
+		std::vector<MeshWrite> meshWrites;
+		std::vector<char> meshData;
+		std::vector<uint32_t> meshIndices;
+	};
+
 	struct Graphics
 	{
 		/* @brief The window this graphics are created for */
@@ -42,6 +88,12 @@ namespace EE {
 			glm::mat4 baseViewRH;
 		} matrices;
 
+		/* @brief Camera the 3d objects are culled with, set by the user */
+		struct {
+			glm::mat4 viewProjection{ 1.0f };
+			bool isSet{ false };
+		} camera3D;
+
 		/* @brief Holds settings for the vulkan handling */
 		struct {
 #ifdef _DEBUG
@@ -51,8 +103,30 @@ namespace EE {
 #endif
 			float nearPlane{ 0.1f };
 			float farPlane{ 1000.0f };
+			bool renderThread{ false };
 		} settings;
 
+		/**
+		 * Render thread, only started if the application was created with renderThread. Draw then only
+		 * publishes a snapshot of the frame and the render thread records and presents it, while the
+		 * caller already works on the next one. The caller is never more than one frame ahead.
+		 **/
+		struct {
+			std::thread thread;
+			bool isRunning{ false };
+			/* @brief Snapshots handed over lock free, the caller fills the back one and the render thread draws the front one */
+			CORETOOLS::TripleBuffer<FrameSnapshot> snapshots;
+			/* @brief Held by the render thread while drawing a frame and by the caller while it uses the queue (creation/release/resize) */
+			std::mutex resourceMutex;
+			/* @brief Only used to sleep till there is something to do for either side */
+			std::mutex signalMutex;
+			std::condition_variable signal;
+			std::atomic<bool> isRendering{ false };
+			bool quit{ false };
+			/* @brief Stats of the last drawn frame, copied under the signalMutex so reading them never waits for a frame */
+			EEFrameStats frameStats{};
+		} renderThread;
+
 		/// Allocated resource tracking
 		std::vector<uint32_t*> iCurrentMeshes;
 		std::vector<EE::Mesh*> currentMeshes;
@@ -78,13 +152,16 @@ namespace EE {
 			 * layout(location = 0) in vec3 position;
 			 *
 			 * layout(binding = 0) uniform UBO {
-			 *	 mat4 ortho;
-			 *	 mat4 baseView;
 			 *	 mat4 world;
 			 * } ubo;
+			 *
+			 * layout(binding = 2) uniform CameraUBO {
+			 *	 mat4 ortho;
+			 *	 mat4 baseView;
+			 * } camera;
 			 * 
 			 * void main() {
-			 * 	 gl_Position = ubo.ortho * ubo.baseView * ubo.world * vec4(position, 1.0);
+			 * 	 gl_Position = camera.ortho * camera.baseView * ubo.world * vec4(position, 1.0);
 			 * }
 			 *
 			 **********************FRAGMENT**********************
@@ -104,6 +181,12 @@ namespace EE {
 			EEShader color2D{ nullptr };
 		} shader;
 
+		/// Predefined buffers
+		struct {
+			/* @brief Ortho and base view matrix (EEShaderColor2D::CameraUBO) shared by all 2d objects, only updated on resize */
+			EEBuffer camera2D{ nullptr };
+		} buffer;
+
 
 		/**
 		 * Default constructor
@@ -126,17 +209,39 @@ namespace EE {
 		bool Create(Window* pWindow, EEApplicationCreateInfo const& appCInfo);
 
 		/**
-		 * Draws all current objects
+		 * Draws all current objects. If the render thread is running only a snapshot of the visible
+		 * objects and the buffer/mesh updates since the last call is published to it.
 		 **/
 		void Draw(EEColor const& color);
 
+		/* @brief Starts/stops the render thread, stopping draws the frame still published before */
+		void StartRenderThread();
+		void StopRenderThread();
+
+		/**
+		 * Waits till the render thread drew every published frame, so no frame uses the current
+		 * resources anymore. Does nothing if the render thread isn't running.
+		 **/
+		void WaitForRenderThread();
+
+		/* @brief Loop of the render thread drawing each published snapshot */
+		void RenderLoop();
+
+		/* @brief Applies the buffer and mesh updates staged in the snapshot, in the order they were made */
+		void ApplyWrites(FrameSnapshot const& snapshot);
+
 		/**
 		 * Recreates/Reconfigures the renderer to the new current size
 		 **/
 		void Resize();
 
+		/* @brief Returns the stats of the last frame the renderer recorded/finished */
+		EEFrameStats GetFrameStats();
+
 		/* @brief Create methods for any type of vulkan resource representation */
-		EEMesh CreateMesh(void const* pVertices, size_t amountVertices, std::vector<uint32_t> const& indices);
+		EEMesh CreateMesh(void const* pVertices, size_t amountVertices, std::vector<uint32_t> const& indices, EEVertexInput const* pVertexInput);
+		EEMesh CreateMesh(char const* fileName);
+		EEMesh CreateMeshFromFile(char const* fileName);
 		EEBuffer CreateBuffer(size_t bufferSize);
 		EETexture CreateTexture(char const* fileName, bool enableMipMapping, bool unnormalizedCoordinates);
 		EETexture CreateTexture(EETextureCreateInfo const& textureCInfo);
@@ -150,9 +255,11 @@ namespace EE {
 		void ReleaseTexture(EETexture&);
 		void ReleaseBuffer(EEBuffer&);
 
-		/* @brief Update methods for buffer and mesh */
+		/* @brief Update methods for buffer, mesh and object */
 		void UpdateBuffer(EEBuffer buffer, void const* pData);
 		void UpdateMesh(EEMesh, void const* pVertices, size_t bufferSize, std::vector<uint32_t> const& indices);
+		bool UpdateMeshRange(EEMesh, void const* pVertices, size_t offset, size_t size, uint32_t indexCount);
+		void SetObjectTexture(EEObject, uint32_t binding, EETexture texture);
 
 
 		void vk_instance();
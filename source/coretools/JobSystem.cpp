@@ -0,0 +1,257 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: JobSystem.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "JobSystem.h"
+
+/* @brief Amount of failed searches for a job before a worker goes to sleep */
+#define SPIN_COUNT 64u
+
+using namespace CORETOOLS;
+
+/* @brief System the calling thread works for and its index in there */
+static thread_local JobSystem const* t_pJobSystem{ nullptr };
+static thread_local uint32_t t_workerIndex{ ~0u };
+/* @brief State of the random victim selection of the calling thread */
+static thread_local uint32_t t_randomState{ 0x9E3779B9u };
+
+
+//-------------------------------------------------------------------
+// Deque
+//-------------------------------------------------------------------
+bool JobSystem::Deque::Push(Job const& job)
+{
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+	if (b - t >= DEQUE_CAPACITY) return false;
+
+	jobs[b & (DEQUE_CAPACITY - 1)] = job;
+	std::atomic_thread_fence(std::memory_order_release);
+	bottom.store(b + 1, std::memory_order_relaxed);
+	return true;
+}
+
+bool JobSystem::Deque::Pop(Job& jobOut)
+{
+	// Reserve the bottom job before looking at the top, stealers see the reservation
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+
+	if (t > b) {
+		// Was empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	jobOut = jobs[b & (DEQUE_CAPACITY - 1)];
+	if (t < b) return true;
+
+	// Last job, a stealer might take it at the same time
+	bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_relaxed);
+	return won;
+}
+
+bool JobSystem::Deque::Steal(Job& jobOut)
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+	if (t >= b) return false;
+
+	// Only valid if no other thread took the job in the meantime
+	jobOut = jobs[t & (DEQUE_CAPACITY - 1)];
+	return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+
+//-------------------------------------------------------------------
+// JobSystem
+//-------------------------------------------------------------------
+JobSystem::JobSystem(uint32_t amountThreads)
+{
+	static_assert((DEQUE_CAPACITY & (DEQUE_CAPACITY - 1)) == 0, "The deque capacity must be a power of two");
+
+	if (amountThreads == 0u) amountThreads = std::thread::hardware_concurrency();
+	if (amountThreads == 0u) amountThreads = 1u;
+
+	for (uint32_t i = 0u; i < amountThreads; i++) {
+		m_deques.push_back(new Deque);
+	}
+
+	// The creating thread is worker zero, a job system it already belongs to (i.e. the shared one) gets it back on destruction
+	m_pPreviousSystem = t_pJobSystem;
+	m_previousWorkerIndex = t_workerIndex;
+	t_pJobSystem = this;
+	t_workerIndex = 0u;
+
+	for (uint32_t i = 1u; i < amountThreads; i++) {
+		m_threads.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	// Queued jobs are still executed
+	Job job;
+	while (FindJob(job)) Execute(job);
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_quit = true;
+	}
+	m_wakeUp.notify_all();
+
+	for (size_t i = 0u; i < m_threads.size(); i++) {
+		m_threads[i].join();
+	}
+	for (size_t i = 0u; i < m_deques.size(); i++) {
+		delete m_deques[i];
+	}
+
+	if (t_pJobSystem == this) {
+		t_pJobSystem = m_pPreviousSystem;
+		t_workerIndex = m_previousWorkerIndex;
+	}
+}
+
+void JobSystem::Run(JobFunction pFunction, void* pData, JobCounter& counter, uint32_t begin, uint32_t end)
+{
+	Job job{ pFunction, pData, begin, end, &counter };
+	counter.pending.fetch_add(1u, std::memory_order_relaxed);
+
+	// Counted before the job is visible, otherwise a thief could take it and decrement first
+	m_queuedJobs.fetch_add(1u);
+
+	uint32_t worker = CurrentWorker();
+	if (worker != ~0u) {
+		// A full deque means there is more than enough work queued, just do it now
+		if (!m_deques[worker]->Push(job)) {
+			m_queuedJobs.fetch_sub(1u);
+			Execute(job);
+			return;
+		}
+	} else {
+		std::lock_guard<std::mutex> lock(m_sharedMutex);
+		m_sharedJobs.push_back(job);
+		m_amountShared.fetch_add(1u);
+	}
+
+	// Only wake a worker if one is sleeping, it rechecks the queued jobs after registering as sleeping
+	if (m_sleepingWorkers.load() > 0u) {
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_wakeUp.notify_one();
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	Job job;
+	while (!counter.IsDone()) {
+		if (FindJob(job)) Execute(job);
+		else std::this_thread::yield();
+	}
+}
+
+bool JobSystem::RunPendingJob()
+{
+	Job job;
+	if (!FindJob(job)) return false;
+	Execute(job);
+	return true;
+}
+
+uint32_t JobSystem::GetAmountThreads() const
+{
+	return uint32_t(m_deques.size());
+}
+
+JobSystem& JobSystem::Shared()
+{
+	static JobSystem jobSystem;
+	return jobSystem;
+}
+
+void JobSystem::WorkerLoop(uint32_t workerIndex)
+{
+	t_pJobSystem = this;
+	t_workerIndex = workerIndex;
+	t_randomState = 0x9E3779B9u * (workerIndex + 1u);
+
+	Job job;
+	uint32_t failedSearches = 0u;
+	for (;;) {
+		if (FindJob(job)) {
+			Execute(job);
+			failedSearches = 0u;
+			continue;
+		}
+
+		// Spin a bit since new jobs are likely to come in soon (fine grained jobs)
+		if (++failedSearches < SPIN_COUNT) {
+			std::this_thread::yield();
+			continue;
+		}
+		failedSearches = 0u;
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleepingWorkers.fetch_add(1u);
+		m_wakeUp.wait(lock, [this] { return m_quit || m_queuedJobs.load() > 0u; });
+		m_sleepingWorkers.fetch_sub(1u);
+		if (m_quit && m_queuedJobs.load() == 0u) return;
+	}
+}
+
+bool JobSystem::FindJob(Job& jobOut)
+{
+	uint32_t worker = CurrentWorker();
+	bool found = false;
+
+	// Own deque first (newest job, its data is likely still in cache)
+	if (worker != ~0u) {
+		found = m_deques[worker]->Pop(jobOut);
+	}
+
+	// Jobs of threads that aren't workers
+	if (!found && m_amountShared.load() > 0u) {
+		std::lock_guard<std::mutex> lock(m_sharedMutex);
+		if (!m_sharedJobs.empty()) {
+			jobOut = m_sharedJobs.back();
+			m_sharedJobs.pop_back();
+			m_amountShared.fetch_sub(1u);
+			found = true;
+		}
+	}
+
+	// Steal the oldest job of another deque, starting at a random one so stealers spread out
+	if (!found && m_deques.size() > 1u) {
+		t_randomState ^= t_randomState << 13;
+		t_randomState ^= t_randomState >> 17;
+		t_randomState ^= t_randomState << 5;
+		size_t start = t_randomState % m_deques.size();
+		for (size_t i = 0u; i < m_deques.size() && !found; i++) {
+			size_t victim = (start + i) % m_deques.size();
+			if (victim == worker) continue;
+			found = m_deques[victim]->Steal(jobOut);
+		}
+	}
+
+	if (found) m_queuedJobs.fetch_sub(1u);
+	return found;
+}
+
+void JobSystem::Execute(Job const& job)
+{
+	job.pFunction(job.pData, job.begin, job.end);
+	job.pCounter->pending.fetch_sub(1u, std::memory_order_acq_rel);
+}
+
+uint32_t JobSystem::CurrentWorker() const
+{
+	return (t_pJobSystem == this) ? t_workerIndex : ~0u;
+}
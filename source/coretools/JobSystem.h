@@ -0,0 +1,191 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: JobSystem.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+namespace CORETOOLS
+{
+	/**
+	 * Counts the unfinished jobs of a group. Every job started with a counter increments it and
+	 * decrements it when done, so waiting on the counter joins all jobs forked with it (including
+	 * the ones that jobs of the group started themselves).
+	 **/
+	struct JobCounter
+	{
+		std::atomic<uint32_t> pending{ 0u };
+
+		/* @brief Returns wether all jobs of this counter are done */
+		bool IsDone() const { return pending.load(std::memory_order_acquire) == 0u; }
+	};
+
+	/**
+	 * Executes small jobs on a fixed set of worker threads. Every thread (the one that created the
+	 * system included) has its own deque, it pushes and pops jobs at the bottom without contention,
+	 * idle threads steal from the top of the others. Waiting for a counter executes jobs instead of
+	 * blocking, so a job can fork further jobs and join them.
+	 **/
+	class JobSystem
+	{
+	public:
+		/* @brief Function of a job, it processes the indices [begin, end) of the data passed in */
+		typedef void(*JobFunction)(void* pData, uint32_t begin, uint32_t end);
+
+		struct Job {
+			JobFunction	pFunction;
+			void*				pData;
+			uint32_t		begin;
+			uint32_t		end;
+			JobCounter*	pCounter;
+		};
+
+	private:
+		/* @brief Amount of jobs a deque can hold, pushing to a full deque executes the job right away */
+		static constexpr int64_t DEQUE_CAPACITY{ 4096 };
+
+		/* @brief Work stealing deque (Chase-Lev), only the owning thread pushes and pops */
+		struct Deque {
+			std::atomic<int64_t> top{ 0 };
+			std::atomic<int64_t> bottom{ 0 };
+			Job jobs[DEQUE_CAPACITY];
+
+			bool Push(Job const& job);
+			bool Pop(Job& jobOut);
+			bool Steal(Job& jobOut);
+		};
+
+	public:
+		/**
+		 * Starts the worker threads. The calling thread becomes worker zero, it only executes
+		 * jobs while waiting on a counter or when calling RunPendingJob.
+		 *
+		 * @param amountThreads		Amount of threads including the calling one (defaults to one per core)
+		 **/
+		JobSystem(uint32_t amountThreads = 0u);
+
+		/**
+		 * Executes the jobs still queued and joins the worker threads
+		 **/
+		~JobSystem();
+
+		/**
+		 * Queues a job on the deque of the calling thread (threads not known to the system
+		 * queue on a shared list).
+		 *
+		 * @param pFunction		Function that will be called with pData and the range
+		 * @param pData				Data of the job, must be alive till the counter is done
+		 * @param counter			Counter that will be incremented now and decremented when the job is done
+		 * @param begin				First index the job processes (defaulted)
+		 * @param end					Index behind the last one the job processes (defaulted)
+		 **/
+		void Run(JobFunction pFunction, void* pData, JobCounter& counter, uint32_t begin = 0u, uint32_t end = 1u);
+
+		/**
+		 * Splits the indices [0, count) into jobs of grainSize indices calling function(index) for each.
+		 * The function must be alive till the counter is done.
+		 **/
+		template<typename TFunction>
+		void ParallelFor(uint32_t count, uint32_t grainSize, TFunction const& function, JobCounter& counter);
+
+		/* @brief ParallelFor that returns when all indices are processed */
+		template<typename TFunction>
+		void ParallelFor(uint32_t count, uint32_t grainSize, TFunction const& function);
+
+		/**
+		 * Executes queued jobs till every job of the counter is done
+		 **/
+		void Wait(JobCounter& counter);
+
+		/**
+		 * Executes one queued job if there is one, for a main loop that has some time left.
+		 *
+		 * @return False if no job was found
+		 **/
+		bool RunPendingJob();
+
+		/* @brief Returns the amount of threads executing jobs (including the creating one) */
+		uint32_t GetAmountThreads() const;
+
+		/**
+		 * Returns the job system with one thread per core the engine's tools (obj loading, mip
+		 * chains...) share. It is created on first use, the thread using it first becomes worker zero.
+		 **/
+		static JobSystem& Shared();
+
+		JobSystem(JobSystem const&) = delete;
+		JobSystem(JobSystem&&) = delete;
+		JobSystem& operator=(JobSystem const&) = delete;
+		JobSystem& operator=(JobSystem&&) = delete;
+
+	private:
+		/* @brief Loop of the worker thread with the index passed in */
+		void WorkerLoop(uint32_t workerIndex);
+
+		/* @brief Takes a job from the own deque, the shared list or another deque */
+		bool FindJob(Job& jobOut);
+
+		/* @brief Calls the job and decrements its counter */
+		void Execute(Job const& job);
+
+		/* @brief Returns the index of the calling thread (~0u if it is not a worker) */
+		uint32_t CurrentWorker() const;
+
+	private:
+		/* @brief The deque of every worker, index zero is the creating thread */
+		std::vector<Deque*> m_deques;
+		std::vector<std::thread> m_threads;
+
+		/* @brief Job system and worker index of the creating thread before this one was created */
+		JobSystem const* m_pPreviousSystem{ nullptr };
+		uint32_t m_previousWorkerIndex{ ~0u };
+
+		/* @brief Jobs queued by threads that are not workers */
+		std::vector<Job> m_sharedJobs;
+		std::mutex m_sharedMutex;
+		std::atomic<uint32_t> m_amountShared{ 0u };
+
+		/* @brief Amount of queued jobs, idle workers only sleep if it is zero */
+		std::atomic<uint32_t> m_queuedJobs{ 0u };
+		std::atomic<uint32_t> m_sleepingWorkers{ 0u };
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wakeUp;
+		bool m_quit{ false };
+	};
+
+
+	template<typename TFunction>
+	void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, TFunction const& function, JobCounter& counter)
+	{
+		if (grainSize == 0u) grainSize = 1u;
+
+		JobFunction pTrampoline = [](void* pData, uint32_t begin, uint32_t end) {
+			TFunction const& func = *static_cast<TFunction const*>(pData);
+			for (uint32_t i = begin; i < end; i++) func(i);
+		};
+
+		for (uint32_t begin = 0u; begin < count; begin += grainSize) {
+			uint32_t end = (count - begin > grainSize) ? begin + grainSize : count;
+			Run(pTrampoline, const_cast<TFunction*>(&function), counter, begin, end);
+		}
+	}
+
+	template<typename TFunction>
+	void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, TFunction const& function)
+	{
+		JobCounter counter;
+		ParallelFor(count, grainSize, function, counter);
+		Wait(counter);
+	}
+}
@@ -0,0 +1,79 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: TripleBuffer.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <atomic>
+#include <cstdint>
+
+
+namespace CORETOOLS
+{
+	/**
+	 * Hands over values from one producer thread to one consumer thread without locking.
+	 * The producer writes into its back slot and publishes it, the consumer takes the latest
+	 * published slot as its front. A third slot sits in the middle, so neither side ever waits
+	 * for the other to finish with a slot, publishing and taking are a single atomic exchange.
+	 **/
+	template<typename T>
+	class TripleBuffer
+	{
+	public:
+		TripleBuffer() = default;
+
+		/* @brief The slot only the producer writes to */
+		T& Back() { return m_slots[m_back]; }
+
+		/* @brief The slot only the consumer reads from (the last one it took) */
+		T& Front() { return m_slots[m_front]; }
+
+		/**
+		 * Publishes the back slot and makes the previous middle slot the new back.
+		 *
+		 * @return False if the previous middle slot was never taken by the consumer, its
+		 *		content is then in the new back slot again
+		 **/
+		bool Publish()
+		{
+			uint8_t previous = m_middle.exchange(uint8_t(m_back | FRESH_BIT));
+			m_back = previous & INDEX_MASK;
+			return !(previous & FRESH_BIT);
+		}
+
+		/* @brief Returns wether a slot was published that the consumer didn't take yet */
+		bool HasFresh() const { return (m_middle.load() & FRESH_BIT) != 0u; }
+
+		/**
+		 * Takes the latest published slot as the new front.
+		 *
+		 * @return False if nothing new was published since the last call
+		 **/
+		bool Take()
+		{
+			// Only the producer sets the fresh bit, so it can't vanish between this check and the exchange
+			if (!HasFresh()) return false;
+			m_front = m_middle.exchange(m_front) & INDEX_MASK;
+			return true;
+		}
+
+		TripleBuffer(TripleBuffer const&) = delete;
+		TripleBuffer(TripleBuffer&&) = delete;
+		TripleBuffer& operator=(TripleBuffer const&) = delete;
+		TripleBuffer& operator=(TripleBuffer&&) = delete;
+
+	private:
+		static constexpr uint8_t INDEX_MASK{ 0x03 };
+		static constexpr uint8_t FRESH_BIT{ 0x04 };
+
+		T m_slots[3];
+		/* @brief Slot indices, the middle one is shared and flagged if it wasn't taken yet */
+		uint8_t m_back{ 0u };
+		std::atomic<uint8_t> m_middle{ 1u };
+		uint8_t m_front{ 2u };
+	};
+}
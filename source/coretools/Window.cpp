@@ -14,6 +14,12 @@
 
 using namespace EE;
 
+#define MAX(x, y) ((x > y) ? x : y)
+
+// Initial capacity of the input event ring buffer and the size it may grow to if nobody drains it
+#define INPUT_EVENT_CAPACITY 256u
+#define MAX_INPUT_EVENTS 65536u
+
 
 void glfw_onResize(GLFWwindow* window, int width, int height)
 {
@@ -29,6 +35,7 @@ void glfw_onResize(GLFWwindow* window, int width, int height)
 void glfw_keyEvent(GLFWwindow* window, int key, int scanCode, int action, int mods)
 {
 	Window* eewindow = reinterpret_cast<Window::UserData*>(glfwGetWindowUserPointer(window))->window;
+	if (key < 0 || key >= GLFW_KEY_LAST) return; //< GLFW_KEY_UNKNOWN
 
 	if (action == GLFW_PRESS) {
 		eewindow->input.keysPressed[key] = true;
@@ -36,15 +43,42 @@ void glfw_keyEvent(GLFWwindow* window, int key, int scanCode, int action, int mo
 	} else if (action == GLFW_RELEASE) {
 		eewindow->input.keysPressed[key] = false;
 	}
+
+	// Repeats of a held key are queued as further presses (i.e. for text editing keys), the hit state stays untouched
+	EEInputEvent event{};
+	event.type = EE_INPUT_EVENT_TYPE_KEY;
+	event.key = EEKey(key);
+	event.pressed = (action != GLFW_RELEASE);
+	event.repeated = (action == GLFW_REPEAT);
+	eewindow->PushEvent(event);
 }
 
 void glfw_cursorPos(GLFWwindow* window, double xpos, double ypos) {
 	Window* eewindow = reinterpret_cast<Window::UserData*>(glfwGetWindowUserPointer(window))->window;
 
-	eewindow->input.mouseXDelta = xpos - eewindow->input.mouseX;
-	eewindow->input.mouseYDelta = ypos - eewindow->input.mouseY;
+	// Accumulate, the cursor can move multiple times between two polls
+	EEInputEvent event{};
+	event.type = EE_INPUT_EVENT_TYPE_MOUSE_MOVE;
+	event.position = { xpos, ypos };
+	event.delta = { xpos - eewindow->input.mouseX, ypos - eewindow->input.mouseY };
+
+	eewindow->input.mouseXDelta += event.delta.x;
+	eewindow->input.mouseYDelta += event.delta.y;
 	eewindow->input.mouseX = xpos;
 	eewindow->input.mouseY = ypos;
+
+	eewindow->PushEvent(event);
+}
+
+void glfw_scroll(GLFWwindow* window, double xoffset, double yoffset)
+{
+	Window* eewindow = reinterpret_cast<Window::UserData*>(glfwGetWindowUserPointer(window))->window;
+
+	EEInputEvent event{};
+	event.type = EE_INPUT_EVENT_TYPE_SCROLL;
+	event.position = { eewindow->input.mouseX, eewindow->input.mouseY };
+	event.delta = { xoffset, yoffset };
+	eewindow->PushEvent(event);
 }
 
 void glfw_mouseButton(GLFWwindow* window, int button, int action, int mods)
@@ -68,7 +102,17 @@ void glfw_mouseButton(GLFWwindow* window, int button, int action, int mods)
 			eewindow->input.mouseDown |= EE_MOUSE_BUTTON_LEFT;
 			eewindow->input.mouseHit |= EE_MOUSE_BUTTON_LEFT;
 		} else eewindow->input.mouseDown &= (EE_MOUSE_BUTTON_RIGHT | EE_MOUSE_BUTTON_MIDDLE);
+	} else {
+		return;
 	}
+
+	EEInputEvent event{};
+	event.type = EE_INPUT_EVENT_TYPE_MOUSE_BUTTON;
+	event.button = (button == GLFW_MOUSE_BUTTON_RIGHT) ? EE_MOUSE_BUTTON_RIGHT
+							 : (button == GLFW_MOUSE_BUTTON_MIDDLE) ? EE_MOUSE_BUTTON_MIDDLE : EE_MOUSE_BUTTON_LEFT;
+	event.pressed = (action == GLFW_PRESS);
+	event.position = { eewindow->input.mouseX, eewindow->input.mouseY };
+	eewindow->PushEvent(event);
 }
 
 void glfw_focus(GLFWwindow* window, int gainedFocus)
@@ -81,7 +125,12 @@ void glfw_focus(GLFWwindow* window, int gainedFocus)
 void glfw_charMods(GLFWwindow* window, unsigned int codePoint, int mods)
 {
 	EE::Window* eewindow = reinterpret_cast<EE::Window::UserData*>(glfwGetWindowUserPointer(window))->window;
-	eewindow->input.textUTF8 = codePoint;
+	eewindow->input.textUTF8.push_back(uint32_t(codePoint));
+
+	EEInputEvent event{};
+	event.type = EE_INPUT_EVENT_TYPE_CHAR;
+	event.codePoint = uint32_t(codePoint);
+	eewindow->PushEvent(event);
 	/*if (codePoint <= 0x7f)
 	{
 		out.append(1, static_cast<char>(codePoint));
@@ -130,6 +179,9 @@ Window::Window()
 	input.keysPressed = new bool[GLFW_KEY_LAST];
 	input.keysHit = new bool[GLFW_KEY_LAST];
 	input.mouseDown = input.mouseHit = 0u;
+	input.mouseX = input.mouseY = 0.0;
+	input.mouseXDelta = input.mouseYDelta = 0.0;
+	events.buffer.resize(INPUT_EVENT_CAPACITY);
 	assert(input.keysPressed && input.keysHit);
 	memset(input.keysPressed, 0, sizeof(bool) * GLFW_KEY_LAST);
 	memset(input.keysHit, 0, sizeof(bool) * GLFW_KEY_LAST);
@@ -186,6 +238,7 @@ EEBool32 Window::Create(EEApplicationCreateInfo const& windowCInfo, EE::fpEEWind
 	glfwSetMouseButtonCallback(window, glfw_mouseButton);
 	glfwSetWindowFocusCallback(window, glfw_focus);
 	glfwSetCharModsCallback(window, glfw_charMods);
+	glfwSetScrollCallback(window, glfw_scroll);
 
 	return EE_TRUE;
 }
@@ -207,13 +260,51 @@ bool Window::PollEvents()
 	// Reset input values
 	memset(input.keysHit, 0, sizeof(bool) * GLFW_KEY_LAST);
 	input.mouseXDelta = input.mouseYDelta = 0.0;
-	input.mouseHit = input.textUTF8 = 0;
+	input.mouseHit = 0;
+	input.textUTF8.clear();
 
 	glfwPollEvents();
 
 	return glfwWindowShouldClose(window);
 }
 
+void Window::PushEvent(EEInputEvent& event)
+{
+	event.timestamp = glfwGetTime();
+
+	if (events.count == events.buffer.size()) {
+		if (events.buffer.size() >= MAX_INPUT_EVENTS) {
+			// Nobody drains the queue, so the oldest event has to go
+			events.first = (events.first + 1) % events.buffer.size();
+			events.count--;
+		} else {
+			// Grow instead of overwriting, the events are linearized in the new buffer
+			std::vector<EEInputEvent> grown(MAX(2 * events.buffer.size(), size_t(INPUT_EVENT_CAPACITY)));
+			for (size_t i = 0u; i < events.count; i++) {
+				grown[i] = events.buffer[(events.first + i) % events.buffer.size()];
+			}
+			events.buffer.swap(grown);
+			events.first = 0u;
+		}
+	}
+
+	events.buffer[(events.first + events.count) % events.buffer.size()] = event;
+	events.count++;
+}
+
+size_t Window::PopEvents(std::vector<EEInputEvent>& eventsOut)
+{
+	size_t count = events.count;
+	eventsOut.reserve(eventsOut.size() + count);
+	for (size_t i = 0u; i < count; i++) {
+		eventsOut.push_back(events.buffer[(events.first + i) % events.buffer.size()]);
+	}
+
+	events.first = 0u;
+	events.count = 0u;
+	return count;
+}
+
 vulkan::SurfaceDetails Window::GetSurfaceDetails(VkPhysicalDevice physicalDevice) const
 {
 	vulkan::SurfaceDetails details;
@@ -82,9 +82,17 @@ namespace EE {
 			double mouseYDelta;
 			uint32_t mouseDown;
 			uint32_t mouseHit;
-			uint32_t textUTF8;
+			/* @brief Code points of every character typed since the last poll */
+			std::vector<uint32_t> textUTF8;
 		} input;
 
+		/* @brief Ring buffer of all input events in the order they were received, drained by PopEvents */
+		struct {
+			std::vector<EEInputEvent> buffer;
+			size_t first{ 0u };
+			size_t count{ 0u };
+		} events;
+
 		/* @brief User data that is needed in glfw callbacks */
 		UserData userData;
 
@@ -133,6 +141,19 @@ namespace EE {
 		/* @brief Call to poll the events of the window */
 		bool PollEvents();
 
+		/**
+		 * Stamps the event with the current time and appends it to the ring buffer. The buffer
+		 * grows if it is full, so events are only dropped if nobody drains it at all.
+		 **/
+		void PushEvent(EEInputEvent& event);
+
+		/**
+		 * Moves all queued events in the order they were received to the end of the vector passed in
+		 *
+		 * @return The amount of events that were appended
+		 **/
+		size_t PopEvents(std::vector<EEInputEvent>& eventsOut);
+
 		/**
 		 * Get the supported formats, present modes and other capabilities of the surface that is used
 		 * by this device alias was created for the window the this device uses
@@ -121,6 +121,13 @@ enum EEFormat {
 	EE_FORMAT_R8_SNORM,
 	EE_FORMAT_R8G8B8A8_UINT,
 	EE_FORMAT_R8G8B8A8_UNORM,
+	// Packed vertex formats (e.g. half uvs, normals in 8/10 bit), see tools::quantizeHalf/quantizeSnorm
+	EE_FORMAT_R16G16_SFLOAT,
+	EE_FORMAT_R16G16B16A16_SFLOAT,
+	EE_FORMAT_R16G16B16A16_SNORM,
+	EE_FORMAT_R8G8B8A8_SNORM,
+	EE_FORMAT_A2B10G10R10_UNORM_PACK32,
+	EE_FORMAT_A2B10G10R10_SNORM_PACK32,		//< Optional as vertex format, not every device supports it
 };
 
 enum EEMouseButton {
@@ -129,6 +136,14 @@ enum EEMouseButton {
 	EE_MOUSE_BUTTON_LEFT		= 0x04,
 };
 
+enum EEInputEventType {
+	EE_INPUT_EVENT_TYPE_KEY,
+	EE_INPUT_EVENT_TYPE_CHAR,
+	EE_INPUT_EVENT_TYPE_MOUSE_MOVE,
+	EE_INPUT_EVENT_TYPE_MOUSE_BUTTON,
+	EE_INPUT_EVENT_TYPE_SCROLL
+};
+
 enum EERenderType {
 	EE_RENDER_TYPE_2D		= 0x01,
 	EE_RENDER_TYPE_3D		= 0x02,
@@ -161,7 +176,8 @@ enum EESplitscreen {
 	EE_SPLITSCREEN_TOP_RIGHT		= EE_SPLITSCREEN_TOP		| EE_SPLITSCREEN_RIGHT,
 	EE_SPLITSCREEN_BOTTOM_LEFT	= EE_SPLITSCREEN_BOTTOM | EE_SPLITSCREEN_LEFT,
 	EE_SPLITSCREEN_BOTTOM_RIGHT = EE_SPLITSCREEN_BOTTOM | EE_SPLITSCREEN_RIGHT,
-	EE_SPLITSCREEN_UNDEFINED		//< Forbidden if splitscreen mode was enabled in EEGraphicsCreateInfo
+	EE_SPLITSCREEN_UNDEFINED,		//< Forbidden if splitscreen mode was enabled in EEGraphicsCreateInfo
+	EE_SPLITSCREEN_ALL					= 0x10	//< Rendered on every field (e.g. a hud shared by all players)
 };
 
 enum EESplitscreenMode {
@@ -171,6 +187,15 @@ enum EESplitscreenMode {
 	EE_SPLITSCREEN_MODE_RASTER		 = EE_SPLITSCREEN_MODE_HORIZONTAL | EE_SPLITSCREEN_MODE_VERTICAL,
 };
 
+enum EEMemoryCategory {
+	EE_MEMORY_CATEGORY_MESH					= 0,
+	EE_MEMORY_CATEGORY_TEXTURE			= 1,
+	EE_MEMORY_CATEGORY_BUFFER				= 2,
+	EE_MEMORY_CATEGORY_DEPTH_IMAGE	= 3,
+	EE_MEMORY_CATEGORY_STAGING			= 4,
+	EE_MEMORY_CATEGORY_COUNT				= 5
+};
+
 enum EEWindowFlags {
 	EE_WINDOW_FLAGS_NONE		= 0x00,
 	EE_WINDOW_FLAGS_CENTERX = 0x01,
@@ -221,6 +246,47 @@ struct EEPadding {
 	float left, top, right, bottom;
 };
 
+/* @brief A single input as it was received, only the members of its type are valid */
+struct EEInputEvent {
+	EEInputEventType	type;
+	double						timestamp;	//< Seconds (high resolution timer of glfw) when the event was received
+	EEKey							key;				//< KEY
+	EEBool32					pressed;		//< KEY, MOUSE_BUTTON (false on release)
+	EEBool32					repeated;		//< KEY (true if the press was repeated by the system since the key is held)
+	uint32_t					codePoint;	//< CHAR (unicode code point)
+	EEMouseButton			button;			//< MOUSE_BUTTON
+	EEPoint64F				position;		//< MOUSE_MOVE, MOUSE_BUTTON (mouse position at the event)
+	EEPoint64F				delta;			//< MOUSE_MOVE (movement), SCROLL (scroll offset)
+};
+
+struct EEFrameStats {
+	EEBool32					gpuTimingsValid;	//< False if the gpu can't write timestamps or no frame finished yet
+	double						gpuTime3D;				//< Milliseconds the gpu spent in the 3d pass of the last finished frame
+	double						gpuTime2D;				//< Milliseconds the gpu spent in the 2d pass of the last finished frame
+	uint32_t					drawCalls;				//< Commands recorded for the last frame
+	uint32_t					pipelineBinds;
+	uint32_t					descriptorBinds;
+	uint32_t					bufferBinds;			//< Vertex/index buffer binds, meshes in the same geometry heap pages share them
+	uint32_t					culledObjects2D;	//< Visible 2d objects not recorded since they were outside of the screen
+	uint32_t					culledObjects3D;	//< Visible 3d objects not recorded since they were outside of the camera's frustum
+};
+
+struct EEMemoryHeapStats {
+	uint64_t					size;
+	uint64_t					usage;						//< Used by this process as reported by the driver (accounted usage without a budget)
+	uint64_t					budget;						//< What this process can use before allocations fail or hurt performance (size without a budget)
+	uint64_t					engineUsage;			//< Allocated by the engine itself
+	EEBool32					isDeviceLocal;
+};
+
+struct EEMemoryStats {
+	uint64_t					categoryBytes[EE_MEMORY_CATEGORY_COUNT];
+	uint32_t					categoryAllocations[EE_MEMORY_CATEGORY_COUNT];
+	EEBool32					hasBudget;				//< VK_EXT_memory_budget is available
+	uint32_t					heapCount;
+	EEMemoryHeapStats heaps[16];				//< VK_MAX_MEMORY_HEAPS
+};
+
 struct EEShaderInputDesc {
 	uint32_t location;
 	EEFormat format;
@@ -268,6 +334,7 @@ struct EEApplicationCreateInfo {
 	EEBool32					mouseDisabled;
 	EESplitscreenMode splitscreen;
 	EERenderType			rendererType;
+	EEBool32					renderThread;		//< Record and present on a dedicated thread, see EEApplication::Draw
 };
 
 struct EEShaderCreateInfo {
@@ -283,10 +350,11 @@ struct EEShaderCreateInfo {
 	EEBool32									is2DShader;
 	EEBool32									wireframe;
 	EEBool32									clockwise;
+	EEBool32									indirectDraw;			//< objects with meshes in the same geometry heap buffers are drawn with one indirect draw, see EEApplication::CreateShader
 };
 
 struct EETextureCreateInfo {
-	unsigned char* pData;
+	unsigned char const* pData;
 	EERect32U			 extent;
 	EEBool32			 unnormalizedCoordinates;
 	EEBool32			 enableMipMapping;
@@ -301,13 +369,16 @@ namespace EEShaderColor2D {
 	};
 	// binding = 0
 	struct VertexUBO {
-		glm::mat4 ortho;
-		glm::mat4 baseView;
 		glm::mat4 world;
 	};
 	// binding = 1
 	struct FragmentUBO {
 	  glm::vec4 fillColor;
 	};
+	// binding = 2 (shared by every 2d object, see EEApplication::AcquireCameraBuffer2D)
+	struct CameraUBO {
+		glm::mat4 ortho;
+		glm::mat4 baseView;
+	};
 
 }
@@ -8,6 +8,11 @@
 #include <fstream>
 #if defined(_WINDOWS)
 #include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 #include <cassert>
 
@@ -28,6 +33,72 @@ std::vector<char> EE::tools::readFile(char const* fileName)
 	}
 }
 
+bool EE::tools::mapFile(char const* fileName, MappedFile& fileOut)
+{
+	fileOut = MappedFile();
+#if defined(_WINDOWS)
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping) return false;
+
+	// The view keeps the mapping alive, so the handle can be closed right away
+	void const* pData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!pData) return false;
+
+	fileOut.pData = pData;
+	fileOut.size = static_cast<size_t>(size.QuadPart);
+#else
+	int file = open(fileName, O_RDONLY);
+	if (file < 0) return false;
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+		close(file);
+		return false;
+	}
+
+	// The mapping stays valid after the file descriptor is closed
+	void* pData = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (pData == MAP_FAILED) return false;
+
+	fileOut.pData = pData;
+	fileOut.size = static_cast<size_t>(fileStat.st_size);
+#endif
+	return true;
+}
+
+void EE::tools::unmapFile(MappedFile& file)
+{
+	if (!file.pData) return;
+#if defined(_WINDOWS)
+	UnmapViewOfFile(file.pData);
+#else
+	munmap(const_cast<void*>(file.pData), file.size);
+#endif
+	file = MappedFile();
+}
+
+uint64_t EE::tools::hashData(void const* pData, size_t size, uint64_t seed)
+{
+	unsigned char const* pBytes = static_cast<unsigned char const*>(pData);
+	for (size_t i = 0u; i < size; i++) {
+		seed ^= pBytes[i];
+		seed *= 1099511628211ull;
+	}
+	return seed;
+}
+
 std::vector<EEcstr> EE::tools::explodeString(EEcstr str, EEcstr del)
 {
 	std::vector<EEcstr> res;
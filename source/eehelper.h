@@ -12,8 +12,29 @@
 namespace EE {
 	namespace tools {
 
+		/* @brief A read only view of a whole file mapped into memory */
+		struct MappedFile {
+			void const* pData{ nullptr };
+			size_t size{ 0u };
+		};
+
 		extern std::vector<char> readFile(char const* fileName);
 
+		/**
+		 * Maps the whole file read only into memory. Nothing is printed on failure since
+		 * a missing file is a valid case for callers like caches.
+		 *
+		 * @param fileName	Destination of the file
+		 * @param fileOut		Will hold the view of the file (must be released with unmapFile)
+		 *
+		 * @return False if the file does not exist, is empty or could not be mapped
+		 **/
+		extern bool mapFile(char const* fileName, MappedFile& fileOut);
+		extern void unmapFile(MappedFile& file);
+
+		/* @brief 64 bit FNV-1a hash of the passed in data, pass the previous hash as seed to combine hashes */
+		extern uint64_t hashData(void const* pData, size_t size, uint64_t seed = 14695981039346656037ull);
+
 		extern std::vector<EEcstr> explodeString(EEcstr str, EEcstr del = STR(" "));
 		extern std::vector<EEstring> explodeString(EEstring str, EEstring del = STR(" "));
 
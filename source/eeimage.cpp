@@ -0,0 +1,176 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eeimage.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "eeimage.h"
+
+#include <algorithm>
+
+#include "eeprofiler.h"
+#include "coretools/JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define EEIMAGE_SSE2
+# include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define EEIMAGE_NEON
+# include <arm_neon.h>
+#endif
+
+/* @brief Minimum amount of destination pixels a job filters, smaller levels are filtered by the calling thread */
+#define MIN_PIXELS_PER_JOB (32u * 1024u)
+
+
+namespace {
+
+	/* @brief Rows of a level one job filters */
+	struct DownsampleJob {
+		unsigned char const* pSrc;
+		unsigned char* pDst;
+		uint32_t srcWidth;
+		uint32_t srcHeight;
+		uint32_t dstWidth;
+		uint32_t channels;
+		uint32_t rowBegin;
+		uint32_t rowEnd;
+	};
+
+	/**
+	 * Averages the 2x2 pixels of the two source rows behind every destination pixel starting at
+	 * x = 0, returns the amount of destination pixels it wrote. The rest is filtered by the caller.
+	 **/
+	uint32_t DownsampleRowSimd(unsigned char const* pRow0, unsigned char const* pRow1, unsigned char* pDst, uint32_t dstWidth, uint32_t channels)
+	{
+		uint32_t x = 0u;
+#if defined(EEIMAGE_SSE2)
+		__m128i const lowBytes = _mm_set1_epi16(0x00FF);
+		__m128i const rounding = _mm_set1_epi16(2);
+		if (channels == 4u) {
+			// Four destination pixels per step out of 32 bytes of both rows
+			__m128i const zero = _mm_setzero_si128();
+			for (; x + 4u <= dstWidth; x += 4u) {
+				__m128i result[2];
+				for (uint32_t half = 0u; half < 2u; half++) {
+					__m128i row0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pRow0 + (x * 2u + half * 4u) * 4u));
+					__m128i row1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pRow1 + (x * 2u + half * 4u) * 4u));
+					// Vertical sums of pixels 0/1 and 2/3 as 16 bit
+					__m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+					__m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+					// Horizontal sums of the neighbouring pixels
+					sum01 = _mm_add_epi16(sum01, _mm_srli_si128(sum01, 8));
+					sum23 = _mm_add_epi16(sum23, _mm_srli_si128(sum23, 8));
+					result[half] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23), rounding), 2);
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + x * 4u), _mm_packus_epi16(result[0], result[1]));
+			}
+		} else if (channels == 1u) {
+			// Sixteen destination pixels per step, the even and odd bytes are the horizontal neighbours
+			for (; x + 16u <= dstWidth; x += 16u) {
+				__m128i result[2];
+				for (uint32_t half = 0u; half < 2u; half++) {
+					__m128i row0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pRow0 + x * 2u + half * 16u));
+					__m128i row1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pRow1 + x * 2u + half * 16u));
+					__m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(row0, lowBytes), _mm_srli_epi16(row0, 8)),
+						_mm_add_epi16(_mm_and_si128(row1, lowBytes), _mm_srli_epi16(row1, 8)));
+					result[half] = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + x), _mm_packus_epi16(result[0], result[1]));
+			}
+		}
+#elif defined(EEIMAGE_NEON)
+		if (channels == 4u) {
+			// Eight destination pixels per step, the loads split the pixels into their channels
+			for (; x + 8u <= dstWidth; x += 8u) {
+				uint8x16x4_t row0 = vld4q_u8(pRow0 + x * 8u);
+				uint8x16x4_t row1 = vld4q_u8(pRow1 + x * 8u);
+				uint8x8x4_t result;
+				for (int c = 0; c < 4; c++) {
+					result.val[c] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(row0.val[c]), row1.val[c]), 2);
+				}
+				vst4_u8(pDst + x * 4u, result);
+			}
+		} else if (channels == 1u) {
+			for (; x + 8u <= dstWidth; x += 8u) {
+				uint16x8_t sum = vpadalq_u8(vpaddlq_u8(vld1q_u8(pRow0 + x * 2u)), vld1q_u8(pRow1 + x * 2u));
+				vst1_u8(pDst + x, vrshrn_n_u16(sum, 2));
+			}
+		}
+#else
+		(void)pRow0; (void)pRow1; (void)pDst; (void)dstWidth; (void)channels;
+#endif
+		return x;
+	}
+
+	void DownsampleRows(DownsampleJob const* pJob)
+	{
+		size_t srcStride = size_t(pJob->srcWidth) * pJob->channels;
+		size_t dstStride = size_t(pJob->dstWidth) * pJob->channels;
+
+		for (uint32_t y = pJob->rowBegin; y < pJob->rowEnd; y++) {
+			// Levels of height/width 1 average the single row/column with itself
+			unsigned char const* pRow0 = pJob->pSrc + size_t(y) * 2u * srcStride;
+			unsigned char const* pRow1 = (pJob->srcHeight > 1u) ? pRow0 + srcStride : pRow0;
+			unsigned char* pDst = pJob->pDst + size_t(y) * dstStride;
+
+			uint32_t x = (pJob->srcWidth > 1u) ? DownsampleRowSimd(pRow0, pRow1, pDst, pJob->dstWidth, pJob->channels) : 0u;
+			for (; x < pJob->dstWidth; x++) {
+				size_t left = size_t(x) * 2u * pJob->channels;
+				size_t right = (pJob->srcWidth > 1u) ? left + pJob->channels : left;
+				for (uint32_t c = 0u; c < pJob->channels; c++) {
+					uint32_t sum = uint32_t(pRow0[left + c]) + pRow0[right + c] + pRow1[left + c] + pRow1[right + c];
+					pDst[size_t(x) * pJob->channels + c] = (unsigned char)((sum + 2u) >> 2u);
+				}
+			}
+		}
+	}
+}
+
+
+uint32_t EE::tools::mipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t amountLevels = 1u;
+	while ((std::max(width, height) >> amountLevels) > 0u) amountLevels++;
+	return amountLevels;
+}
+
+size_t EE::tools::mipChainLayout(uint32_t width, uint32_t height, uint32_t channels, uint32_t amountLevels, std::vector<ImageLevel>& levelsOut)
+{
+	levelsOut.resize(amountLevels);
+	size_t chainSize = 0u;
+	for (uint32_t i = 0u; i < amountLevels; i++) {
+		levelsOut[i].width = std::max(1u, width >> i);
+		levelsOut[i].height = std::max(1u, height >> i);
+		levelsOut[i].offset = chainSize;
+		levelsOut[i].size = size_t(levelsOut[i].width) * levelsOut[i].height * channels;
+		chainSize += levelsOut[i].size;
+	}
+	return chainSize;
+}
+
+void EE::tools::generateMipChain(unsigned char* pChain, uint32_t channels, std::vector<ImageLevel> const& levels, bool parallel)
+{
+	EE_PROFILE_SCOPE("tools::generateMipChain");
+
+	// Every level is filtered from the previous one, so only the rows of a level are split
+	for (size_t i = 1u; i < levels.size(); i++) {
+		ImageLevel const& src = levels[i - 1u];
+		ImageLevel const& dst = levels[i];
+
+		DownsampleJob level{ pChain + src.offset, pChain + dst.offset, src.width, src.height, dst.width, channels, 0u, dst.height };
+		if (!parallel || size_t(dst.width) * dst.height < 2u * MIN_PIXELS_PER_JOB) {
+			DownsampleRows(&level);
+			continue;
+		}
+
+		// Jobs of whole rows, at least MIN_PIXELS_PER_JOB pixels each
+		uint32_t rowsPerJob = std::max(1u, MIN_PIXELS_PER_JOB / dst.width);
+		uint32_t amountJobs = (dst.height + rowsPerJob - 1u) / rowsPerJob;
+		CORETOOLS::JobSystem::Shared().ParallelFor(amountJobs, 1u, [&level, rowsPerJob](uint32_t j) {
+			DownsampleJob job = level;
+			job.rowBegin = j * rowsPerJob;
+			job.rowEnd = std::min(level.rowEnd, job.rowBegin + rowsPerJob);
+			DownsampleRows(&job);
+		});
+	}
+}
@@ -0,0 +1,52 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eeimage.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace EE {
+	namespace tools {
+
+		/* @brief Position and dimension of one level within a mip chain */
+		struct ImageLevel {
+			size_t offset;
+			size_t size;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		/* @brief Returns the amount of levels of a full mip chain down to 1x1 */
+		extern uint32_t mipLevelCount(uint32_t width, uint32_t height);
+
+		/**
+		 * Computes where the levels of a mip chain lie when they are stored tightly behind each other
+		 *
+		 * @param width				Width of the base level
+		 * @param height			Height of the base level
+		 * @param channels		Amount of 8 bit channels per pixel
+		 * @param amountLevels	Amount of levels including the base level
+		 * @param levelsOut		Will hold the offset and size of every level
+		 *
+		 * @return Size of the whole chain in bytes
+		 **/
+		extern size_t mipChainLayout(uint32_t width, uint32_t height, uint32_t channels, uint32_t amountLevels, std::vector<ImageLevel>& levelsOut);
+
+		/**
+		 * Builds every level after the base level of the chain with a 2x2 box filter. Rows with 1 or
+		 * 4 channels are filtered with SSE2 or NEON, the rows of big levels are split into jobs of
+		 * the shared CORETOOLS::JobSystem.
+		 * Odd widths/heights drop their last column/row, like a box filter halving the level.
+		 *
+		 * @param pChain			Chain laid out like mipChainLayout returns, the base level filled in
+		 * @param channels		Amount of 8 bit unsigned normalized channels per pixel
+		 * @param levels			The layout of the chain
+		 * @param parallel		Set to false to build the chain on the calling thread only
+		 **/
+		extern void generateMipChain(unsigned char* pChain, uint32_t channels, std::vector<ImageLevel> const& levels, bool parallel = true);
+	}
+}
@@ -0,0 +1,618 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eemeshloader.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "eemeshloader.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "eeprofiler.h"
+#include "coretools/JobSystem.h"
+
+/* @brief Smaller files are split into less chunks, a job isn't worth a few lines */
+#define MIN_BYTES_PER_CHUNK (size_t(1u) << 20u)
+
+/* @brief Marks a corner attribute that is not part of the face (e.g. f 1//1 has no uv) */
+#define NO_INDEX INT32_MIN
+
+/* @brief Alignment of the blobs within a mesh file */
+#define MESH_FILE_ALIGNMENT 16u
+
+
+namespace {
+
+	/**
+	 * One corner of a triangle, the attributes are in the order position, uv, normal.
+	 * Negative obj indices are relative to the attributes read so far, but a chunk doesn't know
+	 * how many attributes the chunks in front of it read. Those are stored relative to the begin
+	 * of the chunk and flagged in the relative mask, the merge adds the offset of the chunk.
+	 **/
+	struct ObjCorner {
+		int32_t indices[3];
+		uint32_t relativeMask;
+	};
+
+	/* @brief Everything read out of one part of the file */
+	struct ObjChunk {
+		char const* pBegin;
+		char const* pEnd;
+		std::vector<float> positions;		//< 3 floats per position
+		std::vector<float> colors;			//< 3 floats per position, white if the file has none
+		std::vector<float> uvCoords;		//< 2 floats per uv
+		std::vector<float> normals;			//< 3 floats per normal
+		std::vector<ObjCorner> corners;	//< 3 corners per triangle
+	};
+
+	/* @brief Final attribute indices of a vertex, the key of the deduplication */
+	struct VertexKey {
+		uint32_t indices[3];
+
+		bool operator==(VertexKey const& other) const
+		{
+			return indices[0] == other.indices[0] && indices[1] == other.indices[1] && indices[2] == other.indices[2];
+		}
+	};
+
+	struct VertexKeyHash {
+		size_t operator()(VertexKey const& key) const
+		{
+			return size_t(EE::tools::hashData(key.indices, sizeof(key.indices)));
+		}
+	};
+
+	inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+	inline bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+	inline bool IsNumberBegin(char c) { return IsDigit(c) || c == '-' || c == '+' || c == '.'; }
+
+	inline char const* SkipSpaces(char const* p, char const* pEnd)
+	{
+		while (p < pEnd && IsSpace(*p)) p++;
+		return p;
+	}
+
+	/* @brief Returns 10^exponent, exact for the exponents a double can represent exactly */
+	inline double PowerOfTen(int32_t exponent)
+	{
+		static double const powers[] = {
+			1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		if (exponent <= 22) return powers[exponent];
+
+		double value = powers[22];
+		for (exponent -= 22; exponent > 0 && value < 1e308; exponent--) value *= 10.0;
+		return value;
+	}
+
+	/**
+	 * Parses a decimal float ([+-]digits[.digits][(e|E)[+-]digits]) without locale or strtod.
+	 * The first 19 significant digits are collected in an integer and scaled once at the end.
+	 *
+	 * @return Pointer behind the last character that belongs to the number
+	 **/
+	char const* ParseFloat(char const* p, char const* pEnd, float& valueOut)
+	{
+		bool negative = false;
+		if (p < pEnd && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+		uint64_t mantissa = 0u;
+		int32_t exponent = 0;
+		uint32_t digits = 0u;
+
+		// Integer part, digits that don't fit only scale the number
+		for (; p < pEnd && IsDigit(*p); p++) {
+			if (digits < 19u) {
+				mantissa = mantissa * 10u + uint64_t(*p - '0');
+				if (mantissa) digits++;
+			} else {
+				exponent++;
+			}
+		}
+
+		// Fraction
+		if (p < pEnd && *p == '.') {
+			for (p++; p < pEnd && IsDigit(*p); p++) {
+				if (digits < 19u) {
+					mantissa = mantissa * 10u + uint64_t(*p - '0');
+					if (mantissa) digits++;
+					exponent--;
+				}
+			}
+		}
+
+		// Exponent
+		if (p < pEnd && (*p == 'e' || *p == 'E')) {
+			p++;
+			bool negativeExponent = false;
+			if (p < pEnd && (*p == '-' || *p == '+')) negativeExponent = (*p++ == '-');
+
+			int32_t value = 0;
+			for (; p < pEnd && IsDigit(*p); p++) {
+				if (value < 10000) value = value * 10 + (*p - '0');
+			}
+			exponent += (negativeExponent) ? -value : value;
+		}
+
+		double value = double(mantissa);
+		if (mantissa && exponent) {
+			if (exponent < -400) value = 0.0;
+			else if (exponent < 0) value /= PowerOfTen(-exponent);
+			else value *= PowerOfTen(std::min(exponent, 400));
+		}
+
+		valueOut = float((negative) ? -value : value);
+		return p;
+	}
+
+	/* @brief Parses the floats of one attribute, the ones missing in the line are zero */
+	char const* ParseFloats(char const* p, char const* pEnd, float* pValuesOut, uint32_t amount)
+	{
+		for (uint32_t i = 0u; i < amount; i++) {
+			p = SkipSpaces(p, pEnd);
+			pValuesOut[i] = 0.0f;
+			if (p < pEnd) p = ParseFloat(p, pEnd, pValuesOut[i]);
+		}
+		return p;
+	}
+
+	/* @brief Parses an obj index and returns it resolved (see ObjCorner) */
+	char const* ParseIndex(char const* p, char const* pEnd, size_t amountRead, uint32_t attribute, ObjCorner& corner)
+	{
+		bool negative = false;
+		if (p < pEnd && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+		int64_t value = 0;
+		for (; p < pEnd && IsDigit(*p); p++) {
+			if (value < INT32_MAX) value = value * 10 + (*p - '0');
+		}
+
+		if (value == 0 || value >= INT32_MAX) {
+			corner.indices[attribute] = NO_INDEX;
+		} else if (negative) {
+			// Relative to the attributes of this chunk, may point into a previous chunk
+			corner.indices[attribute] = int32_t(int64_t(amountRead) - value);
+			corner.relativeMask |= (1u << attribute);
+		} else {
+			corner.indices[attribute] = int32_t(value - 1);
+		}
+		return p;
+	}
+
+	/* @brief Parses all lines of the chunk */
+	void ParseObjChunk(ObjChunk* pChunk)
+	{
+		ObjChunk& chunk = *pChunk;
+
+		// Reserve for a typical mix of lines (~30 bytes per line) to avoid most reallocations
+		size_t expectedLines = size_t(chunk.pEnd - chunk.pBegin) / 30u;
+		chunk.positions.reserve(expectedLines * 3u / 2u);
+		chunk.colors.reserve(expectedLines * 3u / 2u);
+		chunk.corners.reserve(expectedLines * 3u);
+
+		char const* p = chunk.pBegin;
+		while (p < chunk.pEnd) {
+			char const* pLineEnd = static_cast<char const*>(memchr(p, '\n', size_t(chunk.pEnd - p)));
+			if (!pLineEnd) pLineEnd = chunk.pEnd;
+
+			p = SkipSpaces(p, pLineEnd);
+			if (pLineEnd - p >= 2 && p[0] == 'v') {
+				if (IsSpace(p[1])) {
+					// Position, three more values are a vertex color (a single one is the unused w)
+					float values[7];
+					p = ParseFloats(p + 1, pLineEnd, values, 3u);
+					chunk.positions.insert(chunk.positions.end(), values, values + 3);
+
+					uint32_t amountExtra = 0u;
+					for (p = SkipSpaces(p, pLineEnd); p < pLineEnd && amountExtra < 4u && IsNumberBegin(*p); p = SkipSpaces(p, pLineEnd)) {
+						p = ParseFloat(p, pLineEnd, values[3u + amountExtra++]);
+					}
+					if (amountExtra != 3u) values[3] = values[4] = values[5] = 1.0f;
+					chunk.colors.insert(chunk.colors.end(), values + 3, values + 6);
+
+				} else if (p[1] == 't' && pLineEnd - p >= 3 && IsSpace(p[2])) {
+					float values[2];
+					ParseFloats(p + 2, pLineEnd, values, 2u);
+					chunk.uvCoords.push_back(values[0]);
+					chunk.uvCoords.push_back(1.0f - values[1]);
+
+				} else if (p[1] == 'n' && pLineEnd - p >= 3 && IsSpace(p[2])) {
+					float values[3];
+					ParseFloats(p + 2, pLineEnd, values, 3u);
+					chunk.normals.insert(chunk.normals.end(), values, values + 3);
+				}
+
+			} else if (pLineEnd - p >= 2 && p[0] == 'f' && IsSpace(p[1])) {
+				// Triangulate the polygon as a fan around its first corner
+				ObjCorner first, previous;
+				uint32_t amountCorners = 0u;
+
+				for (p++;;) {
+					p = SkipSpaces(p, pLineEnd);
+					if (p >= pLineEnd || !(IsDigit(*p) || *p == '-' || *p == '+')) break;
+
+					ObjCorner corner{ { NO_INDEX, NO_INDEX, NO_INDEX }, 0u };
+					p = ParseIndex(p, pLineEnd, chunk.positions.size() / 3u, 0u, corner);
+					if (p < pLineEnd && *p == '/') {
+						p++;
+						if (p < pLineEnd && *p != '/') p = ParseIndex(p, pLineEnd, chunk.uvCoords.size() / 2u, 1u, corner);
+						if (p < pLineEnd && *p == '/') p = ParseIndex(p + 1, pLineEnd, chunk.normals.size() / 3u, 2u, corner);
+					}
+					// Skip whatever is left of a malformed corner
+					while (p < pLineEnd && !IsSpace(*p)) p++;
+
+					if (amountCorners == 0u) {
+						first = corner;
+					} else if (amountCorners >= 2u) {
+						chunk.corners.push_back(first);
+						chunk.corners.push_back(previous);
+						chunk.corners.push_back(corner);
+					}
+					previous = corner;
+					amountCorners++;
+				}
+			}
+
+			p = pLineEnd + 1;
+		}
+	}
+
+	/* @brief Where the position (location 0, float2 or float3) is within a vertex, no components if there is none */
+	struct PositionInput {
+		uint32_t offset{ 0u };
+		uint32_t components{ 0u };
+	};
+
+	PositionInput FindPositionInput(EEVertexInput const& vertexInput)
+	{
+		PositionInput positionInput;
+		for (uint32_t i = 0u; i < vertexInput.amountInputs; i++) {
+			EEShaderInputDesc const& input = vertexInput.pInputDescs[i];
+			if (input.location != 0u) continue;
+
+			if (input.format == EE_FORMAT_R32G32_SFLOAT || input.format == EE_FORMAT_R32G32B32_SFLOAT) {
+				positionInput.offset = input.offset;
+				positionInput.components = (input.format == EE_FORMAT_R32G32_SFLOAT) ? 2u : 3u;
+			}
+		}
+		return positionInput;
+	}
+
+	/* @brief Extends the bounds by the position of the vertex passed in */
+	void ExtendBounds(void const* pVertices, uint32_t stride, PositionInput const& positionInput, size_t vertex,
+										float* pMin, float* pMax)
+	{
+		float position[3] = { 0.0f, 0.0f, 0.0f };
+		memcpy(position, static_cast<unsigned char const*>(pVertices) + vertex * stride + positionInput.offset,
+					 sizeof(float) * positionInput.components);
+
+		for (uint32_t i = 0u; i < 3u; i++) {
+			pMin[i] = std::min(pMin[i], position[i]);
+			pMax[i] = std::max(pMax[i], position[i]);
+		}
+	}
+
+	inline uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + MESH_FILE_ALIGNMENT - 1u) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+	}
+}
+
+
+EEVertexInput const& EE::tools::predefinedVertexInput()
+{
+	static EEShaderInputDesc const inputDescs[] = {
+		{ 0u, EE_FORMAT_R32G32B32_SFLOAT, uint32_t(offsetof(EEPredefinedVertex, position)) },
+		{ 1u, EE_FORMAT_R32G32B32_SFLOAT, uint32_t(offsetof(EEPredefinedVertex, color)) },
+		{ 2u, EE_FORMAT_R32G32_SFLOAT,		uint32_t(offsetof(EEPredefinedVertex, uvCoord)) },
+		{ 3u, EE_FORMAT_R32G32B32_SFLOAT, uint32_t(offsetof(EEPredefinedVertex, normal)) }
+	};
+	static EEVertexInput const vertexInput = { 4u, inputDescs, uint32_t(sizeof(EEPredefinedVertex)) };
+	return vertexInput;
+}
+
+
+bool EE::tools::loadObj(char const* fileName, std::vector<EEPredefinedVertex>& verticesOut, std::vector<uint32_t>& indicesOut)
+{
+	EE_PROFILE_SCOPE("tools::loadObj");
+
+	verticesOut.clear();
+	indicesOut.clear();
+
+	MappedFile file;
+	if (!mapFile(fileName, file)) {
+		EE_PRINTA("[EETOOLS] Failed to map obj file %s!\n", fileName);
+		return false;
+	}
+	char const* pData = static_cast<char const*>(file.pData);
+
+	// Split the file into one chunk per thread of the job system, every chunk ends behind a line end
+	CORETOOLS::JobSystem& jobSystem = CORETOOLS::JobSystem::Shared();
+	size_t amountChunks = std::max(size_t(1u), std::min(size_t(jobSystem.GetAmountThreads()), file.size / MIN_BYTES_PER_CHUNK));
+	std::vector<ObjChunk> chunks(amountChunks);
+	char const* pChunkBegin = pData;
+	for (size_t i = 0u; i < amountChunks; i++) {
+		char const* pChunkEnd = pData + file.size;
+		if (i + 1u < amountChunks) {
+			pChunkEnd = std::max(pChunkBegin, pData + file.size * (i + 1u) / amountChunks);
+			char const* pLineEnd = static_cast<char const*>(memchr(pChunkEnd, '\n', size_t(pData + file.size - pChunkEnd)));
+			pChunkEnd = (pLineEnd) ? pLineEnd + 1 : pData + file.size;
+		}
+		chunks[i].pBegin = pChunkBegin;
+		chunks[i].pEnd = pChunkEnd;
+		pChunkBegin = pChunkEnd;
+	}
+
+	{
+		EE_PROFILE_SCOPE("tools::loadObj::Parse");
+		jobSystem.ParallelFor(uint32_t(chunks.size()), 1u, [&chunks](uint32_t i) { ParseObjChunk(&chunks[i]); });
+	}
+
+	unmapFile(file);
+
+	// Offsets of every chunk's attributes within the whole file
+	std::vector<size_t> attributeOffsets(chunks.size() * 3u);
+	size_t amountAttributes[3] = { 0u, 0u, 0u };
+	size_t amountCorners = 0u;
+	for (size_t i = 0u; i < chunks.size(); i++) {
+		attributeOffsets[i * 3u + 0u] = amountAttributes[0];
+		attributeOffsets[i * 3u + 1u] = amountAttributes[1];
+		attributeOffsets[i * 3u + 2u] = amountAttributes[2];
+		amountAttributes[0] += chunks[i].positions.size() / 3u;
+		amountAttributes[1] += chunks[i].uvCoords.size() / 2u;
+		amountAttributes[2] += chunks[i].normals.size() / 3u;
+		amountCorners += chunks[i].corners.size();
+	}
+
+	// Merge the attributes, corners may reference attributes of any chunk
+	std::vector<float> positions, colors, uvCoords, normals;
+	positions.reserve(amountAttributes[0] * 3u);
+	colors.reserve(amountAttributes[0] * 3u);
+	uvCoords.reserve(amountAttributes[1] * 2u);
+	normals.reserve(amountAttributes[2] * 3u);
+	for (size_t i = 0u; i < chunks.size(); i++) {
+		positions.insert(positions.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+		colors.insert(colors.end(), chunks[i].colors.begin(), chunks[i].colors.end());
+		uvCoords.insert(uvCoords.end(), chunks[i].uvCoords.begin(), chunks[i].uvCoords.end());
+		normals.insert(normals.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+		std::vector<float>().swap(chunks[i].positions);
+		std::vector<float>().swap(chunks[i].colors);
+		std::vector<float>().swap(chunks[i].uvCoords);
+		std::vector<float>().swap(chunks[i].normals);
+	}
+
+	// Create one vertex per distinct attribute combination
+	EE_PROFILE_SCOPE("tools::loadObj::Deduplicate");
+	std::unordered_map<VertexKey, uint32_t, VertexKeyHash> vertexIndices;
+	vertexIndices.reserve(amountAttributes[0] + amountAttributes[0] / 2u);
+	verticesOut.reserve(amountAttributes[0]);
+	indicesOut.reserve(amountCorners);
+
+	for (size_t i = 0u; i < chunks.size(); i++) {
+		for (ObjCorner const& corner : chunks[i].corners) {
+			VertexKey key;
+			for (uint32_t a = 0u; a < 3u; a++) {
+				int64_t index = corner.indices[a];
+				if (index == NO_INDEX) {
+					key.indices[a] = UINT32_MAX;
+					continue;
+				}
+				if (corner.relativeMask & (1u << a)) index += int64_t(attributeOffsets[i * 3u + a]);
+
+				if (index < 0 || size_t(index) >= amountAttributes[a]) {
+					EE_PRINTA("[EETOOLS] Obj file %s references a vertex attribute that doesn't exist!\n", fileName);
+					verticesOut.clear();
+					indicesOut.clear();
+					return false;
+				}
+				key.indices[a] = uint32_t(index);
+			}
+			if (key.indices[0] == UINT32_MAX) {
+				EE_PRINTA("[EETOOLS] Obj file %s has a face corner without a position!\n", fileName);
+				verticesOut.clear();
+				indicesOut.clear();
+				return false;
+			}
+
+			auto result = vertexIndices.emplace(key, uint32_t(verticesOut.size()));
+			if (result.second) {
+				EEPredefinedVertex vertex;
+				float const* pPosition = &positions[size_t(key.indices[0]) * 3u];
+				float const* pColor = &colors[size_t(key.indices[0]) * 3u];
+				vertex.position = glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+				vertex.color = glm::vec3(pColor[0], pColor[1], pColor[2]);
+				vertex.uvCoord = glm::vec2(0.0f);
+				vertex.normal = glm::vec3(0.0f);
+				if (key.indices[1] != UINT32_MAX) {
+					float const* pUv = &uvCoords[size_t(key.indices[1]) * 2u];
+					vertex.uvCoord = glm::vec2(pUv[0], pUv[1]);
+				}
+				if (key.indices[2] != UINT32_MAX) {
+					float const* pNormal = &normals[size_t(key.indices[2]) * 3u];
+					vertex.normal = glm::vec3(pNormal[0], pNormal[1], pNormal[2]);
+				}
+				verticesOut.push_back(vertex);
+			}
+			indicesOut.push_back(result.first->second);
+		}
+	}
+
+	return true;
+}
+
+void EE::tools::buildMeshlets(EEVertexInput const& vertexInput, void const* pVertices, size_t amountVertices,
+															std::vector<uint32_t> const& indices, uint32_t maxVertices, uint32_t maxTriangles,
+															std::vector<MeshFileMeshlet>& meshletsOut)
+{
+	meshletsOut.clear();
+	PositionInput positionInput = FindPositionInput(vertexInput);
+
+	// The meshlet a vertex was last counted in, so every vertex is counted once per meshlet
+	std::vector<uint32_t> vertexMeshlet(amountVertices, UINT32_MAX);
+	uint32_t amountMeshletVertices = 0u;
+
+	for (size_t i = 0u; i + 2u < indices.size(); i += 3u) {
+		uint32_t meshlet = uint32_t(meshletsOut.size()) - 1u;
+
+		uint32_t amountNew = 0u;
+		if (!meshletsOut.empty()) {
+			for (size_t c = 0u; c < 3u; c++) {
+				if (vertexMeshlet[indices[i + c]] != meshlet) amountNew++;
+			}
+		}
+
+		// Start a new meshlet if the triangle doesn't fit anymore
+		if (meshletsOut.empty() || amountMeshletVertices + amountNew > maxVertices
+				|| meshletsOut.back().amountIndices / 3u + 1u > maxTriangles) {
+			MeshFileMeshlet newMeshlet;
+			newMeshlet.firstIndex = uint32_t(i);
+			newMeshlet.amountIndices = 0u;
+			for (uint32_t a = 0u; a < 3u; a++) {
+				newMeshlet.boundsMin[a] = FLT_MAX;
+				newMeshlet.boundsMax[a] = -FLT_MAX;
+			}
+			meshletsOut.push_back(newMeshlet);
+			meshlet = uint32_t(meshletsOut.size()) - 1u;
+			amountMeshletVertices = 0u;
+		}
+
+		MeshFileMeshlet& current = meshletsOut.back();
+		for (size_t c = 0u; c < 3u; c++) {
+			uint32_t vertex = indices[i + c];
+			if (vertexMeshlet[vertex] == meshlet) continue;
+			vertexMeshlet[vertex] = meshlet;
+			amountMeshletVertices++;
+
+			if (positionInput.components) {
+				ExtendBounds(pVertices, vertexInput.inputStride, positionInput, vertex, current.boundsMin, current.boundsMax);
+			}
+		}
+		current.amountIndices += 3u;
+	}
+}
+
+bool EE::tools::writeMeshFile(char const* fileName, EEVertexInput const& vertexInput, void const* pVertices, size_t amountVertices,
+															std::vector<uint32_t> const& indices, std::vector<MeshFileMeshlet> const& meshlets)
+{
+	MeshFileHeader header;
+	header.magic = EE_MESH_FILE_MAGIC;
+	header.version = EE_MESH_FILE_VERSION;
+	header.vertexStride = vertexInput.inputStride;
+	header.amountInputs = vertexInput.amountInputs;
+	header.indexSize = uint32_t((amountVertices <= size_t(UINT16_MAX) + 1u) ? sizeof(uint16_t) : sizeof(uint32_t));
+	header.amountMeshlets = uint32_t(meshlets.size());
+	header.amountVertices = amountVertices;
+	header.amountIndices = indices.size();
+
+	// Blobs are placed behind each other, each one aligned
+	header.vertexDataOffset = AlignOffset(sizeof(MeshFileHeader) + sizeof(MeshFileInput) * header.amountInputs);
+	header.indexDataOffset = AlignOffset(header.vertexDataOffset + uint64_t(header.vertexStride) * amountVertices);
+	header.meshletOffset = AlignOffset(header.indexDataOffset + uint64_t(header.indexSize) * header.amountIndices);
+
+	// Bounds of all positions
+	for (uint32_t a = 0u; a < 3u; a++) {
+		header.boundsMin[a] = FLT_MAX;
+		header.boundsMax[a] = -FLT_MAX;
+	}
+	PositionInput positionInput = FindPositionInput(vertexInput);
+	if (positionInput.components) {
+		for (size_t i = 0u; i < amountVertices; i++) {
+			ExtendBounds(pVertices, vertexInput.inputStride, positionInput, i, header.boundsMin, header.boundsMax);
+		}
+	}
+
+	std::vector<MeshFileInput> inputs(header.amountInputs);
+	for (uint32_t i = 0u; i < header.amountInputs; i++) {
+		inputs[i].location = vertexInput.pInputDescs[i].location;
+		inputs[i].format = uint32_t(vertexInput.pInputDescs[i].format);
+		inputs[i].offset = vertexInput.pInputDescs[i].offset;
+	}
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		EE_PRINTA("[EETOOLS] Failed to open mesh file %s for writing!\n", fileName);
+		return false;
+	}
+
+	char const padding[MESH_FILE_ALIGNMENT] = {};
+	auto writePadding = [&](uint64_t offset) {
+		uint64_t position = uint64_t(file.tellp());
+		file.write(padding, std::streamsize(offset - position));
+	};
+
+	file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	file.write(reinterpret_cast<char const*>(inputs.data()), std::streamsize(sizeof(MeshFileInput) * inputs.size()));
+	writePadding(header.vertexDataOffset);
+	file.write(static_cast<char const*>(pVertices), std::streamsize(uint64_t(header.vertexStride) * amountVertices));
+	writePadding(header.indexDataOffset);
+	if (header.indexSize == sizeof(uint16_t)) {
+		std::vector<uint16_t> packedIndices(indices.begin(), indices.end());
+		file.write(reinterpret_cast<char const*>(packedIndices.data()), std::streamsize(sizeof(uint16_t) * packedIndices.size()));
+	} else {
+		file.write(reinterpret_cast<char const*>(indices.data()), std::streamsize(sizeof(uint32_t) * indices.size()));
+	}
+	writePadding(header.meshletOffset);
+	file.write(reinterpret_cast<char const*>(meshlets.data()), std::streamsize(sizeof(MeshFileMeshlet) * meshlets.size()));
+
+	if (!file.good()) {
+		EE_PRINTA("[EETOOLS] Failed to write mesh file %s!\n", fileName);
+		return false;
+	}
+	return true;
+}
+
+bool EE::tools::openMeshFile(char const* fileName, MeshFile& meshFileOut)
+{
+	meshFileOut = MeshFile();
+
+	MappedFile file;
+	if (!mapFile(fileName, file)) {
+		EE_PRINTA("[EETOOLS] Failed to map mesh file %s!\n", fileName);
+		return false;
+	}
+	unsigned char const* pData = static_cast<unsigned char const*>(file.pData);
+	MeshFileHeader const* pHeader = reinterpret_cast<MeshFileHeader const*>(pData);
+
+	// Every blob needs to be within the file, sizes are checked by division so they can't overflow
+	bool isValid = file.size >= sizeof(MeshFileHeader)
+		&& pHeader->magic == EE_MESH_FILE_MAGIC
+		&& pHeader->version == EE_MESH_FILE_VERSION
+		&& (pHeader->indexSize == sizeof(uint16_t) || pHeader->indexSize == sizeof(uint32_t))
+		&& pHeader->vertexStride > 0u
+		&& pHeader->amountInputs <= (file.size - sizeof(MeshFileHeader)) / sizeof(MeshFileInput)
+		&& pHeader->vertexDataOffset >= sizeof(MeshFileHeader) + sizeof(MeshFileInput) * uint64_t(pHeader->amountInputs)
+		&& pHeader->vertexDataOffset % MESH_FILE_ALIGNMENT == 0u && pHeader->vertexDataOffset <= file.size
+		&& pHeader->indexDataOffset % MESH_FILE_ALIGNMENT == 0u && pHeader->indexDataOffset <= file.size
+		&& pHeader->meshletOffset % MESH_FILE_ALIGNMENT == 0u && pHeader->meshletOffset <= file.size;
+	isValid = isValid
+		&& pHeader->amountVertices <= (file.size - pHeader->vertexDataOffset) / pHeader->vertexStride
+		&& pHeader->amountIndices <= (file.size - pHeader->indexDataOffset) / pHeader->indexSize
+		&& pHeader->amountIndices <= UINT32_MAX
+		&& pHeader->amountMeshlets <= (file.size - pHeader->meshletOffset) / sizeof(MeshFileMeshlet);
+
+	if (!isValid) {
+		EE_PRINTA("[EETOOLS] %s is no valid mesh file of version %u!\n", fileName, EE_MESH_FILE_VERSION);
+		unmapFile(file);
+		return false;
+	}
+
+	meshFileOut.file = file;
+	meshFileOut.pHeader = pHeader;
+	meshFileOut.pInputs = reinterpret_cast<MeshFileInput const*>(pData + sizeof(MeshFileHeader));
+	meshFileOut.pVertices = pData + pHeader->vertexDataOffset;
+	meshFileOut.pIndices = pData + pHeader->indexDataOffset;
+	meshFileOut.pMeshlets = reinterpret_cast<MeshFileMeshlet const*>(pData + pHeader->meshletOffset);
+	return true;
+}
+
+void EE::tools::closeMeshFile(MeshFile& meshFile)
+{
+	unmapFile(meshFile.file);
+	meshFile = MeshFile();
+}
@@ -0,0 +1,131 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eemeshloader.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+
+#include "eedefs.h"
+#include "eehelper.h"
+
+/* @brief Identifies a binary mesh file ("EEMF"), the version is increased on every change of the layout */
+#define EE_MESH_FILE_MAGIC 0x464D4545u
+#define EE_MESH_FILE_VERSION 1u
+
+namespace EE {
+	namespace tools {
+
+		/**
+		 * Header at the begin of a binary mesh file. It is followed by the vertex layout (amountInputs
+		 * MeshFileInputs), the blobs are placed at the offsets and are aligned to 16 bytes, so a mapped
+		 * file can be read in place and the vertex data copied straight into staging memory.
+		 **/
+		struct MeshFileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vertexStride;
+			uint32_t amountInputs;
+			uint32_t indexSize;					//< Size of one index in bytes, 2 if all indices fit into 16 bit
+			uint32_t amountMeshlets;
+			uint64_t amountVertices;
+			uint64_t amountIndices;
+			uint64_t vertexDataOffset;	//< Offsets are relative to the begin of the file
+			uint64_t indexDataOffset;
+			uint64_t meshletOffset;
+			float boundsMin[3];					//< Bounds of the positions, min > max if there is no position
+			float boundsMax[3];
+		};
+
+		/* @brief One attribute of the vertex layout, matches EEShaderInputDesc with fixed sized members */
+		struct MeshFileInput {
+			uint32_t location;
+			uint32_t format;
+			uint32_t offset;
+		};
+
+		/* @brief A range of the indices of spatially close triangles with its bounds, e.g. for cluster culling */
+		struct MeshFileMeshlet {
+			uint32_t firstIndex;
+			uint32_t amountIndices;
+			float boundsMin[3];
+			float boundsMax[3];
+		};
+
+		/* @brief A mesh file mapped into memory, all pointers point into the mapping */
+		struct MeshFile {
+			MappedFile file;
+			MeshFileHeader const* pHeader{ nullptr };
+			MeshFileInput const* pInputs{ nullptr };
+			void const* pVertices{ nullptr };
+			void const* pIndices{ nullptr };		//< uint16_t or uint32_t depending on the index size
+			MeshFileMeshlet const* pMeshlets{ nullptr };
+		};
+
+		/* @brief Returns the vertex input of EEPredefinedVertex (the vertices of loaded obj files) */
+		extern EEVertexInput const& predefinedVertexInput();
+
+		/**
+		 * Loads a wavefront obj file into predefined vertices. The file is mapped into memory and
+		 * split at line ends into one chunk per thread, every chunk is parsed by a job of the shared
+		 * CORETOOLS::JobSystem and the results are merged afterwards. Polygons are triangulated as fans and every distinct
+		 * position/uv/normal combination becomes exactly one vertex.
+		 *
+		 * Vertex colors (v x y z r g b) are read if present, otherwise the color is white.
+		 * Missing uvs and normals are zero, the v coordinate is flipped to match vulkan.
+		 * Everything apart from v, vt, vn and f (materials, groups, lines...) is ignored.
+		 *
+		 * @param fileName			Destination of the obj file
+		 * @param verticesOut		Will hold the deduplicated vertices
+		 * @param indicesOut		Will hold three indices per triangle
+		 *
+		 * @return False if the file could not be read or references vertices that don't exist
+		 **/
+		extern bool loadObj(char const* fileName, std::vector<EEPredefinedVertex>& verticesOut, std::vector<uint32_t>& indicesOut);
+
+		/**
+		 * Splits the triangles into meshlets in the order of the indices. A meshlet is closed once the
+		 * next triangle would exceed one of the limits, so the index order should already be local.
+		 *
+		 * @param vertexInput		Layout of the vertices, the position (location 0) is used for the bounds
+		 * @param pVertices			Pointer to the vertices
+		 * @param amountVertices	Amount of vertices
+		 * @param indices				Three indices per triangle
+		 * @param maxVertices		Maximum amount of distinct vertices per meshlet
+		 * @param maxTriangles	Maximum amount of triangles per meshlet
+		 * @param meshletsOut		Will hold the meshlets
+		 **/
+		extern void buildMeshlets(EEVertexInput const& vertexInput, void const* pVertices, size_t amountVertices,
+															std::vector<uint32_t> const& indices, uint32_t maxVertices, uint32_t maxTriangles,
+															std::vector<MeshFileMeshlet>& meshletsOut);
+
+		/**
+		 * Writes a binary mesh file that can be loaded with openMeshFile. The indices are stored with
+		 * 16 bit if there are less than 65536 vertices.
+		 *
+		 * @param fileName			Destination of the mesh file
+		 * @param vertexInput		Layout of the vertices
+		 * @param pVertices			Pointer to the vertices
+		 * @param amountVertices	Amount of vertices
+		 * @param indices				Three indices per triangle
+		 * @param meshlets			Meshlets of the indices (can be empty)
+		 *
+		 * @return False if the file couldn't be written
+		 **/
+		extern bool writeMeshFile(char const* fileName, EEVertexInput const& vertexInput, void const* pVertices, size_t amountVertices,
+															std::vector<uint32_t> const& indices, std::vector<MeshFileMeshlet> const& meshlets);
+
+		/**
+		 * Maps a binary mesh file into memory and validates its header and ranges
+		 *
+		 * @param fileName			Destination of the mesh file
+		 * @param meshFileOut		Will hold the pointers into the file (must be released with closeMeshFile)
+		 *
+		 * @return False if the file doesn't exist or isn't a valid mesh file of this version
+		 **/
+		extern bool openMeshFile(char const* fileName, MeshFile& meshFileOut);
+		extern void closeMeshFile(MeshFile& meshFile);
+
+	}
+}
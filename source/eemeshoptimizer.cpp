@@ -0,0 +1,395 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eemeshoptimizer.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "eemeshoptimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "eeprofiler.h"
+
+/* @brief Parameters of the vertex score, as proposed by Tom Forsyth */
+#define FORSYTH_CACHE_SIZE 32u
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+/* @brief Amount of valences the boost is precomputed for, higher ones are computed on demand */
+#define FORSYTH_VALENCE_TABLE_SIZE 64u
+
+/* @brief Cache size the clusters of the overdraw optimization are measured with */
+#define OVERDRAW_CACHE_SIZE 16u
+
+
+namespace {
+
+	/**
+	 * FIFO cache of vertex indices. Every miss advances the time, a vertex is cached as long as less
+	 * than cacheSize misses happened since it was inserted.
+	 **/
+	struct FifoCache {
+		std::vector<uint32_t> timestamps;
+		uint32_t time;
+		uint32_t cacheSize;
+
+		FifoCache(size_t amountVertices, uint32_t cacheSize)
+			: timestamps(amountVertices, 0u), time(cacheSize + 1u), cacheSize(cacheSize)
+		{}
+
+		/* @brief Returns one if the vertex missed the cache */
+		uint32_t Access(uint32_t vertex)
+		{
+			if (time - timestamps[vertex] > cacheSize) {
+				timestamps[vertex] = time++;
+				return 1u;
+			}
+			return 0u;
+		}
+
+		/* @brief Evicts every vertex */
+		void Reset() { time += cacheSize + 1u; }
+	};
+
+	/* @brief Precomputed parts of the forsyth vertex score */
+	struct ForsythScores {
+		float cachePositions[FORSYTH_CACHE_SIZE];
+		float valences[FORSYTH_VALENCE_TABLE_SIZE];
+
+		ForsythScores()
+		{
+			for (uint32_t i = 0u; i < FORSYTH_CACHE_SIZE; i++) {
+				// The vertices of the last triangle get a fixed score, so a strip isn't preferred over a fan
+				cachePositions[i] = (i < 3u) ? FORSYTH_LAST_TRIANGLE_SCORE
+					: powf(1.0f - float(i - 3u) / float(FORSYTH_CACHE_SIZE - 3u), FORSYTH_CACHE_DECAY_POWER);
+			}
+			valences[0] = 0.0f;
+			for (uint32_t i = 1u; i < FORSYTH_VALENCE_TABLE_SIZE; i++) {
+				valences[i] = FORSYTH_VALENCE_BOOST_SCALE * powf(float(i), -FORSYTH_VALENCE_BOOST_POWER);
+			}
+		}
+
+		float Score(int32_t cachePosition, uint32_t remainingTriangles) const
+		{
+			// Vertices without triangles left will never be used again
+			if (remainingTriangles == 0u) return -1.0f;
+
+			float score = (cachePosition >= 0) ? cachePositions[cachePosition] : 0.0f;
+			return score + ((remainingTriangles < FORSYTH_VALENCE_TABLE_SIZE) ? valences[remainingTriangles]
+				: FORSYTH_VALENCE_BOOST_SCALE * powf(float(remainingTriangles), -FORSYTH_VALENCE_BOOST_POWER));
+		}
+	};
+
+	inline float const* GetPosition(float const* pPositions, size_t positionStride, uint32_t vertex)
+	{
+		return reinterpret_cast<float const*>(reinterpret_cast<unsigned char const*>(pPositions) + vertex * positionStride);
+	}
+}
+
+
+EE::tools::VertexCacheStats EE::tools::analyzeVertexCache(std::vector<uint32_t> const& indices, size_t amountVertices, uint32_t cacheSize)
+{
+	VertexCacheStats stats = { 0u, 0.0f, 0.0f };
+
+	FifoCache cache(amountVertices, cacheSize);
+	std::vector<bool> isReferenced(amountVertices, false);
+	size_t amountReferenced = 0u;
+
+	for (uint32_t index : indices) {
+		stats.misses += cache.Access(index);
+		if (!isReferenced[index]) {
+			isReferenced[index] = true;
+			amountReferenced++;
+		}
+	}
+
+	if (indices.size() >= 3u) stats.acmr = float(stats.misses) / float(indices.size() / 3u);
+	if (amountReferenced) stats.atvr = float(stats.misses) / float(amountReferenced);
+	return stats;
+}
+
+void EE::tools::optimizeVertexCache(std::vector<uint32_t>& indices, size_t amountVertices)
+{
+	EE_PROFILE_SCOPE("tools::optimizeVertexCache");
+
+	size_t amountTriangles = indices.size() / 3u;
+	if (amountTriangles == 0u) return;
+
+	static ForsythScores const scores;
+
+	// Triangles of every vertex, the first remainingTriangles[v] of them are not emitted yet
+	std::vector<uint32_t> triangleOffsets(amountVertices + 1u, 0u);
+	for (size_t i = 0u; i < amountTriangles * 3u; i++) triangleOffsets[indices[i] + 1u]++;
+	for (size_t v = 0u; v < amountVertices; v++) triangleOffsets[v + 1u] += triangleOffsets[v];
+
+	std::vector<uint32_t> remainingTriangles(amountVertices, 0u);
+	std::vector<uint32_t> vertexTriangles(amountTriangles * 3u);
+	for (size_t i = 0u; i < amountTriangles * 3u; i++) {
+		uint32_t vertex = indices[i];
+		vertexTriangles[triangleOffsets[vertex] + remainingTriangles[vertex]++] = uint32_t(i / 3u);
+	}
+
+	std::vector<int32_t> cachePositions(amountVertices, -1);
+	std::vector<float> vertexScores(amountVertices);
+	for (size_t v = 0u; v < amountVertices; v++) vertexScores[v] = scores.Score(-1, remainingTriangles[v]);
+
+	// Start with the best triangle of the whole mesh
+	std::vector<float> triangleScores(amountTriangles);
+	uint32_t bestTriangle = 0u;
+	for (size_t t = 0u; t < amountTriangles; t++) {
+		triangleScores[t] = vertexScores[indices[t * 3u]] + vertexScores[indices[t * 3u + 1u]] + vertexScores[indices[t * 3u + 2u]];
+		if (triangleScores[t] > triangleScores[bestTriangle]) bestTriangle = uint32_t(t);
+	}
+
+	std::vector<bool> isEmitted(amountTriangles, false);
+	std::vector<uint32_t> result;
+	result.reserve(amountTriangles * 3u);
+
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3u];
+	uint32_t cacheCount = 0u;
+	size_t nextTriangle = 0u;
+
+	for (size_t emitted = 0u; emitted < amountTriangles; emitted++) {
+		// No triangle of the cached vertices is left, continue with the next one in the original order
+		if (bestTriangle == UINT32_MAX) {
+			while (isEmitted[nextTriangle]) nextTriangle++;
+			bestTriangle = uint32_t(nextTriangle);
+		}
+
+		uint32_t const* triangle = &indices[size_t(bestTriangle) * 3u];
+		result.insert(result.end(), triangle, triangle + 3);
+		isEmitted[bestTriangle] = true;
+
+		// Remove the triangle from the ones left of its vertices
+		for (uint32_t c = 0u; c < 3u; c++) {
+			uint32_t vertex = triangle[c];
+			uint32_t* pTriangles = &vertexTriangles[triangleOffsets[vertex]];
+			uint32_t last = --remainingTriangles[vertex];
+			for (uint32_t i = 0u; i <= last; i++) {
+				if (pTriangles[i] == bestTriangle) {
+					std::swap(pTriangles[i], pTriangles[last]);
+					break;
+				}
+			}
+		}
+
+		// The vertices of the triangle move to the front of the LRU cache
+		uint32_t newCache[FORSYTH_CACHE_SIZE + 3u];
+		uint32_t newCacheCount = 0u;
+		for (uint32_t c = 0u; c < 3u; c++) {
+			if (std::find(newCache, newCache + newCacheCount, triangle[c]) == newCache + newCacheCount) {
+				newCache[newCacheCount++] = triangle[c];
+			}
+		}
+		for (uint32_t i = 0u; i < cacheCount; i++) {
+			if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2]) newCache[newCacheCount++] = cache[i];
+		}
+
+		// Update the scores of all vertices that moved (evicted ones included) and their triangles
+		for (uint32_t i = 0u; i < newCacheCount; i++) {
+			uint32_t vertex = newCache[i];
+			cachePositions[vertex] = (i < FORSYTH_CACHE_SIZE) ? int32_t(i) : -1;
+
+			float score = scores.Score(cachePositions[vertex], remainingTriangles[vertex]);
+			float delta = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+
+			uint32_t const* pTriangles = &vertexTriangles[triangleOffsets[vertex]];
+			for (uint32_t t = 0u; t < remainingTriangles[vertex]; t++) triangleScores[pTriangles[t]] += delta;
+		}
+
+		cacheCount = std::min(newCacheCount, FORSYTH_CACHE_SIZE);
+		memcpy(cache, newCache, sizeof(uint32_t) * cacheCount);
+
+		// The next triangle is the best one of the cached vertices
+		bestTriangle = UINT32_MAX;
+		float bestScore = -FLT_MAX;
+		for (uint32_t i = 0u; i < cacheCount; i++) {
+			uint32_t const* pTriangles = &vertexTriangles[triangleOffsets[cache[i]]];
+			for (uint32_t t = 0u; t < remainingTriangles[cache[i]]; t++) {
+				if (triangleScores[pTriangles[t]] > bestScore) {
+					bestScore = triangleScores[pTriangles[t]];
+					bestTriangle = pTriangles[t];
+				}
+			}
+		}
+	}
+
+	// Keep the indices of an incomplete last triangle
+	result.insert(result.end(), indices.begin() + amountTriangles * 3u, indices.end());
+	indices.swap(result);
+}
+
+void EE::tools::optimizeOverdraw(std::vector<uint32_t>& indices, float const* pPositions, size_t amountVertices,
+																 size_t positionStride, float threshold)
+{
+	EE_PROFILE_SCOPE("tools::optimizeOverdraw");
+
+	size_t amountTriangles = indices.size() / 3u;
+	if (amountTriangles == 0u) return;
+
+	float targetRatio = analyzeVertexCache(indices, amountVertices, OVERDRAW_CACHE_SIZE).acmr * threshold;
+
+	// Hard boundaries, triangles that miss with all vertices start with a cold cache anyway
+	std::vector<bool> isHardBoundary(amountTriangles + 1u, false);
+	{
+		FifoCache cache(amountVertices, OVERDRAW_CACHE_SIZE);
+		for (size_t t = 0u; t < amountTriangles; t++) {
+			uint32_t misses = cache.Access(indices[t * 3u]) + cache.Access(indices[t * 3u + 1u]) + cache.Access(indices[t * 3u + 2u]);
+			isHardBoundary[t] = (misses == 3u);
+		}
+		isHardBoundary[0] = isHardBoundary[amountTriangles] = true;
+	}
+
+	// Soft boundaries, a cluster also ends once its own miss ratio (starting cold) reached the target
+	std::vector<uint32_t> clusterStarts;
+	{
+		FifoCache cache(amountVertices, OVERDRAW_CACHE_SIZE);
+		uint32_t clusterMisses = 0u, clusterTriangles = 0u;
+		for (size_t t = 0u; t < amountTriangles; t++) {
+			if (isHardBoundary[t]) {
+				clusterStarts.push_back(uint32_t(t));
+				cache.Reset();
+				clusterMisses = clusterTriangles = 0u;
+			}
+
+			clusterMisses += cache.Access(indices[t * 3u]) + cache.Access(indices[t * 3u + 1u]) + cache.Access(indices[t * 3u + 2u]);
+			clusterTriangles++;
+
+			if (!isHardBoundary[t + 1u] && float(clusterMisses) <= targetRatio * float(clusterTriangles)) {
+				clusterStarts.push_back(uint32_t(t + 1u));
+				cache.Reset();
+				clusterMisses = clusterTriangles = 0u;
+			}
+		}
+	}
+	size_t amountClusters = clusterStarts.size();
+	clusterStarts.push_back(uint32_t(amountTriangles));
+
+	// Area weighted centroid and summed normal of every cluster
+	std::vector<float> clusterData(amountClusters * 6u, 0.0f);
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (size_t c = 0u; c < amountClusters; c++) {
+		float* pCentroid = &clusterData[c * 6u];
+		float* pNormal = &clusterData[c * 6u + 3u];
+		float clusterArea = 0.0f;
+
+		for (uint32_t t = clusterStarts[c]; t < clusterStarts[c + 1u]; t++) {
+			float const* p0 = GetPosition(pPositions, positionStride, indices[t * 3u]);
+			float const* p1 = GetPosition(pPositions, positionStride, indices[t * 3u + 1u]);
+			float const* p2 = GetPosition(pPositions, positionStride, indices[t * 3u + 2u]);
+
+			float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float normal[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+			float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+			for (uint32_t a = 0u; a < 3u; a++) {
+				pCentroid[a] += (p0[a] + p1[a] + p2[a]) / 3.0f * area;
+				pNormal[a] += normal[a];
+			}
+			clusterArea += area;
+		}
+
+		for (uint32_t a = 0u; a < 3u; a++) {
+			meshCentroid[a] += pCentroid[a];
+			pCentroid[a] = (clusterArea > 0.0f) ? pCentroid[a] / clusterArea : 0.0f;
+		}
+		meshArea += clusterArea;
+	}
+	for (uint32_t a = 0u; a < 3u; a++) meshCentroid[a] = (meshArea > 0.0f) ? meshCentroid[a] / meshArea : 0.0f;
+
+	// Clusters facing away from the center are the outside of the mesh and get drawn first
+	std::vector<float> sortKeys(amountClusters);
+	std::vector<uint32_t> clusterOrder(amountClusters);
+	for (size_t c = 0u; c < amountClusters; c++) {
+		float const* pCentroid = &clusterData[c * 6u];
+		float const* pNormal = &clusterData[c * 6u + 3u];
+		float length = sqrtf(pNormal[0] * pNormal[0] + pNormal[1] * pNormal[1] + pNormal[2] * pNormal[2]);
+
+		float dot = 0.0f;
+		for (uint32_t a = 0u; a < 3u; a++) dot += (pCentroid[a] - meshCentroid[a]) * pNormal[a];
+		sortKeys[c] = (length > 0.0f) ? dot / length : 0.0f;
+		clusterOrder[c] = uint32_t(c);
+	}
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (uint32_t c : clusterOrder) {
+		result.insert(result.end(), indices.begin() + size_t(clusterStarts[c]) * 3u, indices.begin() + size_t(clusterStarts[c + 1u]) * 3u);
+	}
+	result.insert(result.end(), indices.begin() + amountTriangles * 3u, indices.end());
+	indices.swap(result);
+}
+
+size_t EE::tools::optimizeVertexFetch(std::vector<uint32_t>& indices, void* pVertices, size_t amountVertices, size_t vertexSize)
+{
+	EE_PROFILE_SCOPE("tools::optimizeVertexFetch");
+
+	// New position of every vertex in the order of its first use
+	std::vector<uint32_t> remap(amountVertices, UINT32_MAX);
+	uint32_t amountUsed = 0u;
+	for (uint32_t& index : indices) {
+		if (remap[index] == UINT32_MAX) remap[index] = amountUsed++;
+		index = remap[index];
+	}
+
+	unsigned char* pData = static_cast<unsigned char*>(pVertices);
+	std::vector<unsigned char> vertices(pData, pData + amountVertices * vertexSize);
+	for (size_t v = 0u; v < amountVertices; v++) {
+		if (remap[v] == UINT32_MAX) continue;
+		memcpy(pData + size_t(remap[v]) * vertexSize, &vertices[v * vertexSize], vertexSize);
+	}
+	return amountUsed;
+}
+
+uint16_t EE::tools::quantizeHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16u) & 0x8000u;
+	uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+	// NaN stays NaN, too big values become infinity
+	if (magnitude > 0x7F800000u) return uint16_t(sign | 0x7E00u);
+	if (magnitude >= 0x477FF000u) return uint16_t(sign | 0x7C00u);
+
+	// Too small values become (signed) zero, small ones denormals
+	if (magnitude < 0x33000000u) return uint16_t(sign);
+	if (magnitude < 0x38800000u) {
+		uint32_t shift = 113u - (magnitude >> 23u);
+		uint32_t mantissa = (magnitude & 0x007FFFFFu) | 0x00800000u;
+		uint32_t half = mantissa >> (shift + 13u);
+		uint32_t rest = mantissa & ((1u << (shift + 13u)) - 1u);
+		uint32_t halfway = 1u << (shift + 12u);
+		if (rest > halfway || (rest == halfway && (half & 1u))) half++;
+		return uint16_t(sign | half);
+	}
+
+	// Rebias the exponent and round the mantissa to nearest even
+	uint32_t half = (magnitude - 0x38000000u) >> 13u;
+	uint32_t rest = magnitude & 0x1FFFu;
+	if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) half++;
+	return uint16_t(sign | half);
+}
+
+int32_t EE::tools::quantizeSnorm(float value, uint32_t bits)
+{
+	float scale = float((1 << (bits - 1u)) - 1);
+	value = std::max(-1.0f, std::min(1.0f, value));
+	return int32_t(value * scale + ((value >= 0.0f) ? 0.5f : -0.5f));
+}
+
+uint32_t EE::tools::packA2B10G10R10Snorm(float x, float y, float z, float w)
+{
+	return (uint32_t(quantizeSnorm(x, 10u)) & 0x3FFu)
+		| ((uint32_t(quantizeSnorm(y, 10u)) & 0x3FFu) << 10u)
+		| ((uint32_t(quantizeSnorm(z, 10u)) & 0x3FFu) << 20u)
+		| ((uint32_t(quantizeSnorm(w, 2u)) & 0x3u) << 30u);
+}
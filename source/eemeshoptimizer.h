@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eemeshoptimizer.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace EE {
+	namespace tools {
+
+		/* @brief Result of simulating the post transform vertex cache over the indices */
+		struct VertexCacheStats {
+			uint32_t misses;
+			/* @brief Average cache miss ratio, vertex shader invocations per triangle (0.5 is ideal, 3 is worst) */
+			float acmr;
+			/* @brief Average transformed vertex ratio, invocations per referenced vertex (1 is ideal) */
+			float atvr;
+		};
+
+		/**
+		 * Simulates a FIFO post transform vertex cache while drawing the indices
+		 *
+		 * @param indices				Three indices per triangle
+		 * @param amountVertices	Amount of vertices the indices reference
+		 * @param cacheSize			Amount of vertices the simulated cache holds
+		 **/
+		extern VertexCacheStats analyzeVertexCache(std::vector<uint32_t> const& indices, size_t amountVertices, uint32_t cacheSize = 16u);
+
+		/**
+		 * Reorders the triangles for the post transform vertex cache with Tom Forsyth's linear speed
+		 * algorithm. Every step emits the triangle whose vertices score highest, the score prefers
+		 * recently used vertices and vertices with few triangles left, so no vertex stays alone.
+		 *
+		 * @param indices				Three indices per triangle, reordered in place
+		 * @param amountVertices	Amount of vertices the indices reference
+		 **/
+		extern void optimizeVertexCache(std::vector<uint32_t>& indices, size_t amountVertices);
+
+		/**
+		 * Reorders clusters of the (vertex cache optimized) triangles so the ones facing outwards are
+		 * drawn first and occlude the rest. Clusters end where the cache starts cold anyway or where
+		 * their own miss ratio stays within the threshold of the whole mesh, so the vertex cache
+		 * efficiency drops by the threshold at most (Sander et al. 2007).
+		 *
+		 * @param indices				Three indices per triangle, reordered in place
+		 * @param pPositions		Pointer to the position (three floats) of the first vertex
+		 * @param amountVertices	Amount of vertices
+		 * @param positionStride	Distance in bytes between two positions
+		 * @param threshold			Allowed factor of the miss ratio, e.g. 1.05
+		 **/
+		extern void optimizeOverdraw(std::vector<uint32_t>& indices, float const* pPositions, size_t amountVertices,
+																 size_t positionStride, float threshold);
+
+		/**
+		 * Reorders the vertices in the order the indices first use them, so the vertex fetch reads
+		 * memory linearly. Vertices that aren't referenced are dropped.
+		 *
+		 * @param indices				Three indices per triangle, remapped in place
+		 * @param pVertices			Pointer to the vertices, reordered in place
+		 * @param amountVertices	Amount of vertices
+		 * @param vertexSize		Size of one vertex in bytes
+		 *
+		 * @return The amount of vertices that are left
+		 **/
+		extern size_t optimizeVertexFetch(std::vector<uint32_t>& indices, void* pVertices, size_t amountVertices, size_t vertexSize);
+
+		/* @brief Converts the float to a half float (EE_FORMAT_R16G16_SFLOAT...), rounded to nearest even */
+		extern uint16_t quantizeHalf(float value);
+
+		/**
+		 * Converts the float in [-1, 1] to a signed normalized integer of the amount of bits passed in,
+		 * e.g. 8 for EE_FORMAT_R8G8B8A8_SNORM or 16 for EE_FORMAT_R16G16B16A16_SNORM
+		 **/
+		extern int32_t quantizeSnorm(float value, uint32_t bits);
+
+		/* @brief Packs the floats in [-1, 1] as EE_FORMAT_A2B10G10R10_SNORM_PACK32 (x in the lowest bits) */
+		extern uint32_t packA2B10G10R10Snorm(float x, float y, float z, float w);
+
+	}
+}
@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eeprofiler.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "eeprofiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "eedefs.h"
+
+/* @brief Amount of samples per chunk of a thread's buffer */
+#define SAMPLES_PER_CHUNK 4096u
+
+namespace {
+
+	struct ProfileSample {
+		char const* name;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	/* @brief Only the owning thread appends, count is published after the sample is written */
+	struct ProfileChunk {
+		ProfileSample samples[SAMPLES_PER_CHUNK];
+		std::atomic<uint32_t> count{ 0u };
+		std::atomic<ProfileChunk*> pNext{ nullptr };
+	};
+
+	/* @brief Samples of one thread, kept after the thread ended so they can still be written */
+	struct ProfileBuffer {
+		uint32_t threadId;
+		ProfileChunk* pFirst;
+		ProfileChunk* pLast;
+	};
+
+	/* @brief All buffers, only locked when a thread records its first sample and when writing the trace */
+	std::mutex g_buffersMutex;
+	std::vector<ProfileBuffer*> g_buffers;
+
+	uint64_t nowNanoseconds()
+	{
+		static std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	ProfileBuffer* threadBuffer()
+	{
+		static thread_local ProfileBuffer* pBuffer{ nullptr };
+		if (!pBuffer) {
+			pBuffer = new ProfileBuffer;
+			pBuffer->pFirst = pBuffer->pLast = new ProfileChunk;
+
+			std::lock_guard<std::mutex> lock(g_buffersMutex);
+			pBuffer->threadId = uint32_t(g_buffers.size()) + 1u;
+			g_buffers.push_back(pBuffer);
+		}
+		return pBuffer;
+	}
+}
+
+
+EE::tools::ProfileScope::ProfileScope(char const* name)
+	: name(name)
+	, begin(nowNanoseconds())
+{}
+
+EE::tools::ProfileScope::~ProfileScope()
+{
+	uint64_t end = nowNanoseconds();
+	ProfileBuffer* pBuffer = threadBuffer();
+
+	// Start a new chunk if the last one is full, the old chunks stay valid for readers
+	ProfileChunk* pChunk = pBuffer->pLast;
+	uint32_t count = pChunk->count.load(std::memory_order_relaxed);
+	if (count == SAMPLES_PER_CHUNK) {
+		ProfileChunk* pNew = new ProfileChunk;
+		pChunk->pNext.store(pNew, std::memory_order_release);
+		pBuffer->pLast = pChunk = pNew;
+		count = 0u;
+	}
+
+	pChunk->samples[count] = { name, begin, end };
+	pChunk->count.store(count + 1u, std::memory_order_release);
+}
+
+bool EE::tools::writeProfileTrace(char const* fileName)
+{
+#if !defined(EE_PROFILE)
+	EE_PRINTA("[PROFILER] Profiling is compiled out, define EE_PROFILE to record samples for %s!\n", fileName);
+	return false;
+#else
+	FILE* pFile = fopen(fileName, "w");
+	if (!pFile) {
+		EE_PRINTA("[PROFILER] Failed to open %s to write the trace!\n", fileName);
+		return false;
+	}
+
+	fprintf(pFile, "{\"traceEvents\":[\n");
+	bool first = true;
+	{
+		std::lock_guard<std::mutex> lock(g_buffersMutex);
+		for (size_t i = 0u; i < g_buffers.size(); i++) {
+			fprintf(pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+				first ? "" : ",\n", g_buffers[i]->threadId, g_buffers[i]->threadId);
+			first = false;
+
+			// Only the samples published so far, the owner might append more meanwhile
+			for (ProfileChunk* pChunk = g_buffers[i]->pFirst; pChunk; pChunk = pChunk->pNext.load(std::memory_order_acquire)) {
+				uint32_t count = pChunk->count.load(std::memory_order_acquire);
+				for (uint32_t j = 0u; j < count; j++) {
+					ProfileSample const& sample = pChunk->samples[j];
+					fprintf(pFile, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+						sample.name, g_buffers[i]->threadId, double(sample.begin) / 1000.0, double(sample.end - sample.begin) / 1000.0);
+				}
+			}
+		}
+	}
+	fprintf(pFile, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	bool success = (ferror(pFile) == 0);
+	fclose(pFile);
+	return success;
+#endif
+}
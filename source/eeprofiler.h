@@ -0,0 +1,56 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: eeprofiler.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+
+//////////////////////
+// DEFINES / MACROS //
+//////////////////////
+/**
+ * Records the time spent in the enclosing scope under the name passed in (must be a string
+ * literal, only the pointer is stored). Compiles to nothing if EE_PROFILE is not defined.
+ **/
+#if defined(EE_PROFILE)
+# define EE_PROFILE_CONCAT_IMPL(a, b) a##b
+# define EE_PROFILE_CONCAT(a, b) EE_PROFILE_CONCAT_IMPL(a, b)
+# define EE_PROFILE_SCOPE(name) ::EE::tools::ProfileScope EE_PROFILE_CONCAT(eeProfileScope, __LINE__)(name);
+#else
+# define EE_PROFILE_SCOPE(name)
+#endif
+
+namespace EE {
+	namespace tools {
+
+		/**
+		 * Measures its own lifetime and stores it as a sample in the buffer of the calling thread.
+		 * Every thread appends to its own buffer without locking, writing the trace only reads
+		 * the samples each buffer published so far.
+		 **/
+		struct ProfileScope
+		{
+			char const* name;
+			uint64_t begin;
+
+			ProfileScope(char const* name);
+			~ProfileScope();
+
+			ProfileScope(ProfileScope const&) = delete;
+			ProfileScope& operator=(ProfileScope const&) = delete;
+		};
+
+		/**
+		 * Writes all samples recorded so far as chrome trace_event json, that can be opened
+		 * in chrome://tracing or ui.perfetto.dev. Can be called while other threads record.
+		 *
+		 * @param fileName	Destination of the json file
+		 *
+		 * @return False if the file couldn't be written or profiling is compiled out
+		 **/
+		extern bool writeProfileTrace(char const* fileName);
+
+	}
+}
@@ -0,0 +1,629 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: EECanvas.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "EECanvas.h"
+
+#include <algorithm>
+#include <string>
+
+#include "EEApplication.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+
+
+// Useful defines
+#define MAX(x, y) ((x > y) ? x : y)
+#define MIN(x, y) ((x < y) ? x : y)
+
+#define QUAD_VERTICES 4u
+#define QUAD_INDICES 6u
+#define MIN_QUAD_CAPACITY 256u
+
+// Sampling modes stored in the z coordinate of the texture coordinates
+#define SAMPLE_SOLID -1.0f
+#define SAMPLE_COVERAGE 0.0f
+#define SAMPLE_IMAGE 1.0f
+
+// Edge length in pixels of a cell of the hit test grid
+#define GRID_CELL_SIZE 64.0
+
+/* @brief Packs the color as EE_FORMAT_R8G8B8A8_UNORM */
+static uint32_t PackColor(EEColor const& color)
+{
+	return uint32_t(color.r * 255.0f + 0.5f)
+		| (uint32_t(color.g * 255.0f + 0.5f) << 8)
+		| (uint32_t(color.b * 255.0f + 0.5f) << 16)
+		| (uint32_t(color.a * 255.0f + 0.5f) << 24);
+}
+
+/* @brief Returns the cell the pixel coordinate lies in, clamped into the grid */
+static uint32_t CellCoordinate(double pixel, uint32_t cellCount)
+{
+	if (pixel <= 0.0) return 0u;
+	uint32_t cell = uint32_t(pixel / GRID_CELL_SIZE);
+	return MIN(cell, cellCount - 1u);
+}
+
+/* @brief Fills the indices for the amount of quads passed in, each quad pushed back as TL, BL, TR, BR */
+static void ComputeQuadIndices(uint32_t quadCount, std::vector<uint32_t>& indices)
+{
+	indices.resize(QUAD_INDICES * quadCount);
+	for (uint32_t q = 0u; q < quadCount; q++) {
+		uint32_t base = QUAD_VERTICES * q;
+		indices[QUAD_INDICES * q + 0] = base + 0u; //< top left
+		indices[QUAD_INDICES * q + 1] = base + 2u; //< top right
+		indices[QUAD_INDICES * q + 2] = base + 3u; //< bottom right
+		indices[QUAD_INDICES * q + 3] = base + 0u; //< top left
+		indices[QUAD_INDICES * q + 4] = base + 3u; //< bottom right
+		indices[QUAD_INDICES * q + 5] = base + 1u; //< bottom left
+	}
+}
+
+
+GFX::EECanvas::EECanvas(EEApplication* pApp, uint32_t maxBatches)
+	: m_pApp(pApp)
+	, m_maxBatches(maxBatches)
+{
+	if (!pApp) {
+		EE_PRINT("[EECANVAS] Passed in application is invalid!\n");
+		return;
+	}
+
+	CreateBatchShader();
+
+	// Batches that only contain solid rectangles still need a texture bound
+	unsigned char const white[4] = { 0xff, 0xff, 0xff, 0xff };
+	EETextureCreateInfo textureCInfo;
+	textureCInfo.pData = white;
+	textureCInfo.extent = { 1u, 1u };
+	textureCInfo.unnormalizedCoordinates = EE_FALSE;
+	textureCInfo.enableMipMapping = EE_FALSE;
+	textureCInfo.format = EE_FORMAT_R8G8B8A8_UNORM;
+	m_whiteTexture = m_pApp->CreateTexture(textureCInfo);
+
+	// The shared mesh is created with spare capacity, so adding items mostly just uploads their quads
+	m_quadCapacity = MIN_QUAD_CAPACITY;
+	std::vector<VertexInput> vertices(QUAD_VERTICES * m_quadCapacity, { {0.0f, 0.0f}, {0.0f, 0.0f, SAMPLE_SOLID}, 0u });
+	std::vector<uint32_t> indices;
+	ComputeQuadIndices(m_quadCapacity, indices);
+	m_mesh = m_pApp->CreateMesh(vertices.data(), sizeof(VertexInput) * vertices.size(), indices);
+
+	m_windowExtent = m_pApp->GetWindowExtent();
+	RebuildGrid();
+	m_isCreated = EE_TRUE;
+}
+
+GFX::EECanvas::~EECanvas()
+{
+	if (m_isCreated) {
+		// Release the objects of the batches
+		for (size_t i = 0u; i < m_batches.size(); i++) {
+			m_pApp->ReleaseObject(m_batches[i].object);
+		}
+		m_batches.clear();
+
+		// Release all items
+		for (size_t i = 0u; i < m_items.size(); i++) {
+			delete m_items[i];
+			delete m_iItems[i];
+		}
+		m_items.clear();
+		m_iItems.clear();
+
+		m_pApp->ReleaseMesh(m_mesh);
+		m_pApp->ReleaseTexture(m_whiteTexture);
+		m_pApp->ReleaseShader(m_shader);
+
+		m_isCreated = EE_FALSE;
+	}
+}
+
+GFX::EECanvasItem GFX::EECanvas::AddRect(EEPoint32F const& position, EERect32F const& size, EEColor const& color)
+{
+	if (!m_isCreated) {
+		EE_PRINT("[EECANVAS] Tried to add a rectangle to a canvas that wasn't created!\n");
+		return nullptr;
+	}
+
+	EEInternItem* pItem = new EEInternItem();
+	pItem->type = ITEM_TYPE_RECT;
+	pItem->position = position;
+	pItem->size = size;
+	pItem->color = color;
+	pItem->page = nullptr;
+	return AddItem(pItem);
+}
+
+GFX::EECanvasItem GFX::EECanvas::AddImage(EETexture texture, EEPoint32F const& position, EERect32F const& size, EEColor const& tint)
+{
+	if (!m_isCreated) {
+		EE_PRINT("[EECANVAS] Tried to add an image to a canvas that wasn't created!\n");
+		return nullptr;
+	}
+	if (!texture) {
+		EE_PRINT("[EECANVAS] Texture handle that was passed into AddImage was nullptr!\n");
+		return nullptr;
+	}
+
+	EEInternItem* pItem = new EEInternItem();
+	pItem->type = ITEM_TYPE_IMAGE;
+	pItem->position = position;
+	pItem->size = size;
+	pItem->color = tint;
+	pItem->page = texture;
+	return AddItem(pItem);
+}
+
+GFX::EECanvasItem GFX::EECanvas::AddText(EEFontEngine* pFontEngine, EEFont font, EEstring const& text,
+	EEPoint32F const& position, float size, EEColor const& color, EERect32F const& wrapDim)
+{
+	if (!m_isCreated) {
+		EE_PRINT("[EECANVAS] Tried to add a text to a canvas that wasn't created!\n");
+		return nullptr;
+	}
+	if (!pFontEngine || !font) {
+		EE_PRINT("[EECANVAS] Invalid font engine or font passed into AddText!\n");
+		return nullptr;
+	}
+
+	EEInternItem* pItem = new EEInternItem();
+	pItem->type = ITEM_TYPE_TEXT;
+	pItem->position = position;
+	pItem->size = wrapDim;
+	pItem->color = color;
+	pItem->page = pFontEngine->GetFontTexture(font);
+	pItem->pFontEngine = pFontEngine;
+	pItem->font = font;
+	pItem->charSize = size;
+	pItem->text = text;
+	LayoutItemText(pItem);
+	return AddItem(pItem);
+}
+
+void GFX::EECanvas::RemoveItem(EECanvasItem& item)
+{
+	if (!item) {
+		EE_PRINT("[EECANVAS] Tried to remove an item, that was already nullptr!\n");
+		return;
+	}
+
+	// Acquire the index and set the item pointer for the user to nullptr
+	uint32_t index = *item;
+	item = nullptr;
+
+	// Everything behind this item moves to the front in the vertex stream
+	MarkChanged(index);
+	GridRemove(m_items[index]);
+
+	delete m_items[index];
+	m_items.erase(m_items.begin() + index);
+	delete m_iItems[index];
+	m_iItems.erase(m_iItems.begin() + index);
+
+	EE_INVARIANT(m_items.size() == m_iItems.size());
+
+	// Update the indices of the following items
+	for (size_t i = index; i < m_iItems.size(); i++) {
+		(*m_iItems[i])--;
+	}
+}
+
+void GFX::EECanvas::SetItemBounds(EECanvasItem item, EEPoint32F const& position, EERect32F const& size)
+{
+	assert(item);
+	EEInternItem* pItem = m_items[*item];
+
+	bool sizeChanged = (size.width != pItem->size.width || size.height != pItem->size.height);
+	if (!sizeChanged && position.x == pItem->position.x && position.y == pItem->position.y) return;
+
+	GridRemove(pItem);
+	pItem->position = position;
+	pItem->size = size;
+
+	// The size of a text are its wrap dimensions, so the glyphs need to be layed out again
+	if (sizeChanged && pItem->type == ITEM_TYPE_TEXT) LayoutItemText(pItem);
+	GridInsert(pItem);
+
+	pItem->changed = true;
+	MarkChanged(*item);
+}
+
+void GFX::EECanvas::SetItemPosition(EECanvasItem item, EEPoint32F const& position)
+{
+	assert(item);
+	SetItemBounds(item, position, m_items[*item]->size);
+}
+
+void GFX::EECanvas::SetItemColor(EECanvasItem item, EEColor const& color)
+{
+	assert(item);
+	EEInternItem* pItem = m_items[*item];
+	if (PackColor(color) == PackColor(pItem->color)) return;
+
+	pItem->color = color;
+	pItem->changed = true;
+	MarkChanged(*item);
+}
+
+void GFX::EECanvas::SetItemText(EECanvasItem item, EEstring const& text, EERect32F const& wrapDim)
+{
+	assert(item);
+	EEInternItem* pItem = m_items[*item];
+	if (pItem->type != ITEM_TYPE_TEXT) {
+		EE_PRINT("[EECANVAS] Tried to set the text of an item that is not a text!\n");
+		return;
+	}
+	if (text == pItem->text && wrapDim.width == pItem->size.width && wrapDim.height == pItem->size.height) return;
+
+	GridRemove(pItem);
+	pItem->text = text;
+	pItem->size = wrapDim;
+	LayoutItemText(pItem);
+	GridInsert(pItem);
+
+	pItem->changed = true;
+	MarkChanged(*item);
+}
+
+void GFX::EECanvas::SetItemVisibility(EECanvasItem item, bool visible)
+{
+	assert(item);
+	EEInternItem* pItem = m_items[*item];
+	if (pItem->isVisible == visible) return;
+
+	pItem->isVisible = visible;
+	MarkChanged(*item);
+}
+
+EERect32F GFX::EECanvas::GetTextDimensions(EECanvasItem item) const
+{
+	if (!item) {
+		EE_PRINT("[EECANVAS] Tried to get text dimensions of a nullptr!\n");
+		assert(item);
+		return EERect32F();
+	}
+	return m_items[*item]->textDimensions;
+}
+
+bool GFX::EECanvas::IsItemHovered(EECanvasItem item)
+{
+	assert(item);
+	UpdateHoveredItems();
+	return m_items[*item]->isHovered;
+}
+
+void GFX::EECanvas::Update()
+{
+	if (!m_isCreated) return;
+
+	// Positions are relative to the window center, so a resize moves every item
+	EERect32U wExtent = m_pApp->GetWindowExtent();
+	if (wExtent.width != m_windowExtent.width || wExtent.height != m_windowExtent.height) {
+		m_windowExtent = wExtent;
+		for (size_t i = 0u; i < m_items.size(); i++) m_items[i]->changed = true;
+		MarkChanged(0u);
+		RebuildGrid();
+	}
+
+	if (!m_isChanged) return;
+
+	// Items in front of the first changed one keep their place in the stream, everything
+	// behind it is appended again (only changed items compute their quads again)
+	uint32_t quadCount{ 0u }, firstQuad{ 0u };
+	for (size_t i = 0u; i < m_items.size(); i++) {
+		EEInternItem* pItem = m_items[i];
+		if (i == m_firstChangedItem) {
+			firstQuad = quadCount;
+			m_vertices.resize(QUAD_VERTICES * firstQuad);
+		}
+		if (pItem->changed) {
+			ComputeItemVertices(pItem);
+			pItem->changed = false;
+		}
+
+		pItem->firstQuad = quadCount;
+		if (!pItem->isVisible) continue;
+
+		if (i >= m_firstChangedItem) m_vertices.insert(m_vertices.end(), pItem->vertices.begin(), pItem->vertices.end());
+		quadCount += uint32_t(pItem->vertices.size() / QUAD_VERTICES);
+	}
+	// The removed item(s) were the last ones
+	if (m_firstChangedItem >= m_items.size()) {
+		firstQuad = quadCount;
+		m_vertices.resize(QUAD_VERTICES * firstQuad);
+	}
+
+	UploadVertices(firstQuad);
+	BuildBatches();
+
+	m_isChanged = false;
+}
+
+::EEApplication* GFX::EECanvas::GetApplication() const
+{
+	return m_pApp;
+}
+
+GFX::EECanvasItem GFX::EECanvas::AddItem(EEInternItem* pItem)
+{
+	pItem->isVisible = true;
+	pItem->changed = true;
+	pItem->firstQuad = 0u;
+	GridInsert(pItem);
+
+	// New items are drawn on top of all others
+	EE_INVARIANT(m_items.size() == m_iItems.size());
+	m_items.push_back(pItem);
+	m_iItems.push_back(new uint32_t(uint32_t(m_items.size() - 1)));
+	MarkChanged(m_items.size() - 1);
+
+	return m_iItems[m_iItems.size() - 1];
+}
+
+void GFX::EECanvas::LayoutItemText(EEInternItem* pItem) const
+{
+	pItem->textDimensions = pItem->pFontEngine->LayoutGlyphs(pItem->font, pItem->text, pItem->charSize, pItem->size, pItem->glyphs);
+}
+
+void GFX::EECanvas::ComputeItemVertices(EEInternItem* pItem) const
+{
+	// Same transformation the other 2d widgets upload as world matrix, but applied once per change
+	// so the whole canvas can share the camera buffer as its only uniform
+	glm::vec3 translation{ -(m_windowExtent.width / 2.0f) + pItem->position.x, -(m_windowExtent.height / 2.0f) + pItem->position.y, 0.0f };
+	glm::vec3 scale = (pItem->type == ITEM_TYPE_TEXT) ? glm::vec3(pItem->charSize, pItem->charSize, 1.0f)
+																										: glm::vec3(pItem->size.width, pItem->size.height, 1.0f);
+	glm::mat4 world = glm::scale(scale);
+	world *= glm::translate(translation);
+
+	uint32_t color = PackColor(pItem->color);
+	pItem->vertices.clear();
+
+	if (pItem->type == ITEM_TYPE_TEXT) {
+		// The glyphs are already quads (TL, BL, TR, BR) sampling the coverage from the font atlas
+		pItem->vertices.reserve(pItem->glyphs.size());
+		for (size_t i = 0u; i < pItem->glyphs.size(); i++) {
+			glm::vec4 position = world * glm::vec4(pItem->glyphs[i].position.x, pItem->glyphs[i].position.y, 0.0f, 1.0f);
+			pItem->vertices.push_back({ {position.x, position.y},
+				{pItem->glyphs[i].texCoord.x, pItem->glyphs[i].texCoord.y, SAMPLE_COVERAGE}, color });
+		}
+
+	} else {
+		// Unit quad in the order the font engine pushes its letters: TOP LEFT, BOTTOM LEFT, TOP RIGHT, BOTTOM RIGHT
+		static glm::vec2 const corners[QUAD_VERTICES] = { {0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 0.0f}, {1.0f, 1.0f} };
+		float sampling = (pItem->type == ITEM_TYPE_IMAGE) ? SAMPLE_IMAGE : SAMPLE_SOLID;
+		for (uint32_t i = 0u; i < QUAD_VERTICES; i++) {
+			glm::vec4 position = world * glm::vec4(corners[i].x, corners[i].y, 0.0f, 1.0f);
+			pItem->vertices.push_back({ {position.x, position.y}, {corners[i].x, corners[i].y, sampling}, color });
+		}
+	}
+}
+
+void GFX::EECanvas::MarkChanged(size_t index)
+{
+	if (!m_isChanged || index < m_firstChangedItem) m_firstChangedItem = index;
+	m_isChanged = true;
+}
+
+EERect32F GFX::EECanvas::ItemBounds(EEInternItem const* pItem) const
+{
+	return (pItem->type == ITEM_TYPE_TEXT) ? pItem->textDimensions : pItem->size;
+}
+
+void GFX::EECanvas::GridInsert(EEInternItem* pItem)
+{
+	EERect32F bounds = ItemBounds(pItem);
+	pItem->cellMinX = CellCoordinate(pItem->position.x, m_gridColumns);
+	pItem->cellMinY = CellCoordinate(pItem->position.y, m_gridRows);
+	pItem->cellMaxX = CellCoordinate(pItem->position.x + bounds.width, m_gridColumns);
+	pItem->cellMaxY = CellCoordinate(pItem->position.y + bounds.height, m_gridRows);
+
+	for (uint32_t y = pItem->cellMinY; y <= pItem->cellMaxY; y++) {
+		for (uint32_t x = pItem->cellMinX; x <= pItem->cellMaxX; x++) {
+			m_cells[y * m_gridColumns + x].push_back(pItem);
+		}
+	}
+	m_gridChanged = true;
+}
+
+void GFX::EECanvas::GridRemove(EEInternItem* pItem)
+{
+	for (uint32_t y = pItem->cellMinY; y <= pItem->cellMaxY; y++) {
+		for (uint32_t x = pItem->cellMinX; x <= pItem->cellMaxX; x++) {
+			std::vector<EEInternItem*>& cell = m_cells[y * m_gridColumns + x];
+			cell.erase(std::remove(cell.begin(), cell.end(), pItem), cell.end());
+		}
+	}
+
+	// The item must not stay in the hovered list, it could be deleted
+	m_hoveredItems.erase(std::remove(m_hoveredItems.begin(), m_hoveredItems.end(), pItem), m_hoveredItems.end());
+	pItem->isHovered = false;
+	m_gridChanged = true;
+}
+
+void GFX::EECanvas::RebuildGrid()
+{
+	m_gridColumns = MAX(uint32_t(m_windowExtent.width / GRID_CELL_SIZE) + 1u, 1u);
+	m_gridRows = MAX(uint32_t(m_windowExtent.height / GRID_CELL_SIZE) + 1u, 1u);
+	m_cells.clear();
+	m_cells.resize(size_t(m_gridColumns) * m_gridRows);
+
+	for (size_t i = 0u; i < m_items.size(); i++) {
+		GridInsert(m_items[i]);
+	}
+	m_gridChanged = true;
+}
+
+void GFX::EECanvas::UpdateHoveredItems()
+{
+	EEPoint64F mousePos = m_pApp->MousePosition();
+	if (!m_gridChanged && mousePos.x == m_lastMousePosition.x && mousePos.y == m_lastMousePosition.y) return;
+	m_lastMousePosition = mousePos;
+	m_gridChanged = false;
+
+	for (size_t i = 0u; i < m_hoveredItems.size(); i++) {
+		m_hoveredItems[i]->isHovered = false;
+	}
+	m_hoveredItems.clear();
+
+	// Only the items overlapping the cell of the mouse need the exact test
+	std::vector<EEInternItem*> const& cell = m_cells[CellCoordinate(mousePos.y, m_gridRows) * m_gridColumns
+																									 + CellCoordinate(mousePos.x, m_gridColumns)];
+	for (size_t i = 0u; i < cell.size(); i++) {
+		EERect32F bounds = ItemBounds(cell[i]);
+		double t1 = mousePos.x - cell[i]->position.x;
+		double t2 = mousePos.y - cell[i]->position.y;
+		if (t1 > 0 && t1 < bounds.width && t2 > 0 && t2 < bounds.height) {
+			cell[i]->isHovered = true;
+			m_hoveredItems.push_back(cell[i]);
+		}
+	}
+}
+
+void GFX::EECanvas::CreateBatchShader()
+{
+	// Descriptors
+	std::vector<EEDescriptorDesc> descriptors(2);
+	descriptors[0].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descriptors[0].shaderStage = EE_SHADER_STAGE_VERTEX;
+	descriptors[0].binding = 0u;
+
+	descriptors[1].type = EE_DESCRIPTOR_TYPE_SAMPLER;
+	descriptors[1].shaderStage = EE_SHADER_STAGE_FRAGMENT;
+	descriptors[1].binding = 1u;
+
+	// Vertex Input
+	std::vector<EEShaderInputDesc> shaderInputs(3);
+	shaderInputs[0].location = 0u;
+	shaderInputs[0].format = EE_FORMAT_R32G32_SFLOAT;
+	shaderInputs[0].offset = offsetof(VertexInput, position);
+
+	shaderInputs[1].location = 1u;
+	shaderInputs[1].format = EE_FORMAT_R32G32B32_SFLOAT;
+	shaderInputs[1].offset = offsetof(VertexInput, texCoord);
+
+	shaderInputs[2].location = 2u;
+	shaderInputs[2].format = EE_FORMAT_R8G8B8A8_UNORM;
+	shaderInputs[2].offset = offsetof(VertexInput, color);
+
+	EEVertexInput vertexInput;
+	vertexInput.amountInputs = uint32_t(shaderInputs.size());
+	vertexInput.pInputDescs = shaderInputs.data();
+	vertexInput.inputStride = sizeof(VertexInput);
+
+	std::string vert = EE_ASSETS_DIR("shader/canvasVert.spv");
+	std::string frag = EE_ASSETS_DIR("shader/canvasFrag.spv");
+	EEShaderCreateInfo shaderCInfo;
+	shaderCInfo.vertexFileName = vert.c_str();
+	shaderCInfo.fragmentFileName = frag.c_str();
+	shaderCInfo.amountObjects = m_maxBatches;
+	shaderCInfo.shaderInputType = EE_SHADER_INPUT_TYPE_CUSTOM;
+	shaderCInfo.pVertexInput = &vertexInput;
+	shaderCInfo.amountDescriptors = uint32_t(descriptors.size());
+	shaderCInfo.pDescriptors = descriptors.data();
+	shaderCInfo.pPushConstant = nullptr;
+	shaderCInfo.is2DShader = EE_TRUE;
+	shaderCInfo.wireframe = EE_FALSE;
+	shaderCInfo.clockwise = EE_TRUE;
+	shaderCInfo.indirectDraw = EE_FALSE;
+	m_shader = m_pApp->CreateShader(shaderCInfo);
+}
+
+void GFX::EECanvas::BuildBatches()
+{
+	// Split the stream where the sampled page switches, solid rectangles don't sample
+	// so they join the batch of whatever page is around them
+	std::vector<Batch> runs;
+	Batch current{ nullptr, nullptr, 0u, 0u };
+	for (size_t i = 0u; i < m_items.size(); i++) {
+		EEInternItem const* pItem = m_items[i];
+		uint32_t quads = uint32_t(pItem->vertices.size() / QUAD_VERTICES);
+		if (!pItem->isVisible || !quads) continue;
+
+		if (pItem->page && current.page && pItem->page != current.page) {
+			runs.push_back(current);
+			current = { pItem->page, nullptr, pItem->firstQuad, 0u };
+		} else if (pItem->page) {
+			current.page = pItem->page;
+		}
+		current.quadCount += quads;
+	}
+	if (current.quadCount) runs.push_back(current);
+
+	// The shader can't hold more objects, so it is recreated with room for all runs and
+	// every batch object is created again in draw order
+	if (runs.size() > m_maxBatches) {
+		for (size_t i = 0u; i < m_batches.size(); i++) {
+			m_pApp->ReleaseObject(m_batches[i].object);
+		}
+		m_batches.clear();
+		m_usedBatches = 0u;
+
+		m_pApp->ReleaseShader(m_shader);
+		m_maxBatches = MAX(uint32_t(runs.size()), 2u * m_maxBatches);
+		CreateBatchShader();
+	}
+
+	// Objects are kept in draw order and only get another page bound, so an unchanged canvas
+	// layout just moves the draw ranges
+	for (uint32_t i = 0u; i < uint32_t(runs.size()); i++) {
+		EETexture page = (runs[i].page) ? runs[i].page : m_whiteTexture;
+		if (i == m_batches.size()) m_batches.push_back({ nullptr, nullptr, 0u, 0u });
+
+		Batch& batch = m_batches[i];
+		if (batch.object && batch.page != page) {
+			m_pApp->SetObjectTexture(batch.object, 1u, page);
+			batch.page = page;
+		} else if (!batch.object) {
+			std::vector<EEObjectResourceBinding> bindings(2);
+			bindings[0].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			bindings[0].binding = 0u;
+			bindings[0].resource = m_pApp->AcquireCameraBuffer2D();
+
+			bindings[1].type = EE_DESCRIPTOR_TYPE_SAMPLER;
+			bindings[1].binding = 1u;
+			bindings[1].resource = page;
+
+			batch.object = m_pApp->CreateObject(m_shader, m_mesh, bindings);
+			batch.page = page;
+		}
+
+		batch.firstQuad = runs[i].firstQuad;
+		batch.quadCount = runs[i].quadCount;
+		m_pApp->SetObjectDrawRange(batch.object, QUAD_INDICES * batch.firstQuad, QUAD_INDICES * batch.quadCount);
+		if (i >= m_usedBatches) m_pApp->SetObjectVisibility(batch.object, EE_TRUE);
+	}
+
+	// Objects that are not needed anymore are hidden and kept for later
+	for (uint32_t i = uint32_t(runs.size()); i < m_usedBatches; i++) {
+		m_pApp->SetObjectVisibility(m_batches[i].object, EE_FALSE);
+	}
+	m_usedBatches = uint32_t(runs.size());
+}
+
+void GFX::EECanvas::UploadVertices(uint32_t firstQuad)
+{
+	uint32_t quadCount = uint32_t(m_vertices.size() / QUAD_VERTICES);
+
+	// Try to just upload the changed quads into the spare capacity
+	if (quadCount <= m_quadCapacity) {
+		size_t offset = sizeof(VertexInput) * QUAD_VERTICES * firstQuad;
+		size_t size = sizeof(VertexInput) * QUAD_VERTICES * (quadCount - firstQuad);
+		if (m_pApp->UpdateMeshRange(m_mesh, (size) ? &m_vertices[QUAD_VERTICES * firstQuad] : nullptr,
+																offset, size, QUAD_INDICES * quadCount)) {
+			return;
+		}
+	}
+
+	// Capacity exceeded so grow geometrically and upload the whole stream
+	m_quadCapacity = MAX(2u * m_quadCapacity, quadCount);
+	std::vector<VertexInput> vertices = m_vertices;
+	vertices.resize(QUAD_VERTICES * m_quadCapacity, { {0.0f, 0.0f}, {0.0f, 0.0f, SAMPLE_SOLID}, 0u });
+	std::vector<uint32_t> indices;
+	ComputeQuadIndices(m_quadCapacity, indices);
+	m_pApp->UpdateMesh(m_mesh, vertices.data(), sizeof(VertexInput) * vertices.size(), indices);
+	m_pApp->UpdateMeshRange(m_mesh, nullptr, 0u, 0u, QUAD_INDICES * quadCount);
+}
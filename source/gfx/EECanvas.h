@@ -0,0 +1,286 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: EECanvas.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include <vector>
+
+/////////////////
+// MY INCLUDES //
+/////////////////
+#include "eedefs.h"
+#include "EEFontEngine.h"
+
+///////////////////////////
+// FOREWARD DECLARATIONS //
+///////////////////////////
+class EEApplication;
+
+namespace GFX
+{
+	EE_DEFINE_HANDLE(EECanvasItem);
+
+	/**
+	 * Retained 2d canvas that owns the geometry of its widgets. Every rectangle, image and text
+	 * on the canvas is written as quads into one vertex stream with the color and the sampling
+	 * mode stored per vertex. So the whole canvas is drawn with one draw call per texture page
+	 * (font atlas/image), all sharing the same mesh, instead of one object per widget.
+	 * Items are drawn in the order they were added, later ones on top.
+	 **/
+	class EECanvas
+	{
+	public:
+		/* @brief [ShaderSpecific] Holds the shader input values per vertex */
+		struct VertexInput {
+			glm::vec2 position;
+			glm::vec3 texCoord;	//< z selects the sampling: < 0 solid color, 0 coverage in red channel (fonts), 1 color image
+			uint32_t	color;		//< EE_FORMAT_R8G8B8A8_UNORM
+		};
+
+	private:
+		enum ItemType {
+			ITEM_TYPE_RECT,
+			ITEM_TYPE_IMAGE,
+			ITEM_TYPE_TEXT
+		};
+
+		/* @brief Holds informations of an item that is drawn by the canvas */
+		struct EEInternItem {
+			ItemType			type;
+			EEPoint32F		position;
+			EERect32F			size;				//< Pixel size of rects/images and wrap dimensions of texts
+			EEColor				color;
+			EETexture			page;				//< Texture the item samples from (nullptr for solid rects)
+			bool					isVisible;
+
+			/* @brief Font, size and the layed out glyphs in letter units of text items */
+			EEFontEngine*	pFontEngine;
+			EEFont				font;
+			float					charSize;
+			EEstring			text;
+			EERect32F			textDimensions;
+			std::vector<EEFontEngine::VertexInput> glyphs;
+
+			/* @brief The quads of this item in pixels, only computed again if the item changed */
+			std::vector<VertexInput> vertices;
+			bool					changed;
+			uint32_t			firstQuad;
+
+			/* @brief Cells of the hit test grid the bounds of this item overlap (inclusive) */
+			uint32_t			cellMinX, cellMinY, cellMaxX, cellMaxY;
+			bool					isHovered;
+		};
+
+		/* @brief A run of consecutive items sampling from the same page, drawn by one object */
+		struct Batch {
+			EETexture page;
+			EEObject	object;
+			uint32_t	firstQuad;
+			uint32_t	quadCount;
+		};
+
+	public:
+		/**
+		 * Creates the shader and the shared mesh of the canvas.
+		 *
+		 * @param pApp				Pointer to the application to use
+		 * @param maxBatches	Amount of texture page switches the canvas is created for (defaulted), grown if exceeded
+		 **/
+		EECanvas(EEApplication* pApp, uint32_t maxBatches = 64u);
+
+		/**
+		 * Releases all items, the batch objects and the shared mesh
+		 **/
+		~EECanvas();
+
+		/**
+		 * Adds a solid rectangle on top of the canvas
+		 *
+		 * @param position	Top left corner of the rectangle in pixels
+		 * @param size			Width and height in pixels
+		 * @param color			Fill color of the rectangle
+		 *
+		 * @return Handle to the created item
+		 **/
+		EECanvasItem AddRect(EEPoint32F const& position, EERect32F const& size, EEColor const& color);
+
+		/**
+		 * Adds a textured rectangle on top of the canvas. The texture needs to be created with
+		 * normalized coordinates, the color is multiplied with the sampled texel.
+		 *
+		 * @param texture		The texture that will be drawn
+		 * @param position	Top left corner of the image in pixels
+		 * @param size			Width and height in pixels
+		 * @param tint			Color the texture will be multiplied with (defaulted to white)
+		 *
+		 * @return Handle to the created item
+		 **/
+		EECanvasItem AddImage(
+			EETexture					texture,
+			EEPoint32F const& position,
+			EERect32F const&	size,
+			EEColor const&		tint = { 1.0f, 1.0f, 1.0f, 1.0f });
+
+		/**
+		 * Adds a text on top of the canvas, the glyphs are layed out by the font engine passed in
+		 * and sample from the atlas of the font.
+		 *
+		 * @param pFontEngine	Font engine the font was created with
+		 * @param font				Handle to the font to use
+		 * @param text				The text to be rendered (must only include characters from the charset)
+		 * @param position		Top left corner position of the text
+		 * @param size				Size of the text in pixel
+		 * @param color				Color of the text
+		 * @param wrapDim			Width and height borders the text will not exceed (defaults to -1 for no auto wrap)
+		 *
+		 * @return Handle to the created item
+		 **/
+		EECanvasItem AddText(
+			EEFontEngine*			pFontEngine,
+			EEFont						font,
+			EEstring const&		text,
+			EEPoint32F const& position,
+			float							size,
+			EEColor const&		color,
+			EERect32F const&	wrapDim = { -1.0f, -1.0f });
+
+		/**
+		 * Removes the item from the canvas and sets the handle to nullptr
+		 **/
+		void RemoveItem(EECanvasItem& item);
+
+		/**
+		 * Changes position and size of the item passed in. For texts the size defines the wrap dimensions.
+		 **/
+		void SetItemBounds(EECanvasItem item, EEPoint32F const& position, EERect32F const& size);
+
+		/* @brief Changes the top left corner of the item passed in */
+		void SetItemPosition(EECanvasItem item, EEPoint32F const& position);
+
+		/* @brief Changes the fill/text/tint color of the item passed in */
+		void SetItemColor(EECanvasItem item, EEColor const& color);
+
+		/**
+		 * Changes the string and the wrap dimensions of a text item
+		 * @note The new text must not contain a char that was not in the charset of the font
+		 **/
+		void SetItemText(EECanvasItem item, EEstring const& text, EERect32F const& wrapDim = { -1.0f, -1.0f });
+
+		/* @brief Changes the visibility of the item passed in */
+		void SetItemVisibility(EECanvasItem item, bool visible);
+
+		/* @brief Returns the pixel width/height of a text item */
+		EERect32F GetTextDimensions(EECanvasItem item) const;
+
+		/**
+		 * Returns wether the mouse is over the item passed in. The items under the mouse are looked
+		 * up in a uniform grid over the item bounds once per mouse movement (or change of the items),
+		 * so asking this for every widget per frame doesn't test every item against the mouse.
+		 **/
+		bool IsItemHovered(EECanvasItem item);
+
+		/**
+		 * Please call every frame. If any item changed since the last call the vertex stream is
+		 * written again starting at the first changed item, only that part is uploaded and the
+		 * batches are rebuilt. Otherwise this does nothing.
+		 **/
+		void Update();
+
+		/**
+		 * @return The application this canvas operates on
+		 **/
+		::EEApplication* GetApplication() const;
+
+	private:
+		/* @brief Stores the item and returns the new handle to it */
+		EECanvasItem AddItem(EEInternItem* pItem);
+
+		/* @brief Lays out the glyphs of a text item again */
+		void LayoutItemText(EEInternItem* pItem) const;
+
+		/* @brief Computes the quads of the item in pixels */
+		void ComputeItemVertices(EEInternItem* pItem) const;
+
+		/* @brief Indicates that the item at the index passed in and every item after it need to be uploaded again */
+		void MarkChanged(size_t index);
+
+		/* @brief Returns the pixel width/height of the item used for hit testing */
+		EERect32F ItemBounds(EEInternItem const* pItem) const;
+
+		/* @brief Inserts the item into every cell of the hit test grid its bounds overlap */
+		void GridInsert(EEInternItem* pItem);
+
+		/* @brief Removes the item from the cells of the hit test grid it was inserted into */
+		void GridRemove(EEInternItem* pItem);
+
+		/* @brief Sizes the hit test grid to the current window extent and inserts all items again */
+		void RebuildGrid();
+
+		/* @brief Looks up the items under the mouse if it moved or the grid changed since the last call */
+		void UpdateHoveredItems();
+
+		/* @brief Creates the shader drawing the vertex stream with room for m_maxBatches objects */
+		void CreateBatchShader();
+
+		/**
+		 * Computes the runs of items that share a texture page and updates the objects drawing them,
+		 * their pages are rebound in place so they keep their draw order
+		 **/
+		void BuildBatches();
+
+		/**
+		 * Uploads the quads starting at the one passed in. If the capacity of the mesh is
+		 * exceeded it will be grown geometrically and the whole mesh uploaded.
+		 **/
+		void UploadVertices(uint32_t firstQuad);
+
+	private:
+		/* @brief The application this canvas will use */
+		EEApplication* m_pApp;
+		/* @brief The shader drawing the vertex stream */
+		EEShader m_shader;
+		/* @brief The mesh holding the quads of every item */
+		EEMesh m_mesh;
+		/* @brief White texture bound to batches that only contain solid rectangles */
+		EETexture m_whiteTexture;
+		/* @brief Maximum amount of batch objects (amount of objects of the shader), grown by BuildBatches */
+		uint32_t m_maxBatches;
+
+		/* @brief All items of the canvas in draw order */
+		std::vector<EEInternItem*> m_items;
+		/* @brief The indices/handles of items given to the user */
+		std::vector<uint32_t*> m_iItems;
+
+		/* @brief The batches currently drawn, objects are kept to be reused */
+		std::vector<Batch> m_batches;
+		uint32_t m_usedBatches{ 0u };
+
+		/* @brief The vertex stream in draw order (four vertices per quad) */
+		std::vector<VertexInput> m_vertices;
+		/* @brief Amount of quads the mesh can hold without reallocating */
+		uint32_t m_quadCapacity{ 0u };
+
+		/* @brief Index of the first item that changed since the last update */
+		size_t m_firstChangedItem{ 0u };
+		bool m_isChanged{ false };
+		/* @brief The window extent the vertices were computed with (positions depend on it) */
+		EERect32U m_windowExtent{ 0u, 0u };
+
+		/* @brief Uniform grid over the window, each cell lists the items overlapping it */
+		std::vector<std::vector<EEInternItem*>> m_cells;
+		uint32_t m_gridColumns{ 0u };
+		uint32_t m_gridRows{ 0u };
+		/* @brief Items under the mouse at the last lookup */
+		std::vector<EEInternItem*> m_hoveredItems;
+		EEPoint64F m_lastMousePosition{ -1.0, -1.0 };
+		bool m_gridChanged{ true };
+
+		/* @brief Indicates wether the canvas can be used */
+		EEBool32 m_isCreated{ EE_FALSE };
+	};
+}
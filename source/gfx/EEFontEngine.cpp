@@ -5,10 +5,14 @@
 /////////////////////////////////////////////////////////////////////
 #include "EEFontEngine.h"
 
-#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 #include "eehelper.h"
+#include "eeprofiler.h"
 #include "EEApplication.h"
+#include "coretools/JobSystem.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
@@ -23,6 +27,18 @@
 #define SPACE_DISTANCE 0.5f
 #define ABS_LETTER_HEIGHT 1.0f
 
+#define QUAD_VERTICES 4u
+#define QUAD_INDICES 6u
+#define MIN_QUAD_CAPACITY 32u
+#define MAX_CACHED_WORDS 4096u
+
+#define FONT_PIXEL_WIDTH 40
+#define FONT_PIXEL_HEIGHT 45
+#define MIN_GLYPHS_PER_JOB 16u
+
+#define FONT_CACHE_MAGIC 0x43464545u //< "EEFC"
+#define FONT_CACHE_VERSION 1u
+
 GFX::EEFontEngine::EEFontEngine(EEApplication* pApp, uint32_t amountTexts)
 	: m_pApp(pApp)
 {
@@ -39,7 +55,7 @@ GFX::EEFontEngine::EEFontEngine(EEApplication* pApp, uint32_t amountTexts)
 	// Shader
 	{
 		// Descriptors
-		std::vector<EEDescriptorDesc> descriptors(3);
+		std::vector<EEDescriptorDesc> descriptors(4);
 		descriptors[0].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		descriptors[0].shaderStage = EE_SHADER_STAGE_VERTEX;
 		descriptors[0].binding = 0u;
@@ -52,6 +68,10 @@ GFX::EEFontEngine::EEFontEngine(EEApplication* pApp, uint32_t amountTexts)
 		descriptors[2].shaderStage = EE_SHADER_STAGE_FRAGMENT;
 		descriptors[2].binding = 2u;
 
+		descriptors[3].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		descriptors[3].shaderStage = EE_SHADER_STAGE_VERTEX;
+		descriptors[3].binding = 3u;
+
 		// Vertex Input
 		std::vector<EEShaderInputDesc> shaderInputs(2);
 		shaderInputs[0].location = 0u;
@@ -81,6 +101,7 @@ GFX::EEFontEngine::EEFontEngine(EEApplication* pApp, uint32_t amountTexts)
 		shaderCInfo.is2DShader = EE_TRUE;
 		shaderCInfo.wireframe = EE_FALSE;
 		shaderCInfo.clockwise = EE_TRUE;
+		shaderCInfo.indirectDraw = EE_FALSE;
 		m_shader = m_pApp->CreateShader(shaderCInfo);
 	}
 
@@ -123,105 +144,44 @@ GFX::EEFont GFX::EEFontEngine::CreateFont(char const* fileName, EEcstr charSet)
 	EEInternFont* pFont = new EEInternFont;
 	assert(pFont);
 
-	// Read in the font file using the free type library
-	FT_Error error = FT_New_Face(m_library, fileName, 0, &pFont->face);
-	if (error == FT_Err_Unknown_File_Format) {
-		delete pFont;
-		EE_PRINT("[EEFONTENGINE] The font file could not be opened. Its format is probably not supported by freetype!\n");
-		EE::tools::warning("[EEFONTENGINE] The font file could not be opened. Its format is probably not supported by freetype!\n");
-		return nullptr;
-	} else if (error) { //< some other error
-		delete pFont;
-		EE_PRINT("[EEFONTENGINE] Could not read in font file!\n");
-		EE::tools::warning("[EEFONTENGINE] Could not read in font file!\n");
-		return nullptr;
-	}
+	pFont->face = nullptr;
 
-	// Set the size of the font face
-	error = FT_Set_Pixel_Sizes(pFont->face, 40, 45);
-	if (error) {
-		delete pFont;
-		EE_PRINT("[EEFONTENGINE] Failed to set up font (size)!\n");
-		EE::tools::warning("[EEFONTENGINE] Failed to set up font (size)!\n");
-		return nullptr;
-	}
-
-	// Acquire informations about the passed in character set
-	size_t numChars = EE_STRLEN(charSet);
-	uint32_t fontImgWidth{ 0u }, fontImgHeight{ 0u }, glyphIndex{ 0u };
-	uint32_t maxTopBearingY{ 0u }, maxBelowBearingY{ 0u };
-
-	// Initialize fonts' max values so the checks during the loop can be made
-	pFont->maxLetterWidth = 0u;
-
-	FT_GlyphSlot glyph = pFont->face->glyph;
-	uint32_t letterWidth;
-	// Get the bitmap per character
-	for (size_t i = 0u; i < numChars; i++) {
-		glyphIndex = FT_Get_Char_Index(pFont->face, charSet[i]);
-		error = FT_Load_Glyph(pFont->face, glyphIndex, FT_LOAD_DEFAULT);
-		if (error) continue;
-		error = FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
-		if (error) continue;
-
-		// Store informations about the position of this character in the final image for the shader
-		letterWidth = glyph->bitmap.width + MAX(0, 2*glyph->bitmap_left);
-		pFont->letterDetails[charSet[i]] = {
-			fontImgWidth,
-			letterWidth,
-			glyph->bitmap.rows,
-			uint32_t(MAX(0, glyph->bitmap_left)),
-			uint32_t(MAX(0, glyph->bitmap_top))
-		};
-
-		// Update the final font image dimensions
-		pFont->maxLetterWidth = MAX(letterWidth, pFont->maxLetterWidth);
-		fontImgWidth += letterWidth;
-		maxTopBearingY = MAX(uint32_t(MAX(0, glyph->bitmap_top)), maxTopBearingY);
-		maxBelowBearingY = MAX(uint32_t(glyph->bitmap.rows)
-														 - MIN(glyph->bitmap.rows, uint32_t(MAX(0, glyph->bitmap_top)))
-													 , maxBelowBearingY);
+	// Try to map the baked font from the cache, which is keyed by the font file, pixel size and charset
+	EE::tools::MappedFile cacheFile;
+	unsigned char const* fontImageData{ nullptr };
+	std::string cacheFileName;
+	if (!m_fontCacheDir.empty()) {
+		cacheFileName = FontCacheFileName(fileName, charSet);
+		if (!cacheFileName.empty() && EE::tools::mapFile(cacheFileName.c_str(), cacheFile)) {
+			fontImageData = ReadFontCache(cacheFile, charSet, pFont);
+		}
 	}
 
-	fontImgHeight = maxTopBearingY + maxBelowBearingY;
-
-	// We got the informations now we can allocate memory and fill it with the image data
-	unsigned char* fontImageData = new unsigned char[fontImgWidth * fontImgHeight];
-	memset(fontImageData, 0, sizeof(unsigned char) * fontImgWidth * fontImgHeight);
-	Letter curLetter; //< Stores the current letter to read
-	for (uint32_t i = 0u; i < numChars; i++) {
-		glyphIndex = FT_Get_Char_Index(pFont->face, charSet[i]);
-		error = FT_Load_Glyph(pFont->face, glyphIndex, FT_LOAD_DEFAULT);
-		if (error) continue;
-		error = FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
-		if (error) continue;
-
-		// We dont need a try catch since we know it was added before (same charset)
-		curLetter = pFont->letterDetails.at(charSet[i]);
-
-		// Write the image data of the character to the correct position in the final fontImageData
-		for (uint32_t y = 0u; y < pFont->face->glyph->bitmap.rows; y++) {
-			for (uint32_t x = 0u; x < pFont->face->glyph->bitmap.width; x++) {
-				unsigned char curVal = pFont->face->glyph->bitmap.buffer[y * pFont->face->glyph->bitmap.width + x];
-				fontImageData[(y + maxTopBearingY - curLetter.bearingY) * fontImgWidth + curLetter.offsetX + curLetter.bearingX + x] = curVal;
-			}
+	// Otherwise rasterize the font and bake it for the next time
+	std::vector<unsigned char> rasterizedImage;
+	if (!fontImageData) {
+		EE::tools::unmapFile(cacheFile);
+		pFont->letterDetails.clear();
+		if (!RasterizeFont(fileName, charSet, pFont, rasterizedImage)) {
+			delete pFont;
+			return nullptr;
 		}
-	}
+		fontImageData = rasterizedImage.data();
 
-	// Store the texture size
-	pFont->width = fontImgWidth;
-	pFont->height = fontImgHeight;
+		if (!cacheFileName.empty()) WriteFontCache(cacheFileName.c_str(), charSet, pFont, fontImageData);
+	}
 
 	// Create the font texture
 	EETextureCreateInfo textureCInfo;
 	textureCInfo.pData = fontImageData;
-	textureCInfo.extent = { fontImgWidth, fontImgHeight };
+	textureCInfo.extent = { pFont->width, pFont->height };
 	textureCInfo.unnormalizedCoordinates = EE_TRUE;
-	textureCInfo.enableMipMapping = EE_TRUE;
+	textureCInfo.enableMipMapping = EE_FALSE;
 	textureCInfo.format = EE_FORMAT_R8_UNORM;
 	pFont->texture = m_pApp->CreateTexture(textureCInfo);
 
-	delete[] fontImageData;
+	// The texture is uploaded so the cache view is not needed anymore
+	EE::tools::unmapFile(cacheFile);
 	fontImageData = nullptr;
 
 	// Store the intern font struct and the new handle to it
@@ -247,7 +207,7 @@ void GFX::EEFontEngine::ReleaseFont(EEFont& font)
 
 	// Release the resources that only this font was using
 	m_pApp->ReleaseTexture(m_currentFonts[index]->texture);
-	FT_Done_Face(m_currentFonts[index]->face);
+	if (m_currentFonts[index]->face) FT_Done_Face(m_currentFonts[index]->face); //< Fonts read from the cache have no face
 
 	// Release the instance of EEInternFont
 	delete m_currentFonts[index];
@@ -271,7 +231,8 @@ void GFX::EEFontEngine::ReleaseFont(EEFont& font)
 	EE_INVARIANT(m_currentFonts.size() == m_iCurrentFonts.size());
 }
 
-GFX::EEText GFX::EEFontEngine::RenderText(EEFont font, EEstring const& text, EEPoint32F const& position, float size, EEColor const& color)
+GFX::EEText GFX::EEFontEngine::RenderText(EEFont font, EEstring const& text, EEPoint32F const& position, float size, EEColor const& color,
+	EERect32F const& wrapDim)
 {
 	// Get the font
 	EEInternFont* curFont = m_currentFonts[*font];
@@ -285,19 +246,29 @@ GFX::EEText GFX::EEFontEngine::RenderText(EEFont font, EEstring const& text, EEP
 	pText->pFont = curFont;
 	pText->size = size;
 	pText->position = position;
+	pText->wrapDim = wrapDim;
+
+	// Layout the whole text starting with an empty cursor
+	pText->text = text;
+	pText->cursors.push_back({ 0.0f, 0.0f, 0.0f, 0u });
+	ComputeMeshAccToFont(pText, 0u);
 
-	// Get the mesh for the text
+	// Create the mesh with spare capacity so edits of the text do not need to reallocate it
+	pText->quadCapacity = MAX(MIN_QUAD_CAPACITY, LAST_ELEMENT(pText->cursors).quadCount);
 	std::vector<VertexInput> vertices;
 	std::vector<uint32_t> indices;
-	if (!ComputeMeshAccToFont(curFont, text, vertices, indices, pText->maxTextDimensions)) return nullptr;
-	pText->mesh = m_pApp->CreateMesh(vertices.data(), sizeof(VertexInput) * vertices.size(), indices);
+	ComputeCapacityMesh(pText, vertices, indices);
+	EEShaderInputDesc positionInput{ 0u, EE_FORMAT_R32G32_SFLOAT, offsetof(VertexInput, position) };
+	EEVertexInput vertexInput{ 1u, &positionInput, sizeof(VertexInput) };
+	pText->mesh = m_pApp->CreateMesh(vertices.data(), sizeof(VertexInput) * vertices.size(), indices, &vertexInput);
+	m_pApp->UpdateMeshRange(pText->mesh, nullptr, 0u, 0u, QUAD_INDICES * LAST_ELEMENT(pText->cursors).quadCount);
 
 	// Create the ubos
 	pText->vertexBuffer = m_pApp->CreateBuffer(sizeof(VertexUBO));
 	pText->fragmentBuffer = m_pApp->CreateBuffer(sizeof(FragmentUBO));
 
 	// Create the object
-	std::vector<EEObjectResourceBinding> bindings(3);
+	std::vector<EEObjectResourceBinding> bindings(4);
 	bindings[0].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	bindings[0].binding = 0u;
 	bindings[0].resource = pText->vertexBuffer;
@@ -309,6 +280,10 @@ GFX::EEText GFX::EEFontEngine::RenderText(EEFont font, EEstring const& text, EEP
 	bindings[2].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	bindings[2].binding = 2u;
 	bindings[2].resource = pText->fragmentBuffer;
+
+	bindings[3].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	bindings[3].binding = 3u;
+	bindings[3].resource = m_pApp->AcquireCameraBuffer2D();
 	pText->object = m_pApp->CreateObject(m_shader, pText->mesh, bindings);
 
 	// Initialize fragment buffer
@@ -319,6 +294,7 @@ GFX::EEText GFX::EEFontEngine::RenderText(EEFont font, EEstring const& text, EEP
   glm::vec3 translation{-(wExtent.width / 2.0f) + pText->position.x, -(wExtent.height / 2.0f) + pText->position.y, 0.0f};
   pText->world = glm::scale(scale);
   pText->world *= glm::translate(translation);
+	pText->worldChanged = true;
 
 	// Store the created text details and its index/handle
 	EE_INVARIANT(m_currentTexts.size() == m_iCurrentTexts.size());
@@ -368,6 +344,16 @@ void GFX::EEFontEngine::ReleaseText(EEText& text)
 }
 
 EEBool32 GFX::EEFontEngine::ChangeText(EEText text, EEstring const& newText)
+{
+	if (!text) {
+		EE_PRINT("[EEFONTENGINE] Text handle that was passed into ChangeText was nullptr!\n");
+		return EE_FALSE;
+	}
+
+	return ChangeText(text, newText, m_currentTexts[*text]->wrapDim);
+}
+
+EEBool32 GFX::EEFontEngine::ChangeText(EEText text, EEstring const& newText, EERect32F const& wrapDim)
 {
 	if (!text) {
 		EE_PRINT("[EEFONTENGINE] Text handle that was passed into ChangeText was nullptr!\n");
@@ -376,18 +362,67 @@ EEBool32 GFX::EEFontEngine::ChangeText(EEText text, EEstring const& newText)
 	
 	EEInternText* pText = m_currentTexts[*text];
 
-	// Compute new mesh
-	std::vector<VertexInput> vertices;
-	std::vector<uint32_t> indices;
-	ComputeMeshAccToFont(pText->pFont, newText, vertices, indices, pText->maxTextDimensions);
+	// Find the first character that differs, everything before can be kept. If the wrap
+	// dimensions changed every line can change so the whole text is layed out again
+	size_t firstChar{ 0u };
+	if (wrapDim.width == pText->wrapDim.width && wrapDim.height == pText->wrapDim.height) {
+		size_t commonSize{ MIN(pText->text.size(), newText.size()) };
+		while (firstChar < commonSize && pText->text[firstChar] == newText[firstChar]) firstChar++;
 
-	m_pApp->UpdateMesh(pText->mesh, vertices.data(), sizeof(VertexInput) * vertices.size(), indices);
+		if (firstChar == pText->text.size() && firstChar == newText.size()) return EE_TRUE; //< Nothing changed
+	} else {
+		pText->wrapDim = wrapDim;
+	}
 
-	return EE_TRUE;
+	return ReplaceTextRange(text, firstChar, pText->text.size() - firstChar, newText.substr(firstChar));
+}
+
+EEBool32 GFX::EEFontEngine::AppendText(EEText text, EEstring const& suffix)
+{
+	if (!text) {
+		EE_PRINT("[EEFONTENGINE] Text handle that was passed into AppendText was nullptr!\n");
+		return EE_FALSE;
+	}
+
+	return ReplaceTextRange(text, m_currentTexts[*text]->text.size(), 0u, suffix);
+}
+
+EEBool32 GFX::EEFontEngine::EraseTextTail(EEText text, size_t count)
+{
+	if (!text) {
+		EE_PRINT("[EEFONTENGINE] Text handle that was passed into EraseTextTail was nullptr!\n");
+		return EE_FALSE;
+	}
+
+	size_t textSize = m_currentTexts[*text]->text.size();
+	count = MIN(count, textSize);
+	return ReplaceTextRange(text, textSize - count, count, EEstring());
+}
+
+EEBool32 GFX::EEFontEngine::ReplaceTextRange(EEText text, size_t first, size_t count, EEstring const& replacement)
+{
+	if (!text) {
+		EE_PRINT("[EEFONTENGINE] Text handle that was passed into ReplaceTextRange was nullptr!\n");
+		return EE_FALSE;
+	}
+
+	EEInternText* pText = m_currentTexts[*text];
+	if (first > pText->text.size()) {
+		EE_PRINT("[EEFONTENGINE] Tried to replace a range that starts behind the end of the text!\n");
+		return EE_FALSE;
+	}
+
+	// Every quad before the first changed quad stays untouched
+	pText->text.replace(first, count, replacement);
+	uint32_t firstQuad = ComputeMeshAccToFont(pText, first);
+
+	return UploadTextMesh(pText, firstQuad);
 }
 
 EEstring GFX::EEFontEngine::WrapText(EEFont font, EEstring const& text, float size, EERect32F const& wrapDim) const
 {
+	EE_PROFILE_SCOPE("EEFontEngine::WrapText");
+
 	if (wrapDim.width < size || wrapDim.height < size) {
 		EE_PRINT("[EEFONTENGINE] Choose bigger wrap dimensions, at least > than passed in size!\n");
 		return text;
@@ -397,54 +432,52 @@ EEstring GFX::EEFontEngine::WrapText(EEFont font, EEstring const& text, float si
 	EEInternFont* pFont = m_currentFonts[*font];
 	assert(pFont);
 
-	float maxWidth		 { (float)wrapDim.width },
-				maxHeight		 { (float)wrapDim.height },
-				currentSpaceX{ maxWidth },
-				currentSpaceY{ maxHeight };
-	
-	EEstring output(text);
+	// Layout without generating any quads, just let it write out the wrapped text
+	std::vector<LayoutCursor> cursors(1, { 0.0f, 0.0f, 0.0f, 0u });
+	EEstring output;
+	output.reserve(text.size());
+	LayoutText(pFont, text, 0u, { wrapDim.width / size, wrapDim.height / size }, cursors, nullptr, &output);
 
-	for (size_t i = 0u; i < text.size(); i++) {
+	return output;
+}
 
-		// Check first for special characters
-		if (text[i] == '\n') {
-			currentSpaceX = maxWidth;
-			currentSpaceY -= ABS_LETTER_HEIGHT * size;
-
-		} else if(text[i] == ' ') {
-			currentSpaceX -= SPACE_DISTANCE * size;
-
-		// no special character so get the font-dependent letter information
-		// @note if this character was not defined when creating the font, the function will return
-		//			 the passed in std string.
-		} else {
-			try {
-				currentSpaceX -= size * pFont->letterDetails.at(text[i]).width / pFont->maxLetterWidth;
-			} catch (std::out_of_range oor) {
-				EE_PRINTA("[EEFONTENGINE] Invalid character! The desired text contains at least one character that was not defined in the charset of the font.\n%s\n", oor.what());
-#if defined(_DEBUG)
-				EE::tools::warning("[EEFONTENGINE] Invalid character! The desired text contains at least one character that was not defined in the charset of the font.\n");
-#endif
-				continue;
-			}
-		}
-		
-		//EE_PRINT("%s :: %f, %f\n", &text[i], currentSpaceX, currentSpaceY);
+EERect32F GFX::EEFontEngine::LayoutGlyphs(EEFont font, EEstring const& text, float size, EERect32F const& wrapDim,
+	std::vector<VertexInput>& verticesOut) const
+{
+	if (!font) {
+		EE_PRINT("[EEFONTENGINE] Font handle that was passed into LayoutGlyphs was nullptr!\n");
+		return EERect32F();
+	}
+	EEInternFont* pFont = m_currentFonts[*font];
+	assert(pFont);
 
-		if (currentSpaceX < 0.0f) {
-			i -= InsertLineBreak(output, i);
-			currentSpaceX = maxWidth;
-			currentSpaceY -= ABS_LETTER_HEIGHT * size;
-		}
-		// Check if there is still space for another line
-		if (currentSpaceY < ABS_LETTER_HEIGHT * size) {
-			output.erase(output.begin() + i, output.end());
-			break;
-		}
+	// Wrap dimensions are passed in in pixels but the layout is done in letter units
+	EERect32F unitWrapDim{ -1.0f, -1.0f };
+	if (wrapDim.width >= size && wrapDim.height >= size) {
+		unitWrapDim = { wrapDim.width / size, wrapDim.height / size };
 	}
 
+	std::vector<LayoutCursor> cursors(1, { 0.0f, 0.0f, 0.0f, 0u });
+	cursors.reserve(text.size() + 1);
+	verticesOut.clear();
+	LayoutText(pFont, text, 0u, unitWrapDim, cursors, &verticesOut, nullptr);
 
-	return output;
+	LayoutCursor const& cursor = LAST_ELEMENT(cursors);
+	EERect32F dimensions{ MAX(cursor.maxWidth, cursor.penX), cursor.penY + ABS_LETTER_HEIGHT };
+	if (unitWrapDim.height > 0.0f && dimensions.height > unitWrapDim.height) {
+		dimensions.height = cursor.penY; //< Last line got cut off
+	}
+
+	return { size * dimensions.width, size * dimensions.height };
+}
+
+EETexture GFX::EEFontEngine::GetFontTexture(EEFont font) const
+{
+	if (!font) {
+		EE_PRINT("[EEFONTENGINE] Font handle that was passed into GetFontTexture was nullptr!\n");
+		return nullptr;
+	}
+	return m_currentFonts[*font]->texture;
 }
 
 void GFX::EEFontEngine::ChangeTextColor(EEText text, EEColor const& newColor)
@@ -473,6 +506,7 @@ void GFX::EEFontEngine::SetTextPosition(EEText text, EEPoint32F const& pos)
 	handle->position = pos;
   handle->world = glm::scale(glm::vec3(handle->size, handle->size, 1.0f));
   handle->world *= glm::translate(glm::vec3(-(wExtent.width / 2.0f) + handle->position.x, -(wExtent.height / 2.0f) + handle->position.y, 0.0f));
+	handle->worldChanged = true;
 }
 
 void GFX::EEFontEngine::SetCharacterSize(EEText text, float charSize)
@@ -481,17 +515,18 @@ void GFX::EEFontEngine::SetCharacterSize(EEText text, float charSize)
 	// TODO
 }
 
-void GFX::EEFontEngine::Update() const
+void GFX::EEFontEngine::Update()
 {
-	// Fragment buffer gets updated if changed for the vertex buffer we do not
-	// know when the ortho/baseView matrix may have changed so we update it every frame
+	// Fragment buffer gets updated if changed and the ortho/baseView matrix is in the shared
+	// camera buffer that is kept uptodate on resize, so only moved texts need an upload
 	VertexUBO vertUbo;
-  vertUbo.ortho = m_pApp->AcquireOrthoMatrixLH();
-  vertUbo.baseView = m_pApp->AcquireBaseViewLH();
-
 	for (size_t i = 0u; i < m_currentTexts.size(); i++) {
+		if (!m_currentTexts[i]->worldChanged) continue;
+
 		vertUbo.world = m_currentTexts[i]->world;
 		m_pApp->UpdateBuffer(m_currentTexts[i]->vertexBuffer, &vertUbo);
+		m_pApp->SetObjectWorld(m_currentTexts[i]->object, vertUbo.world);
+		m_currentTexts[i]->worldChanged = false;
 	}
 }
 
@@ -513,83 +548,418 @@ EERect32F GFX::EEFontEngine::GetTextDimensions(EEText text)
 	return m_pApp;
 }
 
-EEBool32 GFX::EEFontEngine::ComputeMeshAccToFont(EEInternFont* pFont, EEstring const& text,
-	std::vector<VertexInput>& vertices, std::vector<uint32_t>& indices, EERect32F& maxTextDims)
+void GFX::EEFontEngine::EnableFontCache(char const* directory)
+{
+	m_fontCacheDir = (directory) ? directory : "";
+}
+
+EEBool32 GFX::EEFontEngine::RasterizeFont(char const* fileName, EEcstr charSet, EEInternFont* pFont, std::vector<unsigned char>& imageOut)
+{
+	// Read in the font file using the free type library
+	FT_Error error = FT_New_Face(m_library, fileName, 0, &pFont->face);
+	if (error == FT_Err_Unknown_File_Format) {
+		EE_PRINT("[EEFONTENGINE] The font file could not be opened. Its format is probably not supported by freetype!\n");
+		EE::tools::warning("[EEFONTENGINE] The font file could not be opened. Its format is probably not supported by freetype!\n");
+		return EE_FALSE;
+	} else if (error) { //< some other error
+		EE_PRINT("[EEFONTENGINE] Could not read in font file!\n");
+		EE::tools::warning("[EEFONTENGINE] Could not read in font file!\n");
+		return EE_FALSE;
+	}
+
+	// Set the size of the font face
+	error = FT_Set_Pixel_Sizes(pFont->face, FONT_PIXEL_WIDTH, FONT_PIXEL_HEIGHT);
+	if (error) {
+		FT_Done_Face(pFont->face);
+		pFont->face = nullptr;
+		EE_PRINT("[EEFONTENGINE] Failed to set up font (size)!\n");
+		EE::tools::warning("[EEFONTENGINE] Failed to set up font (size)!\n");
+		return EE_FALSE;
+	}
+
+	// Acquire informations about the passed in character set
+	size_t numChars = EE_STRLEN(charSet);
+	uint32_t fontImgWidth{ 0u }, fontImgHeight{ 0u };
+	uint32_t maxTopBearingY{ 0u }, maxBelowBearingY{ 0u };
+
+	// Free type faces must not be used by several threads at once, so every job gets its own face.
+	// The faces are created here since opening/closing faces of the same library is not thread safe either
+	CORETOOLS::JobSystem& jobSystem = CORETOOLS::JobSystem::Shared();
+	size_t amountJobs = MAX(size_t(1u), MIN(size_t(jobSystem.GetAmountThreads()), numChars / MIN_GLYPHS_PER_JOB));
+	std::vector<FT_Face> faces(1, pFont->face);
+	for (size_t i = 1u; i < amountJobs; i++) {
+		FT_Face face;
+		if (FT_New_Face(m_library, fileName, 0, &face)) break;
+		if (FT_Set_Pixel_Sizes(face, FONT_PIXEL_WIDTH, FONT_PIXEL_HEIGHT)) {
+			FT_Done_Face(face);
+			break;
+		}
+		faces.push_back(face);
+	}
+
+	// Rasterize every glyph exactly once, every job takes every n-th character with its own face
+	std::vector<RasterizedGlyph> glyphs(numChars);
+	jobSystem.ParallelFor(uint32_t(faces.size()), 1u, [&faces, &glyphs, charSet, numChars](uint32_t j) {
+		RasterizeGlyphs(faces[j], charSet, numChars, j, faces.size(), glyphs.data());
+	});
+
+	for (size_t i = 1u; i < faces.size(); i++) FT_Done_Face(faces[i]);
+
+	// Initialize fonts' max values so the checks during the loop can be made
+	pFont->maxLetterWidth = 0u;
+
+	uint32_t letterWidth;
+	for (size_t i = 0u; i < numChars; i++) {
+		RasterizedGlyph const& glyph = glyphs[i];
+		if (!glyph.isValid) continue;
+
+		// Store informations about the position of this character in the final image for the shader
+		letterWidth = glyph.width + MAX(0, 2*glyph.left);
+		pFont->letterDetails[charSet[i]] = {
+			fontImgWidth,
+			letterWidth,
+			glyph.rows,
+			uint32_t(MAX(0, glyph.left)),
+			uint32_t(MAX(0, glyph.top))
+		};
+
+		// Update the final font image dimensions
+		pFont->maxLetterWidth = MAX(letterWidth, pFont->maxLetterWidth);
+		fontImgWidth += letterWidth;
+		maxTopBearingY = MAX(uint32_t(MAX(0, glyph.top)), maxTopBearingY);
+		maxBelowBearingY = MAX(glyph.rows - MIN(glyph.rows, uint32_t(MAX(0, glyph.top))), maxBelowBearingY);
+	}
+
+	fontImgHeight = maxTopBearingY + maxBelowBearingY;
+
+	// We got the informations now we can allocate memory and fill it with the image data
+	std::vector<unsigned char>& fontImageData = imageOut;
+	fontImageData.assign(size_t(fontImgWidth) * fontImgHeight, 0u);
+	Letter curLetter; //< Stores the current letter to write
+	for (size_t i = 0u; i < numChars; i++) {
+		RasterizedGlyph const& glyph = glyphs[i];
+		if (!glyph.isValid || !glyph.width) continue;
+
+		// We dont need a try catch since we know it was added before (same charset)
+		curLetter = pFont->letterDetails[charSet[i]];
+
+		// Write the image data of the character row by row to the correct position in the final fontImageData
+		for (uint32_t y = 0u; y < glyph.rows; y++) {
+			memcpy(&fontImageData[(y + maxTopBearingY - curLetter.bearingY) * fontImgWidth + curLetter.offsetX + curLetter.bearingX],
+						 &glyph.pixels[y * glyph.width], glyph.width);
+		}
+	}
+
+	// Store the texture size
+	pFont->width = fontImgWidth;
+	pFont->height = fontImgHeight;
+
+	return EE_TRUE;
+}
+
+std::string GFX::EEFontEngine::FontCacheFileName(char const* fileName, EEcstr charSet) const
+{
+	EE::tools::MappedFile fontFile;
+	if (!EE::tools::mapFile(fileName, fontFile)) return std::string();
+
+	// The key covers the font file content, everything that changes the rasterization and the charset
+	uint32_t pixelSizes[3]{ FONT_PIXEL_WIDTH, FONT_PIXEL_HEIGHT, uint32_t(sizeof(EEchar)) };
+	uint64_t key = EE::tools::hashData(fontFile.pData, fontFile.size);
+	key = EE::tools::hashData(pixelSizes, sizeof(pixelSizes), key);
+	key = EE::tools::hashData(charSet, sizeof(EEchar) * EE_STRLEN(charSet), key);
+	EE::tools::unmapFile(fontFile);
+
+	char keyString[17];
+	snprintf(keyString, sizeof(keyString), "%016llx", (unsigned long long)key);
+	return m_fontCacheDir + "/" + keyString + ".eefont";
+}
+
+unsigned char const* GFX::EEFontEngine::ReadFontCache(EE::tools::MappedFile const& cacheFile, EEcstr charSet, EEInternFont* pFont) const
+{
+	unsigned char const* pBytes = static_cast<unsigned char const*>(cacheFile.pData);
+	if (cacheFile.size < sizeof(FontCacheHeader)) return nullptr;
+
+	// Validate the header before trusting any size stored in it
+	FontCacheHeader header;
+	memcpy(&header, pBytes, sizeof(FontCacheHeader));
+	size_t numChars = EE_STRLEN(charSet);
+	if (header.magic != FONT_CACHE_MAGIC || header.version != FONT_CACHE_VERSION
+			|| header.pixelWidth != FONT_PIXEL_WIDTH || header.pixelHeight != FONT_PIXEL_HEIGHT
+			|| header.charSize != sizeof(EEchar) || header.numChars != numChars
+			|| header.charSetHash != EE::tools::hashData(charSet, sizeof(EEchar) * numChars)
+			|| header.numLetters > numChars
+			|| cacheFile.size != sizeof(FontCacheHeader) + sizeof(FontCacheLetter) * header.numLetters
+													 + size_t(header.width) * header.height) {
+		EE_PRINT("[EEFONTENGINE] Font cache file is invalid or outdated, rasterizing the font again!\n");
+		return nullptr;
+	}
+
+	FontCacheLetter cacheLetter;
+	for (uint32_t i = 0u; i < header.numLetters; i++) {
+		memcpy(&cacheLetter, pBytes + sizeof(FontCacheHeader) + sizeof(FontCacheLetter) * i, sizeof(FontCacheLetter));
+
+		// Every glyph rectangle has to lie inside the atlas, otherwise the texts would sample outside of it
+		Letter const& letter = cacheLetter.letter;
+		if (uint64_t(letter.offsetX) + letter.width > header.width || letter.height > header.height
+				|| letter.width > header.maxLetterWidth) {
+			EE_PRINT("[EEFONTENGINE] Font cache file contains a glyph outside of the atlas, rasterizing the font again!\n");
+			return nullptr;
+		}
+		pFont->letterDetails[EEchar(cacheLetter.character)] = cacheLetter.letter;
+	}
+	pFont->width = header.width;
+	pFont->height = header.height;
+	pFont->maxLetterWidth = header.maxLetterWidth;
+
+	// The pixels are uploaded straight from the mapping
+	return pBytes + sizeof(FontCacheHeader) + sizeof(FontCacheLetter) * header.numLetters;
+}
+
+void GFX::EEFontEngine::WriteFontCache(char const* cacheFileName, EEcstr charSet, EEInternFont const* pFont, unsigned char const* pImageData) const
+{
+	size_t numChars = EE_STRLEN(charSet);
+
+	FontCacheHeader header{};
+	header.magic = FONT_CACHE_MAGIC;
+	header.version = FONT_CACHE_VERSION;
+	header.pixelWidth = FONT_PIXEL_WIDTH;
+	header.pixelHeight = FONT_PIXEL_HEIGHT;
+	header.charSize = uint32_t(sizeof(EEchar));
+	header.numChars = uint32_t(numChars);
+	header.numLetters = uint32_t(pFont->letterDetails.size());
+	header.width = pFont->width;
+	header.height = pFont->height;
+	header.maxLetterWidth = pFont->maxLetterWidth;
+	header.charSetHash = EE::tools::hashData(charSet, sizeof(EEchar) * numChars);
+
+	std::ofstream file(cacheFileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		EE_PRINTA("[EEFONTENGINE] Failed to write font cache file %s!\n", cacheFileName);
+		return;
+	}
+
+	file.write(reinterpret_cast<char const*>(&header), sizeof(FontCacheHeader));
+	for (auto const& letter : pFont->letterDetails) {
+		FontCacheLetter cacheLetter{ uint32_t(letter.first), letter.second };
+		file.write(reinterpret_cast<char const*>(&cacheLetter), sizeof(FontCacheLetter));
+	}
+	file.write(reinterpret_cast<char const*>(pImageData), std::streamsize(size_t(pFont->width) * pFont->height));
+
+	if (!file.good()) {
+		file.close();
+		std::remove(cacheFileName); //< Never leave a half written cache behind
+		EE_PRINTA("[EEFONTENGINE] Failed to write font cache file %s!\n", cacheFileName);
+	}
+}
+
+void GFX::EEFontEngine::RasterizeGlyphs(FT_Face face, EEcstr charSet, size_t numChars, size_t first, size_t step, RasterizedGlyph* pGlyphsOut)
+{
+	FT_GlyphSlot slot = face->glyph;
+	for (size_t i = first; i < numChars; i += step) {
+		RasterizedGlyph& glyph = pGlyphsOut[i];
+		glyph.isValid = false;
+
+		if (FT_Load_Glyph(face, FT_Get_Char_Index(face, charSet[i]), FT_LOAD_DEFAULT)) continue;
+		if (FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL)) continue;
+
+		glyph.width = slot->bitmap.width;
+		glyph.rows = slot->bitmap.rows;
+		glyph.left = slot->bitmap_left;
+		glyph.top = slot->bitmap_top;
+
+		// The bitmap is only valid till the next glyph is loaded, so copy it tightly packed
+		// (the pitch of the free type bitmap can be bigger than its width)
+		glyph.pixels.resize(size_t(glyph.width) * glyph.rows);
+		for (uint32_t y = 0u; y < glyph.rows; y++) {
+			memcpy(&glyph.pixels[y * glyph.width], slot->bitmap.buffer + y * slot->bitmap.pitch, glyph.width);
+		}
+
+		glyph.isValid = true;
+	}
+}
+
+uint32_t GFX::EEFontEngine::ComputeMeshAccToFont(EEInternText* pText, size_t firstChar)
+{
+	EE_PROFILE_SCOPE("EEFontEngine::ComputeMeshAccToFont");
+
+	// Wrap dimensions are passed in in pixels but the layout is done in letter units
+	EERect32F wrapDim{ -1.0f, -1.0f };
+	if (pText->wrapDim.width >= pText->size && pText->wrapDim.height >= pText->size) {
+		wrapDim = { pText->wrapDim.width / pText->size, pText->wrapDim.height / pText->size };
+	} else if (pText->wrapDim.width > 0.0f || pText->wrapDim.height > 0.0f) {
+		EE_PRINT("[EEFONTENGINE] Choose bigger wrap dimensions, at least > than the text size! Text won't be wrapped.\n");
+	}
+
+	// A word is always placed as a whole, so if it is wrapped the layout needs to resume at its beginning
+	if (wrapDim.width > 0.0f) {
+		while (firstChar > 0u && pText->text[firstChar - 1] != ' ' && pText->text[firstChar - 1] != '\n') firstChar--;
+	}
+
+	// Resume at the state before the first changed character and throw away everything behind it
+	pText->cursors.resize(firstChar + 1);
+	pText->cursors.reserve(pText->text.size() + 1);
+	uint32_t firstQuad = pText->cursors[firstChar].quadCount;
+	pText->vertices.resize(QUAD_VERTICES * firstQuad);
+
+	LayoutText(pText->pFont, pText->text, firstChar, wrapDim, pText->cursors, &pText->vertices, nullptr);
+
+	LayoutCursor const& cursor = LAST_ELEMENT(pText->cursors);
+	pText->maxTextDimensions.width = MAX(cursor.maxWidth, cursor.penX); //< Also check if last (or only) line is biggest
+	pText->maxTextDimensions.height = cursor.penY + ABS_LETTER_HEIGHT; //< We won't make a new line
+	if (wrapDim.height > 0.0f && pText->maxTextDimensions.height > wrapDim.height) {
+		pText->maxTextDimensions.height = cursor.penY; //< Last line got cut off
+	}
+
+	return firstQuad;
+}
+
+void GFX::EEFontEngine::LayoutText(EEInternFont* pFont, EEstring const& text, size_t firstChar, EERect32F const& wrapDim,
+	std::vector<LayoutCursor>& cursors, std::vector<VertexInput>* pVerticesOut, EEstring* pWrappedOut) const
 {
 	// Settings of the per letter dimensions
-	float letterWidth{ 1.0f }, letterHeight{ ABS_LETTER_HEIGHT }, letterSpacing{ 1.0f }, penX{ 0.0f }, penY{ 0.0f };
-	maxTextDims = { 0.0f, 0.0f }; //< Initialize to zero so the max check works correctly
+	float letterWidth{ 1.0f }, letterHeight{ ABS_LETTER_HEIGHT };
+	bool wrapLines{ wrapDim.width > 0.0f && wrapDim.height > 0.0f };
+	bool invalidChar{ false };
+
+	LayoutCursor cursor = cursors[firstChar];
+	Letter const* pLetter; //< Stores the letter for each loop iteration (nullptr for special characters)
+	for (size_t i = firstChar; i < text.size(); i++) {
+
+		// Special characters have no letter in the font. Characters that were not declared in the charset are skipped
+		pLetter = nullptr;
+		if (text[i] != '\n' && text[i] != ' ') {
+			auto it = pFont->letterDetails.find(text[i]);
+			if (it != pFont->letterDetails.end()) pLetter = &(it->second);
+			else invalidChar = true;
+		}
 
+		// At the start of a word check if the whole word still fits into this line, otherwise it begins
+		// a new one. Inside of a word we only need to break if the word alone is longer than a whole line
+		if (wrapLines && pLetter && cursor.penX > 0.0f) {
+			letterWidth = (float)pLetter->width / pFont->maxLetterWidth;
+			bool wordStart{ i == 0u || text[i - 1] == ' ' || text[i - 1] == '\n' };
+			if (cursor.penX + ((wordStart) ? MeasureWord(pFont, text, i) : letterWidth) > wrapDim.width) {
+				cursor.maxWidth = MAX(cursor.maxWidth, cursor.penX);
+				cursor.penY += letterHeight;
+				cursor.penX = 0.0f;
+
+				// The space in front of the word becomes the line break
+				if (pWrappedOut) {
+					if (!pWrappedOut->empty() && pWrappedOut->back() == ' ') pWrappedOut->back() = '\n';
+					else pWrappedOut->push_back('\n');
+				}
+			}
+		}
 
-	Letter curLetter; //< Stored the letter for each loop iteration
-	uint32_t topLeftIndex, topRightIndex, bottomRightIndex, bottomLeftIndex; //< Stores the current indices
-	for (size_t i = 0u; i < text.size(); i++) {
+		// Everything that does not fit into the height anymore is cut off
+		if (wrapLines && cursor.penY + letterHeight > wrapDim.height) {
+			if (pWrappedOut && !pWrappedOut->empty() && pWrappedOut->back() == '\n') pWrappedOut->pop_back();
+			cursors.resize(text.size() + 1, cursor);
+			break;
+		}
 
-		// Handle first special characters, but for every else character use the font
 		if (text[i] == '\n') {
 			// New line means this is as big as it gets with this line
 			// so store the width if it is new maximum. Then reset penX  
 			// and increase penY to indicate thew new line
-			maxTextDims.width = MAX(maxTextDims.width, penX);
-			penY += letterHeight;
-			penX = 0.0f;
+			cursor.maxWidth = MAX(cursor.maxWidth, cursor.penX);
+			cursor.penY += letterHeight;
+			cursor.penX = 0.0f;
 
-			continue;
 		} else if (text[i] == ' ') {
-			penX += SPACE_DISTANCE;
-			continue;
-		}
+			cursor.penX += SPACE_DISTANCE;
+
+		} else if (pLetter) {
+			letterWidth = (float)pLetter->width / pFont->maxLetterWidth;
+			if (pVerticesOut) {
+				// TOP LEFT, BOTTOM LEFT, TOP RIGHT, BOTTOM RIGHT (see ComputeCapacityMesh for the indices)
+				pVerticesOut->push_back({ {cursor.penX, cursor.penY}, {float(pLetter->offsetX), 0.0f} });
+				pVerticesOut->push_back({ {cursor.penX, cursor.penY + letterHeight}, {float(pLetter->offsetX), float(pFont->height)} });
+				pVerticesOut->push_back({ {cursor.penX + letterWidth, cursor.penY}, {float(pLetter->offsetX + pLetter->width), 0.0f} });
+				pVerticesOut->push_back({ {cursor.penX + letterWidth, cursor.penY + letterHeight}, {float(pLetter->offsetX + pLetter->width), float(pFont->height)} });
+				cursor.quadCount++;
+			}
 
-		// Try to get the desired characters' details. std::map::at throws outofrange exception
-		// if the character was not defined as a key in the map
-		try {
-			curLetter = pFont->letterDetails.at(text[i]);
-		} catch (std::out_of_range const& oor) {
-			EE_PRINTA("[EEFONTENGINE] Invalid character! The desired text contains at least on character that was not defined in the charset of the font.\n%s\n", oor.what());
-			EE::tools::warning("[EEFONTENGINE] Invalid character! The desired text containts at least on characters that was not defined in the charset of the font.\n");
-			continue;
+			// Shift pen position by the current letterwidth
+			cursor.penX += letterWidth;
 		}
 
-		letterWidth = (float)curLetter.width / pFont->maxLetterWidth;
-		// TOP LEFT
-		vertices.push_back({ {penX, penY}, {float(curLetter.offsetX), 0.0f} });
-		topLeftIndex = uint32_t(vertices.size() - 1);
-
-		// BOTTOM LEFT
-		vertices.push_back({ {penX, penY + letterHeight}, {float(curLetter.offsetX), float(pFont->height)} });
-		bottomLeftIndex = uint32_t(vertices.size() - 1);
-
-		// TOP RIGHT
-		vertices.push_back({ {penX + letterWidth, penY}, {float(curLetter.offsetX + curLetter.width), 0.0f} });
-		topRightIndex = uint32_t(vertices.size() - 1);
+		if (pWrappedOut && (pLetter || text[i] == '\n' || text[i] == ' ')) pWrappedOut->push_back(text[i]);
 
-		// BOTTOM RIGHT
-		vertices.push_back({ {penX + letterWidth, penY + letterHeight}, {float(curLetter.offsetX + curLetter.width), float(pFont->height)} });
-		bottomRightIndex = uint32_t(vertices.size() - 1);
+		// Store the state after this character which is the state before the next one
+		cursors.push_back(cursor);
+	}
 
-		// Push back the indices in clockwise order
-		indices.push_back(topLeftIndex);
-		indices.push_back(topRightIndex);
-		indices.push_back(bottomRightIndex);
-		indices.push_back(topLeftIndex);
-		indices.push_back(bottomRightIndex);
-		indices.push_back(bottomLeftIndex);
+	if (invalidChar) {
+		EE_PRINT("[EEFONTENGINE] Invalid character! The desired text contains at least one character that was not defined in the charset of the font.\n");
+		EE::tools::warning("[EEFONTENGINE] Invalid character! The desired text contains at least one character that was not defined in the charset of the font.\n");
+	}
+}
 
-		// Shift pen position by the current letterwidth
-		penX += letterWidth;
+float GFX::EEFontEngine::MeasureWord(EEInternFont* pFont, EEstring const& text, size_t first) const
+{
+	size_t last{ first };
+	while (last < text.size() && text[last] != ' ' && text[last] != '\n') last++;
+
+	// Widths are in letter units, so one entry is valid for every text size
+	EEstring word(text, first, last - first);
+	auto cached = pFont->wordWidths.find(word);
+	if (cached != pFont->wordWidths.end()) return cached->second;
+
+	float width{ 0.0f };
+	for (size_t i = first; i < last; i++) {
+		auto it = pFont->letterDetails.find(text[i]);
+		if (it != pFont->letterDetails.end()) width += (float)it->second.width / pFont->maxLetterWidth;
 	}
 
-	maxTextDims.width = MAX(maxTextDims.width, penX); //< Also check if last (or only) line is biggest
-	maxTextDims.height = penY + letterHeight; //< We won't make a new line
+	// Typed texts would let the cache grow forever, so just start over when it got too big
+	if (pFont->wordWidths.size() >= MAX_CACHED_WORDS) pFont->wordWidths.clear();
+	pFont->wordWidths.emplace(std::move(word), width);
 
-	return EE_TRUE;
+	return width;
+}
+
+void GFX::EEFontEngine::ComputeCapacityMesh(EEInternText const* pText,
+	std::vector<VertexInput>& vertices, std::vector<uint32_t>& indices) const
+{
+	vertices = pText->vertices;
+	vertices.resize(QUAD_VERTICES * pText->quadCapacity, { {0.0f, 0.0f}, {0.0f, 0.0f} });
+
+	// Every quad got its vertices pushed back as TL, BL, TR, BR so the indices are just this
+	// pattern in clockwise order, shifted by four per quad
+	indices.resize(QUAD_INDICES * pText->quadCapacity);
+	for (uint32_t q = 0u; q < pText->quadCapacity; q++) {
+		uint32_t base = QUAD_VERTICES * q;
+		indices[QUAD_INDICES * q + 0] = base + 0u; //< top left
+		indices[QUAD_INDICES * q + 1] = base + 2u; //< top right
+		indices[QUAD_INDICES * q + 2] = base + 3u; //< bottom right
+		indices[QUAD_INDICES * q + 3] = base + 0u; //< top left
+		indices[QUAD_INDICES * q + 4] = base + 3u; //< bottom right
+		indices[QUAD_INDICES * q + 5] = base + 1u; //< bottom left
+	}
 }
 
-int GFX::EEFontEngine::InsertLineBreak(EEstring& text, size_t index) const
+EEBool32 GFX::EEFontEngine::UploadTextMesh(EEInternText* pText, uint32_t firstQuad)
 {
-	size_t tempIndex{ index };
-	while (index > 1 && text[index] != ' ') index--;
-	text.replace(index, 1, STR("\n"));
-	return (int)(tempIndex - index);
+	uint32_t quadCount = LAST_ELEMENT(pText->cursors).quadCount;
+
+	// Try to just upload the changed quads into the spare capacity
+	if (quadCount <= pText->quadCapacity) {
+		size_t offset = sizeof(VertexInput) * QUAD_VERTICES * firstQuad;
+		size_t size = sizeof(VertexInput) * QUAD_VERTICES * (quadCount - MIN(firstQuad, quadCount));
+		if (m_pApp->UpdateMeshRange(pText->mesh, (size) ? &pText->vertices[QUAD_VERTICES * firstQuad] : nullptr,
+																offset, size, QUAD_INDICES * quadCount)) {
+			return EE_TRUE;
+		}
+	}
+
+	// Capacity exceeded so grow geometrically, this way typing only reallocates every now and then
+	pText->quadCapacity = MAX(2u * pText->quadCapacity, quadCount);
+	std::vector<VertexInput> vertices;
+	std::vector<uint32_t> indices;
+	ComputeCapacityMesh(pText, vertices, indices);
+	m_pApp->UpdateMesh(pText->mesh, vertices.data(), sizeof(VertexInput) * vertices.size(), indices);
+
+	return (m_pApp->UpdateMeshRange(pText->mesh, nullptr, 0u, 0u, QUAD_INDICES * quadCount)) ? EE_TRUE : EE_FALSE;
 }
 
@@ -11,6 +11,8 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 /////////////////
@@ -22,6 +24,7 @@
 // FOREWARD DECLARATIONS //
 ///////////////////////////
 class EEApplication;
+namespace EE { namespace tools { struct MappedFile; } }
 
 namespace GFX
 {
@@ -30,17 +33,16 @@ namespace GFX
 
 	class EEFontEngine
 	{
-	private:
+	public:
 		/* @brief [ShaderSpecific] Holds the shader input values per vertex */
 		struct VertexInput {
 			glm::vec2 position;
 			glm::vec2 texCoord;
 		};
 
-		/* @brief [ShaderSpecific; binding=0] Holds the content of the vertex ubo */
+	private:
+		/* @brief [ShaderSpecific; binding=0] Holds the content of the vertex ubo (ortho/base view are in the shared camera buffer at binding=3) */
 		struct VertexUBO {
-			glm::mat4 ortho;
-			glm::mat4 baseView;
 			glm::mat4 world;
 		};
 
@@ -58,6 +60,37 @@ namespace GFX
 			uint32_t bearingY;
 		};
 
+		/* @brief Holds the bitmap and metrics of a glyph rendered by free type */
+		struct RasterizedGlyph {
+			std::vector<unsigned char> pixels;
+			uint32_t width;
+			uint32_t rows;
+			int left;
+			int top;
+			bool isValid;
+		};
+
+		/* @brief Header of a baked font cache file, followed by the letters and the atlas pixels */
+		struct FontCacheHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t pixelWidth;
+			uint32_t pixelHeight;
+			uint32_t charSize;
+			uint32_t numChars;
+			uint32_t numLetters;
+			uint32_t width;
+			uint32_t height;
+			uint32_t maxLetterWidth;
+			uint64_t charSetHash;
+		};
+
+		/* @brief A letter as it is stored in a baked font cache file */
+		struct FontCacheLetter {
+			uint32_t character;
+			Letter letter;
+		};
+
 		/* @brief Holds informations of a specific font that is necessary to render a text */
 		struct EEInternFont {
 			FT_Face face;
@@ -66,6 +99,16 @@ namespace GFX
 			uint32_t height;
 			std::map<EEchar, Letter> letterDetails;
 			uint32_t maxLetterWidth;
+			/* @brief Widths of already measured words in letter units (independent of the text size) */
+			std::unordered_map<EEstring, float> wordWidths;
+		};
+
+		/* @brief Holds the pen state before a character, so the layout can be resumed at any position of a text */
+		struct LayoutCursor {
+			float penX;
+			float penY;
+			float maxWidth;
+			uint32_t quadCount;
 		};
 
 		/* @brief Holds informatios of a text that can be rendered */
@@ -78,9 +121,20 @@ namespace GFX
 			float size;
 			EEPoint32F position;
 			EERect32F maxTextDimensions;
+			EERect32F wrapDim;
 
 			glm::vec4 color;
 			glm::mat4 world;
+			/* @brief Indicates that the world matrix needs to be uploaded with the next Update */
+			bool worldChanged;
+
+			/* @brief The currently rendered text and its vertices (four per visible letter) */
+			EEstring text;
+			std::vector<VertexInput> vertices;
+			/* @brief The layout state before every character plus one after the last one */
+			std::vector<LayoutCursor> cursors;
+			/* @brief Amount of letter quads the mesh buffers can hold without reallocating */
+			uint32_t quadCapacity;
 		};
 
 	public:
@@ -126,7 +180,13 @@ namespace GFX
 		 *
 		 * @return Handle to the created text, which can be used to modify/release the text
 		 **/
-		EEText RenderText(EEFont font, EEstring const& text, EEPoint32F const& position, float size, EEColor const& color);
+		EEText RenderText(
+			EEFont						font,
+			EEstring const&		text,
+			EEPoint32F const& position,
+			float							size,
+			EEColor const&		color,
+			EERect32F const&	wrapDim = { -1.0f, -1.0f });
 
 		/**
 		 * Frees the text passed in.
@@ -144,6 +204,52 @@ namespace GFX
 		 **/
 		EEBool32 ChangeText(EEText text, EEstring const& newText);
 
+		/**
+		 * Changes the text and the dimensions it will be wrapped to. Wrapping, truncation and the
+		 * quad generation are done in a single pass over the (changed part of the) text.
+		 *
+		 * @param text			Handle to the text to change
+		 * @param newText		The new text that should be rendered
+		 * @param wrapDim		Width and height in pixels the text will not exceed (-1 for no auto wrap)
+		 *
+		 * @return Could be false if the vertex buffer update failed.
+		 **/
+		EEBool32 ChangeText(EEText text, EEstring const& newText, EERect32F const& wrapDim);
+
+		/**
+		 * Appends the string passed in to the text. Only the new letters are layed out and uploaded.
+		 *
+		 * @param text			Handle to the text to change
+		 * @param suffix		The characters that will be appended
+		 *
+		 * @return Is false if the vertex buffer update failed
+		 **/
+		EEBool32 AppendText(EEText text, EEstring const& suffix);
+
+		/**
+		 * Removes the last characters of the text. Nothing needs to be layed out or uploaded here,
+		 * just the amount of drawn letters is reduced.
+		 *
+		 * @param text			Handle to the text to change
+		 * @param count			Amount of characters to remove from the end
+		 *
+		 * @return Is false if the vertex buffer update failed
+		 **/
+		EEBool32 EraseTextTail(EEText text, size_t count);
+
+		/**
+		 * Replaces a range of characters of the text. Every letter starting at the first changed
+		 * character is layed out again and only those quads will be uploaded.
+		 *
+		 * @param text				Handle to the text to change
+		 * @param first				Index of the first character to replace
+		 * @param count				Amount of characters that will be replaced
+		 * @param replacement	The characters that will be inserted instead
+		 *
+		 * @return Is false if the vertex buffer update failed
+		 **/
+		EEBool32 ReplaceTextRange(EEText text, size_t first, size_t count, EEstring const& replacement);
+
 		/**
 		 * Inserts new line characters for the text according to the font passed in where the text exceeds
 		 * the dimensions passed in.
@@ -156,6 +262,28 @@ namespace GFX
 		 **/
 		EEstring WrapText(EEFont font, EEstring const& text, float size, EERect32F const& wrapDim) const;
 
+		/**
+		 * Lays out the text passed in without creating a renderable text, so it can be rendered
+		 * through another vertex stream (i.e. the one of an EECanvas).
+		 *
+		 * @param font				Handle to the font to use
+		 * @param text				The text to layout
+		 * @param size				Size of the text in pixel
+		 * @param wrapDim			Width and height in pixels the text will not exceed (-1 for no auto wrap)
+		 * @param verticesOut	Gets four vertices (TL, BL, TR, BR) in letter units per visible letter
+		 *
+		 * @return The pixel width/height of the whole text
+		 **/
+		EERect32F LayoutGlyphs(
+			EEFont										font,
+			EEstring const&						text,
+			float											size,
+			EERect32F const&					wrapDim,
+			std::vector<VertexInput>& verticesOut) const;
+
+		/* @brief Returns the atlas of the font passed in, the coverage of the letters is stored in the red channel */
+		EETexture GetFontTexture(EEFont font) const;
+
 		/**
 		 * Changes the color of the text passed in
 		 **/
@@ -181,9 +309,9 @@ namespace GFX
 		void SetCharacterSize(EEText text, float charSize);
 
 		/**
-		 * Please call every frame so the text can adjust to i.e. resizing
+		 * Please call every frame, uploads the world matrices of the texts that were moved since the last call
 		 **/
-		void Update() const;
+		void Update();
 
 		/* @brief Returns the pixel width/height of the whole text */
 		EERect32F GetTextDimensions(EEText text);
@@ -193,34 +321,121 @@ namespace GFX
 		 **/
 		::EEApplication* GetApplication() const;
 
+		/**
+		 * Enables the baked font cache. Fonts created afterwards are read from a cache file in the
+		 * directory passed in if there is a valid one for the font file, pixel size and charset.
+		 * Otherwise the font is rasterized and the cache file written.
+		 *
+		 * @param directory		Existing directory for the cache files (nullptr disables the cache)
+		 **/
+		void EnableFontCache(char const* directory);
+
 	private:
 		/**
-		 * Computes the mesh data for the text passed in according to the font passed in.
+		 * Reads in the font file with free type and renders the glyphs of the charset into one atlas.
+		 *
+		 * @param fileName		Destination of the font file
+		 * @param charSet			The characters to render
+		 * @param pFont				Gets the face, letter details and atlas dimensions stored
+		 * @param imageOut		Will be filled with the pixels of the atlas
+		 *
+		 * @return Is false if the font file could not be read
+		 **/
+		EEBool32 RasterizeFont(char const* fileName, EEcstr charSet, EEInternFont* pFont, std::vector<unsigned char>& imageOut);
+
+		/**
+		 * @return The destination of the cache file for the font file and charset passed in (empty if the font file can't be read)
+		 **/
+		std::string FontCacheFileName(char const* fileName, EEcstr charSet) const;
+
+		/**
+		 * Validates the mapped cache file and reads the letter details and atlas dimensions into the font.
+		 *
+		 * @return Pointer to the atlas pixels inside the mapping or nullptr if the cache is invalid
+		 **/
+		unsigned char const* ReadFontCache(EE::tools::MappedFile const& cacheFile, EEcstr charSet, EEInternFont* pFont) const;
+
+		/**
+		 * Writes the rasterized font to a cache file so the next start can skip rasterizing it.
+		 **/
+		void WriteFontCache(char const* cacheFileName, EEcstr charSet, EEInternFont const* pFont, unsigned char const* pImageData) const;
+
+		/**
+		 * Renders every step-th glyph of the charset starting at first. Called by multiple jobs
+		 * at once, so each one needs its own face.
+		 *
+		 * @param face				The face (with its pixel size set) this job will use exclusively
+		 * @param charSet			The characters of the font
+		 * @param numChars		Amount of characters in the charset
+		 * @param first				Index of the first character to render
+		 * @param step				Distance between the characters this call renders
+		 * @param pGlyphsOut	Array with one entry per character, only the entries of this call are written
+		 **/
+		static void RasterizeGlyphs(
+			FT_Face						face,
+			EEcstr						charSet,
+			size_t						numChars,
+			size_t						first,
+			size_t						step,
+			RasterizedGlyph*	pGlyphsOut);
+
+		/**
+		 * Computes the vertices of the text passed in according to its font and wrap dimensions. The layout
+		 * is resumed from the stored cursor before the word of the first character passed in, everything
+		 * before stays as it is. Characters that were not declared to be in the charset are skipped.
+		 *
+		 * @param pText				The text (with its current string) to compute vertices for
+		 * @param firstChar		Index of the first character that changed
 		 *
-		 * @param font				The font that defines the style of the text
-		 * @param text				The desired text to compute vertices/indices for
-		 * @param verticesOut	Will be filled with the computed vertex data
-		 * @param indicesOut	Will be filled with the indices according to the vertex data
-		 * @param maxTextDims The maximum width and height in pixels the text needs
+		 * @return Index of the first quad that was computed again
+		 **/
+		uint32_t ComputeMeshAccToFont(EEInternText* pText, size_t firstChar);
+
+		/**
+		 * Does word wrapping, truncation and quad generation of a text in one pass.
 		 *
-		 * @return Is false if a desired character was not declared to be in the charset
+		 * @param pFont					The font that defines the style of the text
+		 * @param text					The text to layout
+		 * @param firstChar			Index of the character to start at, its cursor must be the last one stored
+		 * @param wrapDim				Width and height in letter units to wrap into (<= 0 for no wrapping)
+		 * @param cursors				Gets the cursor after every layed out character pushed back
+		 * @param pVerticesOut	If not nullptr gets the vertices of the visible letters pushed back
+		 * @param pWrappedOut		If not nullptr gets the text with inserted line breaks appended
 		 **/
-		EEBool32 ComputeMeshAccToFont(
-			EEInternFont*							font,
+		void LayoutText(
+			EEInternFont*							pFont,
 			EEstring const&						text,
+			size_t										firstChar,
+			EERect32F const&					wrapDim,
+			std::vector<LayoutCursor>& cursors,
+			std::vector<VertexInput>* pVerticesOut,
+			EEstring*									pWrappedOut) const;
+
+		/**
+		 * Returns the width in letter units of the word starting at the passed in index. Widths are
+		 * cached per font, so a word is only measured once.
+		 **/
+		float MeasureWord(EEInternFont* pFont, EEstring const& text, size_t first) const;
+
+		/**
+		 * Fills the vertices and indices for the whole capacity of the text passed in. The vertices
+		 * after the last letter are zeroed, the indices are always the same quad pattern.
+		 **/
+		void ComputeCapacityMesh(
+			EEInternText const*				pText,
 			std::vector<VertexInput>& verticesOut,
-			std::vector<uint32_t>&		indicesOut,
-			EERect32F&								maxTextDims);
+			std::vector<uint32_t>&		indicesOut) const;
 
 		/**
-		 * Goes back from the specified index and replaces the first occurence
-		 * of a space char with a new line.
-		 * @param text		The text that the newline will be placed in
-		 * @param index		The position from where to go
+		 * Uploads the letter quads starting at the one passed in. If the capacity of the mesh is
+		 * exceeded it will be grown geometrically and the whole mesh uploaded.
+		 *
+		 * @param pText				The text which mesh will be updated
+		 * @param firstQuad		Index of the first quad that changed
 		 *
-		 * @return Amount of steps back that were needed to find a space
+		 * @return Is false if the mesh update failed
 		 **/
-		int InsertLineBreak(EEstring& text, size_t index) const;
+		EEBool32 UploadTextMesh(EEInternText* pText, uint32_t firstQuad);
 
 	private:
 		/* @brief The application this font engine will use */
@@ -229,6 +444,8 @@ namespace GFX
 		FT_Library m_library;
 		/* @brief The standard shader that is used for every text */
 		EEShader m_shader;
+		/* @brief Directory of the baked font cache files (empty if the cache is disabled) */
+		std::string m_fontCacheDir;
 
 		/* @brief All created fonts that can be used and accessed by a font handle */
 		std::vector<EEInternFont*> m_currentFonts;
@@ -18,7 +18,11 @@ GFX::EEInputBox::EEInputBox(GFX::EEFontEngine* pFontEngine)
 {}
 
 GFX::EEInputBox::EEInputBox(GFX::EEFontEngine* pFontEngine, GFX::EEInputBoxCreateInfo const& cinfo)
-	: EETextBox(pFontEngine,  {
+	: EEInputBox(pFontEngine, nullptr, cinfo)
+{}
+
+GFX::EEInputBox::EEInputBox(GFX::EEFontEngine* pFontEngine, GFX::EECanvas* pCanvas, GFX::EEInputBoxCreateInfo const& cinfo)
+	: EETextBox(pFontEngine, pCanvas, {
 														EEstring(cinfo.prefix + cinfo.text)
 														, cinfo.font
 														, cinfo.characterSize
@@ -51,25 +55,26 @@ GFX::EEInputBox::~EEInputBox()
 
 void GFX::EEInputBox::Update()
 {
-	uint32_t codePoint = i_pApp->TextInput();
-
-	/// Check simple text input (utf-8)
-	if (codePoint) {
+	/// Check simple text input (utf-8), every character typed since the previous frame is appended
+	if (i_pApp->TextInput()) {
 		i_previousText = i_text;
-		if (codePoint <= 0x7f) {
-			i_text.append(1, static_cast<char>(codePoint));
-		} else if (codePoint <= 0x7ff) {
-			i_text.append(1, static_cast<char>(0xc0 | ((codePoint >> 6) & 0x1f)));
-			i_text.append(1, static_cast<char>(0x80 | (codePoint & 0x3f)));
-		} else if (codePoint <= 0xffff) {
-			i_text.append(1, static_cast<char>(0xe0 | ((codePoint >> 12) & 0x0f)));
-			i_text.append(1, static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
-			i_text.append(1, static_cast<char>(0x80 | (codePoint & 0x3f)));
-		} else {
-			i_text.append(1, static_cast<char>(0xf0 | ((codePoint >> 18) & 0x07)));
-			i_text.append(1, static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
-			i_text.append(1, static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
-			i_text.append(1, static_cast<char>(0x80 | (codePoint & 0x3f)));
+		uint32_t codePoint;
+		for (uint32_t c = 0u; (codePoint = i_pApp->TextInput(c)); c++) {
+			if (codePoint <= 0x7f) {
+				i_text.append(1, static_cast<char>(codePoint));
+			} else if (codePoint <= 0x7ff) {
+				i_text.append(1, static_cast<char>(0xc0 | ((codePoint >> 6) & 0x1f)));
+				i_text.append(1, static_cast<char>(0x80 | (codePoint & 0x3f)));
+			} else if (codePoint <= 0xffff) {
+				i_text.append(1, static_cast<char>(0xe0 | ((codePoint >> 12) & 0x0f)));
+				i_text.append(1, static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+				i_text.append(1, static_cast<char>(0x80 | (codePoint & 0x3f)));
+			} else {
+				i_text.append(1, static_cast<char>(0xf0 | ((codePoint >> 18) & 0x07)));
+				i_text.append(1, static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+				i_text.append(1, static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+				i_text.append(1, static_cast<char>(0x80 | (codePoint & 0x3f)));
+			}
 		}
 		i_changes |= TEXT_CHANGE;
 		m_curAutoCompletes.clear();	//< Text changed so new autocomplete results needed
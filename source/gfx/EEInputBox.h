@@ -101,6 +101,9 @@ namespace GFX
 		/* @brief Creation of an input box with the properties passed in the createinfo */
 		EEInputBox(GFX::EEFontEngine* pFontEngine, GFX::EEInputBoxCreateInfo const&);
 
+		/* @brief Creation of an input box drawn by the canvas passed in (needs to outlive the box) */
+		EEInputBox(GFX::EEFontEngine* pFontEngine, GFX::EECanvas* pCanvas, GFX::EEInputBoxCreateInfo const&);
+
 		/* @brief Frees: autocompleter */
 		~EEInputBox();
 
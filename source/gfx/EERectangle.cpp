@@ -13,6 +13,7 @@
 #include <glm/gtx/transform.hpp>
 
 #include "EEApplication.h"
+#include "EECanvas.h"
 #include "vkcore/vulkanTools.h"
 
 using namespace GFX;
@@ -24,7 +25,16 @@ EERectangle::EERectangle(EEApplication* pApp)
 {}
 
 EERectangle::EERectangle(EEApplication* pApp, EERectangleCreateInfo const& cinfo)
+	: EERectangle(pApp, nullptr, cinfo)
+{}
+
+EERectangle::EERectangle(EECanvas* pCanvas, EERectangleCreateInfo const& cinfo)
+	: EERectangle(pCanvas->GetApplication(), pCanvas, cinfo)
+{}
+
+EERectangle::EERectangle(EEApplication* pApp, EECanvas* pCanvas, EERectangleCreateInfo const& cinfo)
 	: i_pApp(pApp)
+	, i_pCanvas(pCanvas)
 	, i_position(cinfo.position)
 	, i_size(cinfo.size)
 	, i_initialWindowExtent(pApp->GetWindowExtent())
@@ -42,6 +52,18 @@ EERectangle::EERectangle(EEApplication* pApp, EERectangleCreateInfo const& cinfo
 	if (cinfo.positionFlags & EE_CENTER_HORIZONTAL) i_position.x = (i_initialWindowExtent.width - i_size.width) / 2.f;
 	if (cinfo.positionFlags & EE_CENTER_VERTICAL) i_position.y = (i_initialWindowExtent.height - i_size.height) / 2.f;
 
+	// On a canvas the rectangle is just a quad of its vertex stream
+	if (i_pCanvas) {
+		i_fragmentUniformBufferContent.fillColor = { i_bgColor.r, i_bgColor.g, i_bgColor.b, i_bgColor.a };
+		i_canvasItem = i_pCanvas->AddRect(i_position, i_size, i_bgColor);
+		if (!cinfo.visibility) {
+			i_pCanvas->SetItemVisibility(i_canvasItem, false);
+		}
+
+		i_isCreated = true;
+		return;
+	}
+
 	i_shader = i_pApp->AcquireShaderColor2D();
 
 	std::vector<EEShaderColor2D::VertexInputType> vertices = {
@@ -54,14 +76,17 @@ EERectangle::EERectangle(EEApplication* pApp, EERectangleCreateInfo const& cinfo
 		0, 1, 2,
 		0, 2, 3
 	};
-	i_mesh = i_pApp->CreateMesh(vertices.data(), sizeof(EEShaderColor2D::VertexInputType) * vertices.size(), indices);
+	// Only the position is needed for the bounds of the mesh
+	EEShaderInputDesc positionInput{ 0u, EE_FORMAT_R32G32B32_SFLOAT, offsetof(EEShaderColor2D::VertexInputType, position) };
+	EEVertexInput vertexInput{ 1u, &positionInput, sizeof(EEShaderColor2D::VertexInputType) };
+	i_mesh = i_pApp->CreateMesh(vertices.data(), sizeof(EEShaderColor2D::VertexInputType) * vertices.size(), indices, &vertexInput);
 
 	// RESOURCES
 	i_vertexUniformBuffer = i_pApp->CreateBuffer(sizeof(EEShaderColor2D::VertexUBO));
 	i_fragmentUniformBuffer = i_pApp->CreateBuffer(sizeof(EEShaderColor2D::FragmentUBO));
 
 	// OBJECT
-	std::vector<EEObjectResourceBinding> bindings(2);
+	std::vector<EEObjectResourceBinding> bindings(3);
 	bindings[0].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	bindings[0].binding = 0u;
 	bindings[0].resource = i_vertexUniformBuffer;
@@ -70,21 +95,25 @@ EERectangle::EERectangle(EEApplication* pApp, EERectangleCreateInfo const& cinfo
 	bindings[1].binding = 1u;
 	bindings[1].resource = i_fragmentUniformBuffer;
 
+	bindings[2].type = EE_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	bindings[2].binding = 2u;
+	bindings[2].resource = i_pApp->AcquireCameraBuffer2D();
+
 	i_object = i_pApp->CreateObject(i_shader, i_mesh, bindings);
 
 
-	// Initialize vertex buffer conten
-	i_vertexUniformBufferContent.ortho = i_pApp->AcquireOrthoMatrixLH();
-  i_vertexUniformBufferContent.baseView = i_pApp->AcquireBaseViewLH();
+	// Initialize vertex buffer content, ortho and base view are in the shared camera buffer
 	// Create world matrix with passed in size and position
   glm::vec3 translation{-(i_initialWindowExtent.width / 2.0f) + i_position.x, -(i_initialWindowExtent.height / 2.0f) + i_position.y, 0.0f};
   glm::vec3 scale{i_size.width, i_size.height, 1.0f};
   i_vertexUniformBufferContent.world = glm::scale(scale);
   i_vertexUniformBufferContent.world *= glm::translate(translation);
-  
+	i_pApp->UpdateBuffer(i_vertexUniformBuffer, &i_vertexUniformBufferContent);
+	i_pApp->SetObjectWorld(i_object, i_vertexUniformBufferContent.world);
 
 	// Initialize fragment buffer content
-  i_fragmentUniformBufferContent.fillColor = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+  i_fragmentUniformBufferContent.fillColor = { i_bgColor.r, i_bgColor.g, i_bgColor.b, i_bgColor.a };
+	i_pApp->UpdateBuffer(i_fragmentUniformBuffer, &i_fragmentUniformBufferContent);
 
 	// Hide rectangle if desired
 	if (!cinfo.visibility) {
@@ -99,8 +128,12 @@ EERectangle::EERectangle(EEApplication* pApp, EERectangleCreateInfo const& cinfo
 EERectangle::~EERectangle()
 {
 	if (i_isCreated) {
-		i_pApp->ReleaseObject(i_object);
-		i_pApp->ReleaseMesh(i_mesh);
+		if (i_pCanvas) {
+			i_pCanvas->RemoveItem(i_canvasItem);
+		} else {
+			i_pApp->ReleaseObject(i_object);
+			i_pApp->ReleaseMesh(i_mesh);
+		}
 
 		i_isCreated = false;
 	}
@@ -117,33 +150,54 @@ EERectangle::~EERectangle()
 
 void EERectangle::Update()
 {
-	if (i_changes & SIZE_CHANGE || i_changes & POSITION_CHANGE) {
+	bool geometryChanged = (i_changes & SIZE_CHANGE || i_changes & POSITION_CHANGE);
+	if (geometryChanged && i_pCanvas) {
+		// The canvas computes the quad itself
+		i_pCanvas->SetItemBounds(i_canvasItem, i_position, i_size);
+
+	} else if (geometryChanged) {
 		// Update world matrix
 		EERect32U wExtent = i_pApp->GetWindowExtent();
     glm::vec3 translation{-(wExtent.width / 2.0f) + i_position.x, -(wExtent.height / 2.0f) + i_position.y, 0.0f};
     glm::vec3 scale{i_size.width, i_size.height, 1.0f};
     i_vertexUniformBufferContent.world = glm::scale(scale);
     i_vertexUniformBufferContent.world *= glm::translate(translation);
-	}
 
-	// Update the vertex uniform buffer
-	i_vertexUniformBufferContent.ortho = i_pApp->AcquireOrthoMatrixLH();
-	i_vertexUniformBufferContent.baseView = i_pApp->AcquireBaseViewLH();
-	i_pApp->UpdateBuffer(i_vertexUniformBuffer, &i_vertexUniformBufferContent);
+		// Update the vertex uniform buffer (ortho/base view live in the shared camera buffer)
+		i_pApp->UpdateBuffer(i_vertexUniformBuffer, &i_vertexUniformBufferContent);
+		i_pApp->SetObjectWorld(i_object, i_vertexUniformBufferContent.world);
+	}
 
 	// Default background color that can be overwritten if rectangle is active/hovered
-	i_fragmentUniformBufferContent.fillColor = { i_bgColor.r, i_bgColor.g , i_bgColor.b , i_bgColor.a };
-
-	// Check for hover, overwrites default color
-	if (i_hoverEnabled && Intersect(i_pApp->MousePosition())) {
-		i_fragmentUniformBufferContent.fillColor = { i_hoverColor.r, i_hoverColor.g, i_hoverColor.b, i_hoverColor.a };
+	EEColor const* pFillColor = &i_bgColor;
+
+	// The intersection is only needed for enabled effects and only changes if the mouse or the rectangle moved
+	if (i_hoverEnabled || i_activeEnabled) {
+		EEPoint64F mousePos = i_pApp->MousePosition();
+		if (i_pCanvas) {
+			// The canvas looks up the items under the mouse in its grid once for all widgets
+			i_isHovered = i_pCanvas->IsItemHovered(i_canvasItem);
+		} else if (geometryChanged || mousePos.x != i_lastMousePosition.x || mousePos.y != i_lastMousePosition.y) {
+			i_isHovered = Intersect(mousePos);
+			i_lastMousePosition = mousePos;
+		}
+
+		// Check for hover, overwrites default color
+		if (i_hoverEnabled && i_isHovered) pFillColor = &i_hoverColor;
+		// Check for active, overwrites hover/default color
+		if (i_activeEnabled && i_isHovered && i_pApp->MouseDown(EE_MOUSE_BUTTON_LEFT)) pFillColor = &i_activeColor;
 	}
-	// Check for active, overwrites hover/default color
-	if (i_activeEnabled && i_pApp->MouseDown(EE_MOUSE_BUTTON_LEFT) && Intersect(i_pApp->MousePosition())) {
-		i_fragmentUniformBufferContent.fillColor = { i_activeColor.r, i_activeColor.g, i_activeColor.b, i_activeColor.a };
+
+	// Update fragment uniform buffer storing the background color only if the color differs
+	glm::vec4 fillColor{ pFillColor->r, pFillColor->g, pFillColor->b, pFillColor->a };
+	if (fillColor != i_fragmentUniformBufferContent.fillColor) {
+		i_fragmentUniformBufferContent.fillColor = fillColor;
+		if (i_pCanvas) {
+			i_pCanvas->SetItemColor(i_canvasItem, *pFillColor);
+		} else {
+			i_pApp->UpdateBuffer(i_fragmentUniformBuffer, &i_fragmentUniformBufferContent);
+		}
 	}
-	// Update fragment uniform buffer storing the background color
-	i_pApp->UpdateBuffer(i_fragmentUniformBuffer, &i_fragmentUniformBufferContent);
 
 	// Reset changes, since all are uploaded now
 	i_changes = 0u;
@@ -263,7 +317,11 @@ void EERectangle::SetVisibility(bool visible)
 		return;
 	}
 
-	i_pApp->SetObjectVisibility(i_object, visible);
+	if (i_pCanvas) {
+		i_pCanvas->SetItemVisibility(i_canvasItem, visible);
+	} else {
+		i_pApp->SetObjectVisibility(i_object, visible);
+	}
 }
 
 
@@ -294,7 +352,8 @@ bool EERectangle::Clicked(EEMouseButton button)
 		return false;
 	}
 
-	return i_pApp->MouseHit(button) && Intersect(i_pApp->MousePosition());
+	if (!i_pApp->MouseHit(button)) return false;
+	return (i_pCanvas) ? i_pCanvas->IsItemHovered(i_canvasItem) : Intersect(i_pApp->MousePosition());
 }
 
 
@@ -17,6 +17,10 @@
 // FOREWARD DECLARATIONS //
 ///////////////////////////
 class EEApplication;
+namespace GFX {
+	class EECanvas;
+	typedef uint32_t* EECanvasItem;
+}
 
 namespace GFX
 {
@@ -37,6 +41,8 @@ namespace GFX
 	public:
 		EERectangle(EEApplication* pApp);
 		EERectangle(EEApplication* pApp, EERectangleCreateInfo const&);
+		/* @brief Creates the rectangle as a quad of the canvas (needs to outlive the rectangle), which draws it on its Update */
+		EERectangle(EECanvas* pCanvas, EERectangleCreateInfo const&);
 		EERectangle(EERectangle const&) = delete;
 		EERectangle(EERectangle&&) = delete;
 		virtual ~EERectangle();
@@ -62,8 +68,13 @@ namespace GFX
 		EERectangle& operator=(EERectangle const&) = delete;
 		EERectangle& operator=(EERectangle&&) = delete;
 
+	protected:
+		EERectangle(EEApplication* pApp, EECanvas* pCanvas, EERectangleCreateInfo const&);
+
 	protected:
 		EEApplication*	i_pApp;
+		EECanvas*				i_pCanvas;
+		EECanvasItem		i_canvasItem{ nullptr };
 		EEPoint32F			i_position;
 		EERect32F				i_size;
 		EERect32U				i_initialWindowExtent;
@@ -74,6 +85,8 @@ namespace GFX
 		bool						i_activeEnabled;
 
 		uint32_t				i_changes{ 0u };
+		bool						i_isHovered{ false };
+		EEPoint64F			i_lastMousePosition{ -1.0, -1.0 };
 
 		EEObject	i_object;
 		EEMesh		i_mesh;
@@ -6,6 +6,7 @@
 #include "EETextBox.h"
 
 #include "EEFontEngine.h"
+#include "EECanvas.h"
 
 using namespace GFX;
 
@@ -19,7 +20,11 @@ EETextBox::EETextBox(EEFontEngine* pFontEngine)
 {}
 
 EETextBox::EETextBox(EEFontEngine* pFontEngine, EETextBoxCreateInfo const& cinfo)
-	: EERectangle(pFontEngine->GetApplication(), *ACQUIRE_RECT_INFO(&cinfo))
+	: EETextBox(pFontEngine, nullptr, cinfo)
+{}
+
+EETextBox::EETextBox(EEFontEngine* pFontEngine, EECanvas* pCanvas, EETextBoxCreateInfo const& cinfo)
+	: EERectangle(pFontEngine->GetApplication(), pCanvas, *ACQUIRE_RECT_INFO(&cinfo))
 	, i_pFontEngine(pFontEngine)
 	, i_textColor(cinfo.textColor)
 	, i_characterSize(cinfo.characterSize)
@@ -32,31 +37,32 @@ EETextBox::EETextBox(EEFontEngine* pFontEngine, EETextBoxCreateInfo const& cinfo
 {
 	assert(i_font);
 
-	// Get a version of the passed in text that has newline characters at positions
-	// that would exceed the desired width/height if we are limited to the box size
+	// Let the font engine break the lines that would exceed the desired width/height if we
+	// are limited to the box size, otherwise we just go with the standard text and resize the box later
+	EERect32F wrapDim{ -1.0f, -1.0f };
 	if (!cinfo.adjustBoxSize) {
-		i_textWrapped = i_pFontEngine->WrapText(i_font, i_text, i_characterSize,
-			{ i_size.width - i_paddingLeft - i_paddingRight, i_size.height - i_paddingTop - i_paddingBottom });
+		wrapDim = { i_size.width - i_paddingLeft - i_paddingRight, i_size.height - i_paddingTop - i_paddingBottom };
+	}
 
-	// otherwise we just go with the standard text and resize the box later
+	// Create the renderable text, on a canvas it is added on top of the box' quad
+	EEPoint32F textPosition{ i_position.x + i_paddingLeft, i_position.y + i_paddingTop };
+	if (i_pCanvas) {
+		i_textItem = i_pCanvas->AddText(i_pFontEngine, i_font, i_text, textPosition, i_characterSize, i_textColor, wrapDim);
 	} else {
-		i_textWrapped = i_text;
+		i_renderText = i_pFontEngine->RenderText(i_font, i_text, textPosition, i_characterSize, i_textColor, wrapDim);
 	}
 
-	// Create the renderable text
-	i_renderText = i_pFontEngine->RenderText(i_font, i_textWrapped, 
-		{ i_position.x + i_paddingLeft, i_position.y + i_paddingTop }, i_characterSize, i_textColor);
-
 	// Store the new size if we adjust it to the text
 	if (cinfo.adjustBoxSize) {
-		EERect32F textSize = i_pFontEngine->GetTextDimensions(i_renderText);
+		EERect32F textSize = (i_pCanvas) ? i_pCanvas->GetTextDimensions(i_textItem) : i_pFontEngine->GetTextDimensions(i_renderText);
 		SetSize({ textSize.width + i_paddingLeft + i_paddingRight + EPSILON, textSize.height + i_paddingTop + i_paddingBottom + EPSILON });
 		// Now center the pox aligned if desired
 		if (cinfo.positionFlags) SetPositionAligned(cinfo.positionFlags);
 	}
 
 	if (!cinfo.visibility) {
-		i_pFontEngine->SetTextVisibility(i_renderText, EE_FALSE);
+		if (i_pCanvas) i_pCanvas->SetItemVisibility(i_textItem, false);
+		else i_pFontEngine->SetTextVisibility(i_renderText, EE_FALSE);
 	}
 
 	i_textBoxCreated = true;
@@ -65,7 +71,8 @@ EETextBox::EETextBox(EEFontEngine* pFontEngine, EETextBoxCreateInfo const& cinfo
 EETextBox::~EETextBox()
 {
 	if (i_textBoxCreated) {
-		i_pFontEngine->ReleaseText(i_renderText);
+		if (i_pCanvas) i_pCanvas->RemoveItem(i_textItem);
+		else i_pFontEngine->ReleaseText(i_renderText);
 
 		i_textBoxCreated = false;
 	}
@@ -73,15 +80,32 @@ EETextBox::~EETextBox()
 
 void EETextBox::Update()
 {
+	EERect32F wrapDim{ i_size.width - i_paddingLeft - i_paddingRight, i_size.height - i_paddingTop - i_paddingBottom };
+
+	if (i_pCanvas) {
+		// The canvas only lays out and uploads the items that really changed
+		if (i_changes & POSITION_CHANGE || i_changes & PADDING_CHANGE) {
+			i_pCanvas->SetItemPosition(i_textItem, { i_position.x + i_paddingLeft, i_position.y + i_paddingTop });
+		}
+		if (i_changes & TEXT_CHANGE || i_changes & SIZE_CHANGE || i_changes & PADDING_CHANGE) {
+			i_pCanvas->SetItemText(i_textItem, i_text, wrapDim);
+			i_previousText = i_text;
+		}
+		if (i_changes & TEXTCOLOR_CHANGE) {
+			i_pCanvas->SetItemColor(i_textItem, i_textColor);
+		}
+
+		EERectangle::Update();
+		return;
+	}
+
 	if (i_changes & POSITION_CHANGE || i_changes & PADDING_CHANGE) {
 		i_pFontEngine->SetTextPosition(i_renderText, { i_position.x + i_paddingLeft, i_position.y + i_paddingTop });
 	}
 
 	if (i_changes & TEXT_CHANGE || i_changes & SIZE_CHANGE || i_changes & PADDING_CHANGE) {
-		EEstring newTextWrapped = i_pFontEngine->WrapText(i_font, i_text, i_characterSize,
-			{ i_size.width - i_paddingLeft - i_paddingRight, i_size.height - i_paddingTop - i_paddingBottom});
-		if (i_pFontEngine->ChangeText(i_renderText, newTextWrapped)) {
-			i_textWrapped = newTextWrapped;
+		// Wrapping is done while laying out the text, so only the changed lines are touched
+		if (i_pFontEngine->ChangeText(i_renderText, i_text, wrapDim)) {
 			i_previousText = i_text;
 		} else {
 			i_text = i_previousText; //< Revert will only do something if text was changed because of a textchange
@@ -174,7 +198,8 @@ void EETextBox::SetVisibility(bool isVisible)
 	}
 
 	EERectangle::SetVisibility(isVisible);
-	i_pFontEngine->SetTextVisibility(i_renderText, isVisible);
+	if (i_pCanvas) i_pCanvas->SetItemVisibility(i_textItem, isVisible);
+	else i_pFontEngine->SetTextVisibility(i_renderText, isVisible);
 }
 
 
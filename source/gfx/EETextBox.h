@@ -48,6 +48,8 @@ namespace GFX
 	public:
 		EETextBox(EEFontEngine* pFontEngine);
 		EETextBox(EEFontEngine* pFontEngine, EETextBoxCreateInfo const& cinfo);
+		/* @brief Creates the box and its text as items of the canvas (needs to outlive the box), which draws them on its Update */
+		EETextBox(EEFontEngine* pFontEngine, EECanvas* pCanvas, EETextBoxCreateInfo const& cinfo);
 		EETextBox(EETextBox const&) = delete;
 		EETextBox(EETextBox&&) = delete;
 		virtual ~EETextBox();
@@ -74,10 +76,10 @@ namespace GFX
 
 		EEstring i_text;
 		EEstring i_previousText;
-		EEstring i_textWrapped;
 
 		EEFont i_font;
-		EEText i_renderText;
+		EEText i_renderText{ nullptr };
+		EECanvasItem i_textItem{ nullptr };
 
 		bool i_textBoxCreated{ false };
 	};
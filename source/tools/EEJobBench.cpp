@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: EEJobBench.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "coretools/JobSystem.h"
+
+/* @brief Amount of empty jobs the overhead is measured with */
+#define OVERHEAD_JOBS (1u << 20u)
+
+/* @brief Work of the scaling test, split into jobs of SCALING_GRAIN items */
+#define SCALING_ITEMS (1u << 22u)
+#define SCALING_GRAIN 256u
+#define ITERATIONS_PER_ITEM 64u
+
+
+namespace {
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/* @brief Some arithmetic per item the compiler can't remove */
+	uint32_t Work(uint32_t item)
+	{
+		uint32_t state = item * 0x9E3779B9u + 1u;
+		for (uint32_t i = 0u; i < ITERATIONS_PER_ITEM; i++) {
+			state ^= state << 13u;
+			state ^= state >> 17u;
+			state ^= state << 5u;
+		}
+		return state;
+	}
+
+	/* @brief Returns the milliseconds the job system with the amount of threads needs for the scaling work */
+	double MeasureScaling(uint32_t amountThreads, std::vector<uint32_t>& results)
+	{
+		CORETOOLS::JobSystem jobSystem(amountThreads);
+		auto begin = std::chrono::steady_clock::now();
+		jobSystem.ParallelFor(SCALING_ITEMS, SCALING_GRAIN, [&results](uint32_t i) { results[i] = Work(i); });
+		return MillisecondsSince(begin);
+	}
+}
+
+
+/**
+ * Measures the per job overhead of CORETOOLS::JobSystem and how work scales with the threads.
+ *
+ * Usage: EEJobBench [maxThreads]
+ *
+ * maxThreads	Highest amount of threads the scaling is measured with (defaults to one per core),
+ *						the amounts measured are the powers of two up to it
+ **/
+int main(int argc, char** argv)
+{
+	uint32_t maxThreads = (argc > 1) ? uint32_t(strtoul(argv[1], nullptr, 10)) : std::thread::hardware_concurrency();
+	if (maxThreads == 0u) maxThreads = 1u;
+
+	// Overhead: empty jobs on a single thread only measure queueing, popping and counting
+	{
+		CORETOOLS::JobSystem jobSystem(1u);
+		auto emptyJob = [](uint32_t) {};
+
+		auto begin = std::chrono::steady_clock::now();
+		jobSystem.ParallelFor(OVERHEAD_JOBS, 1u, emptyJob);
+		double local = MillisecondsSince(begin);
+
+		printf("Per job overhead: %.1f ns (%u empty jobs)\n", local * 1.0e6 / OVERHEAD_JOBS, OVERHEAD_JOBS);
+	}
+
+	// Scaling: the same work with 1, 2, 4, ... threads
+	std::vector<uint32_t> results(SCALING_ITEMS);
+	double singleThreaded = MeasureScaling(1u, results);
+	printf("%3u thread(s): %8.2f ms\n", 1u, singleThreaded);
+	for (uint32_t amountThreads = 2u; amountThreads <= maxThreads; amountThreads *= 2u) {
+		double time = MeasureScaling(amountThreads, results);
+		printf("%3u thread(s): %8.2f ms, speedup %.2f, efficiency %.0f%%\n", amountThreads, time,
+					 singleThreaded / time, 100.0 * singleThreaded / time / amountThreads);
+	}
+
+	// Keep the results alive
+	uint32_t checksum = 0u;
+	for (uint32_t i = 0u; i < SCALING_ITEMS; i++) checksum ^= results[i];
+	printf("Checksum %08x\n", checksum);
+
+	return EXIT_SUCCESS;
+}
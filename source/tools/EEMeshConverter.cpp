@@ -0,0 +1,75 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: EEMeshConverter.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "eemeshloader.h"
+#include "eemeshoptimizer.h"
+
+/* @brief Allowed loss of vertex cache efficiency for the overdraw optimization */
+#define OVERDRAW_THRESHOLD 1.05f
+
+/* @brief Meshlet limits of the common mesh shader guidelines */
+#define MESHLET_MAX_VERTICES 64u
+#define MESHLET_MAX_TRIANGLES 124u
+
+
+/**
+ * Converts a wavefront obj file into a binary mesh file of predefined vertices.
+ *
+ * Usage: EEMeshConverter <input.obj> <output.eemesh> [--optimize] [--meshlets]
+ *
+ * --optimize	Reorders the triangles for the vertex cache and overdraw and the vertices for the fetch
+ * --meshlets	Splits the (optimized) triangles into meshlets
+ **/
+int main(int argc, char** argv)
+{
+	if (argc < 3) {
+		printf("Usage: %s <input.obj> <output.eemesh> [--optimize] [--meshlets]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	bool optimize = false, buildMeshlets = false;
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "--optimize") == 0) optimize = true;
+		else if (strcmp(argv[i], "--meshlets") == 0) buildMeshlets = true;
+		else printf("Unknown option %s ignored!\n", argv[i]);
+	}
+
+	std::vector<EEPredefinedVertex> vertices;
+	std::vector<uint32_t> indices;
+	if (!EE::tools::loadObj(argv[1], vertices, indices)) {
+		printf("Failed to load %s!\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	EEVertexInput const& vertexInput = EE::tools::predefinedVertexInput();
+
+	if (optimize) {
+		EE::tools::VertexCacheStats before = EE::tools::analyzeVertexCache(indices, vertices.size());
+
+		EE::tools::optimizeVertexCache(indices, vertices.size());
+		EE::tools::optimizeOverdraw(indices, &vertices[0].position.x, vertices.size(), sizeof(EEPredefinedVertex), OVERDRAW_THRESHOLD);
+		vertices.resize(EE::tools::optimizeVertexFetch(indices, vertices.data(), vertices.size(), sizeof(EEPredefinedVertex)));
+
+		EE::tools::VertexCacheStats after = EE::tools::analyzeVertexCache(indices, vertices.size());
+		printf("Vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+	}
+
+	std::vector<EE::tools::MeshFileMeshlet> meshlets;
+	if (buildMeshlets) {
+		EE::tools::buildMeshlets(vertexInput, vertices.data(), vertices.size(), indices,
+														 MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES, meshlets);
+	}
+
+	if (!EE::tools::writeMeshFile(argv[2], vertexInput, vertices.data(), vertices.size(), indices, meshlets)) {
+		printf("Failed to write %s!\n", argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	printf("%s: %zu vertices, %zu triangles, %zu meshlets\n", argv[2], vertices.size(), indices.size() / 3u, meshlets.size());
+	return EXIT_SUCCESS;
+}
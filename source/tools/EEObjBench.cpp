@@ -0,0 +1,126 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: EEObjBench.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "eemeshloader.h"
+#include "coretools/JobSystem.h"
+
+
+namespace {
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	/**
+	 * The straight forward way to read an obj file: std::getline, a std::istringstream per line and
+	 * a std::map keyed by the corner string for the deduplication. Reads positions, uvs, normals
+	 * and faces (positive indices only), which is enough to compare the parsing speed.
+	 **/
+	bool LoadObjNaive(char const* fileName, std::vector<EEPredefinedVertex>& verticesOut, std::vector<uint32_t>& indicesOut)
+	{
+		std::ifstream file(fileName);
+		if (!file.is_open()) return false;
+
+		std::vector<glm::vec3> positions, normals;
+		std::vector<glm::vec2> uvCoords;
+		std::map<std::string, uint32_t> vertexIndices;
+
+		std::string line;
+		while (std::getline(file, line)) {
+			std::istringstream stream(line);
+			std::string type;
+			stream >> type;
+
+			if (type == "v") {
+				glm::vec3 position;
+				stream >> position.x >> position.y >> position.z;
+				positions.push_back(position);
+			} else if (type == "vt") {
+				glm::vec2 uv;
+				stream >> uv.x >> uv.y;
+				uvCoords.push_back(glm::vec2(uv.x, 1.0f - uv.y));
+			} else if (type == "vn") {
+				glm::vec3 normal;
+				stream >> normal.x >> normal.y >> normal.z;
+				normals.push_back(normal);
+			} else if (type == "f") {
+				std::vector<uint32_t> polygon;
+				std::string corner;
+				while (stream >> corner) {
+					auto result = vertexIndices.emplace(corner, uint32_t(verticesOut.size()));
+					if (result.second) {
+						uint32_t indices[3] = { 0u, 0u, 0u };
+						sscanf(corner.c_str(), "%u/%u/%u", &indices[0], &indices[1], &indices[2]);
+						if (corner.find("//") != std::string::npos) sscanf(corner.c_str(), "%u//%u", &indices[0], &indices[2]);
+						if (indices[0] == 0u || indices[0] > positions.size()) return false;
+
+						EEPredefinedVertex vertex;
+						vertex.position = positions[indices[0] - 1u];
+						vertex.color = glm::vec3(1.0f);
+						vertex.uvCoord = (indices[1] && indices[1] <= uvCoords.size()) ? uvCoords[indices[1] - 1u] : glm::vec2(0.0f);
+						vertex.normal = (indices[2] && indices[2] <= normals.size()) ? normals[indices[2] - 1u] : glm::vec3(0.0f);
+						verticesOut.push_back(vertex);
+					}
+					polygon.push_back(result.first->second);
+				}
+				for (size_t i = 2u; i < polygon.size(); i++) {
+					indicesOut.push_back(polygon[0]);
+					indicesOut.push_back(polygon[i - 1u]);
+					indicesOut.push_back(polygon[i]);
+				}
+			}
+		}
+		return true;
+	}
+}
+
+
+/**
+ * Compares EE::tools::loadObj against a naive std::ifstream parser on the obj file passed in.
+ *
+ * Usage: EEObjBench <input.obj>
+ **/
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		printf("Usage: %s <input.obj>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Start the workers before measuring, like an application that already used them
+	printf("Job system threads: %u\n", CORETOOLS::JobSystem::Shared().GetAmountThreads());
+
+	std::vector<EEPredefinedVertex> vertices;
+	std::vector<uint32_t> indices;
+	auto begin = std::chrono::steady_clock::now();
+	if (!EE::tools::loadObj(argv[1], vertices, indices)) {
+		printf("Failed to load %s!\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	double fastTime = MillisecondsSince(begin);
+	printf("loadObj:  %9.1f ms, %zu vertices, %zu triangles\n", fastTime, vertices.size(), indices.size() / 3u);
+
+	std::vector<EEPredefinedVertex> naiveVertices;
+	std::vector<uint32_t> naiveIndices;
+	begin = std::chrono::steady_clock::now();
+	if (!LoadObjNaive(argv[1], naiveVertices, naiveIndices)) {
+		printf("The naive parser failed to load %s!\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	double naiveTime = MillisecondsSince(begin);
+	printf("ifstream: %9.1f ms, %zu vertices, %zu triangles\n", naiveTime, naiveVertices.size(), naiveIndices.size() / 3u);
+	printf("Speedup %.2f\n", naiveTime / fastTime);
+
+	return EXIT_SUCCESS;
+}
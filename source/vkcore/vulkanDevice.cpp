@@ -177,6 +177,14 @@ vulkan::Device::Device(EE::vulkan::Instance const* pInstance, EE::Window* pWindo
 
 vulkan::Device::~Device()
 {
+	// Every resource should be released before the device
+	if (!memoryUsage.allocations.empty()) {
+		uint64_t leakedBytes{ 0u };
+		for (auto const& allocation : memoryUsage.allocations) leakedBytes += allocation.second.size;
+		EE_PRINT("[DEVICE] %u memory allocations (%llu bytes) were never freed!\n",
+			uint32_t(memoryUsage.allocations.size()), (unsigned long long)leakedBytes);
+	}
+
 	if (cmdPoolGraphics) {
 		vkDestroyCommandPool(logicalDevice, cmdPoolGraphics, pAllocator);
 	}
@@ -347,6 +355,14 @@ VkResult vulkan::Device::Create(VkPhysicalDeviceFeatures const& desiredFeatures,
 	VkResult result = vkCreateDevice(physicalDevice, &deviceCInfo, pAllocator, &logicalDevice);
 
 	if (result == VK_SUCCESS) {
+		// Heap usage and budget can only be queried with the extension enabled
+		for (char const* curExtension : enabledExtensions) {
+			if (strcmp(curExtension, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+				pGetMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+					vkGetInstanceProcAddr(*pInstance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+			}
+		}
+
 		// Create the default command pool for drawing
 		cmdPoolGraphics = CreateCommandPool(queueIndices.graphics);
 	}
@@ -355,7 +371,7 @@ VkResult vulkan::Device::Create(VkPhysicalDeviceFeatures const& desiredFeatures,
 }
 
 VkResult vulkan::Device::CreateBuffer(VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryProperties,
-	VkDeviceSize size, VkBuffer* pBufferOut, VkDeviceMemory* pBufferMemoryOut, void const* pData) const
+	EEMemoryCategory category, VkDeviceSize size, VkBuffer* pBufferOut, VkDeviceMemory* pBufferMemoryOut, void const* pData) const
 {
 	assert(size > 0);
 
@@ -369,7 +385,7 @@ VkResult vulkan::Device::CreateBuffer(VkBufferUsageFlags usageFlags, VkMemoryPro
 	VkMemoryAllocateInfo allocInfo = vulkan::initializers::memoryAllocateInfo();
 	allocInfo.allocationSize = memReqs.size;
 	allocInfo.memoryTypeIndex = GetMemoryType(memReqs.memoryTypeBits, memoryProperties);
-	VK_CHECK(vkAllocateMemory(logicalDevice, &allocInfo, pAllocator, pBufferMemoryOut));
+	VK_CHECK(AllocateMemory(allocInfo, category, pBufferMemoryOut));
 
 	// If data has been passed in store this data in the buffer
 	if (pData) {
@@ -391,18 +407,18 @@ VkResult vulkan::Device::CreateBuffer(VkBufferUsageFlags usageFlags, VkMemoryPro
 }
 
 void vulkan::Device::CreateDeviceLocalBuffer(void const* pData, VkDeviceSize bufferSize,
-	VkBufferUsageFlags usageFlags, VkBuffer* pBufferOut, VkDeviceMemory* pBufferMemoryOut) const
+	VkBufferUsageFlags usageFlags, EEMemoryCategory category, VkBuffer* pBufferOut, VkDeviceMemory* pBufferMemoryOut) const
 {
 	// Create a staging buffer which holds the data
 	VkBuffer stagingBuffer;
 	VkDeviceMemory stagingBufferMemory;
 	VK_CHECK(CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-					 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+					 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EE_MEMORY_CATEGORY_STAGING,
 					 bufferSize, &stagingBuffer, &stagingBufferMemory, pData));
 
 	// Create the final buffer to be device local and the destination of the data transfer
 	VK_CHECK(CreateBuffer(usageFlags | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bufferSize, pBufferOut, pBufferMemoryOut));
+					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, category, bufferSize, pBufferOut, pBufferMemoryOut));
 
 	// Now transfer the data
 	ExecBuffer execBuffer(this, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
@@ -417,10 +433,83 @@ void vulkan::Device::CreateDeviceLocalBuffer(void const* pData, VkDeviceSize buf
 	execBuffer.Execute();
 
 	// Destroy the staging buffer
-	vkFreeMemory(logicalDevice, stagingBufferMemory, pAllocator);
+	FreeMemory(stagingBufferMemory);
 	vkDestroyBuffer(logicalDevice, stagingBuffer, pAllocator);
 }
 
+VkResult vulkan::Device::AllocateMemory(VkMemoryAllocateInfo const& allocInfo, EEMemoryCategory category, VkDeviceMemory* pMemoryOut) const
+{
+	VkResult result = vkAllocateMemory(logicalDevice, &allocInfo, pAllocator, pMemoryOut);
+	if (result != VK_SUCCESS) return result;
+
+	MemoryAllocation allocation{ allocInfo.allocationSize, memoryProperties.memoryTypes[allocInfo.memoryTypeIndex].heapIndex, category };
+
+	std::lock_guard<std::mutex> lock(memoryUsage.mutex);
+	memoryUsage.allocations[*pMemoryOut] = allocation;
+	memoryUsage.categoryBytes[category] += allocation.size;
+	memoryUsage.categoryAllocations[category]++;
+	memoryUsage.heapBytes[allocation.heapIndex] += allocation.size;
+
+	return result;
+}
+
+void vulkan::Device::FreeMemory(VkDeviceMemory memory) const
+{
+	{
+		std::lock_guard<std::mutex> lock(memoryUsage.mutex);
+		auto it = memoryUsage.allocations.find(memory);
+		if (it != memoryUsage.allocations.end()) {
+			memoryUsage.categoryBytes[it->second.category] -= it->second.size;
+			memoryUsage.categoryAllocations[it->second.category]--;
+			memoryUsage.heapBytes[it->second.heapIndex] -= it->second.size;
+			memoryUsage.allocations.erase(it);
+		} else {
+			EE_PRINT("[DEVICE] Freed memory that wasn't allocated with Device::AllocateMemory!\n");
+		}
+	}
+
+	vkFreeMemory(logicalDevice, memory, pAllocator);
+}
+
+EEMemoryStats vulkan::Device::GetMemoryStats() const
+{
+	EEMemoryStats stats{};
+
+	{
+		std::lock_guard<std::mutex> lock(memoryUsage.mutex);
+		for (uint32_t i = 0u; i < EE_MEMORY_CATEGORY_COUNT; i++) {
+			stats.categoryBytes[i] = memoryUsage.categoryBytes[i];
+			stats.categoryAllocations[i] = memoryUsage.categoryAllocations[i];
+		}
+		stats.heapCount = memoryProperties.memoryHeapCount;
+		for (uint32_t i = 0u; i < stats.heapCount; i++) {
+			stats.heaps[i].size = memoryProperties.memoryHeaps[i].size;
+			stats.heaps[i].usage = memoryUsage.heapBytes[i];
+			stats.heaps[i].budget = memoryProperties.memoryHeaps[i].size;
+			stats.heaps[i].engineUsage = memoryUsage.heapBytes[i];
+			stats.heaps[i].isDeviceLocal = (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? EE_TRUE : EE_FALSE;
+		}
+	}
+
+	// The driver's view includes other allocations of this process (swapchain images, driver internals)
+	if (pGetMemoryProperties2) {
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+		VkPhysicalDeviceMemoryProperties2KHR properties2{};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+		properties2.pNext = &budgetProperties;
+		pGetMemoryProperties2(physicalDevice, &properties2);
+
+		stats.hasBudget = EE_TRUE;
+		for (uint32_t i = 0u; i < stats.heapCount; i++) {
+			stats.heaps[i].usage = budgetProperties.heapUsage[i];
+			stats.heaps[i].budget = budgetProperties.heapBudget[i];
+		}
+	}
+
+	return stats;
+}
+
 VkCommandPool vulkan::Device::CreateCommandPool(uint32_t queueFamilyIndex, VkCommandPoolCreateFlags createFlags) const
 {
 	VkCommandPoolCreateInfo cmdPoolCInfo;
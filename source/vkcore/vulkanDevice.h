@@ -5,6 +5,9 @@
 /////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include <mutex>
+#include <unordered_map>
+
 #include "vulkanDebug.h" //< vulkanInstance.h vulkanTools.h, vulkanInitializers.h, vulkan.h
 
 namespace EE
@@ -151,6 +154,28 @@ namespace EE
 			/* @brief Default pool for commands executing on graphic queues */
 			VkCommandPool cmdPoolGraphics{ VK_NULL_HANDLE };
 
+			/* @brief Size, heap and category of a memory allocation */
+			struct MemoryAllocation {
+				VkDeviceSize size;
+				uint32_t heapIndex;
+				EEMemoryCategory category;
+			};
+
+			/**
+			 * Memory allocated through this device per category and heap. Guarded by a mutex since
+			 * resources are created and freed by the render thread too.
+			 **/
+			mutable struct {
+				std::mutex mutex;
+				std::unordered_map<VkDeviceMemory, MemoryAllocation> allocations;
+				uint64_t categoryBytes[EE_MEMORY_CATEGORY_COUNT]{};
+				uint32_t categoryAllocations[EE_MEMORY_CATEGORY_COUNT]{};
+				uint64_t heapBytes[VK_MAX_MEMORY_HEAPS]{};
+			} memoryUsage;
+
+			/* @brief Only set if VK_EXT_memory_budget was enabled */
+			PFN_vkGetPhysicalDeviceMemoryProperties2KHR pGetMemoryProperties2{ nullptr };
+
 			/* @brief Contains the queue family indices */
 			struct {
 				uint32_t graphics;
@@ -205,6 +230,7 @@ namespace EE
 			 *
 			 * @param usageFlags					Usage of this buffer
 			 * @param memoryPropertyFlags	Memory properties
+			 * @param category						What the memory is used for (accounting)
 			 * @param size								Desired size of this buffer
 			 * @param pBufferOut							Pointer to the buffer handle that is created
 			 * @param pBufferMemoryOut		Pointer to the buffer's memory handle that is allocated
@@ -215,6 +241,7 @@ namespace EE
 			VkResult CreateBuffer(
 				VkBufferUsageFlags		usageFlags,
 				VkMemoryPropertyFlags memoryProperties,
+				EEMemoryCategory			category,
 				VkDeviceSize					size,
 				VkBuffer*							pBufferOut,
 				VkDeviceMemory*				pBufferMemoryOut,
@@ -226,6 +253,7 @@ namespace EE
 			 * @param pData							Pointer to the data the buffer should contain
 			 * @param bufferSize				Size in bytes of the data
 			 * @param usageFlags				Usage that the buffer should have
+			 * @param category					What the memory is used for (accounting)
 			 * @param pBufferOut				Pointer to where the created buffer will be stored
 			 * @param pBufferMemoryOut	Pointer to where the buffer memory will be stored
 			 **/
@@ -233,9 +261,31 @@ namespace EE
 				void const*				 pData,
 				VkDeviceSize			 bufferSize,
 				VkBufferUsageFlags usageFlags,
+				EEMemoryCategory	 category,
 				VkBuffer*					 pBufferOut,
 				VkDeviceMemory*		 pBufferMemoryOut) const;
 
+			/**
+			 * Allocates device memory and accounts it to the category passed in. All memory of the
+			 * engine should be allocated/freed with this and FreeMemory.
+			 *
+			 * @param allocInfo		Size and memory type of the allocation
+			 * @param category		What the memory is used for
+			 * @param pMemoryOut	Pointer to where the allocated memory will be stored
+			 *
+			 * @return VkResult of the vkAllocateMemory call
+			 **/
+			VkResult AllocateMemory(VkMemoryAllocateInfo const& allocInfo, EEMemoryCategory category, VkDeviceMemory* pMemoryOut) const;
+
+			/* @brief Frees memory allocated with AllocateMemory and removes it from the accounting */
+			void FreeMemory(VkDeviceMemory memory) const;
+
+			/**
+			 * Returns the memory allocated per category and per heap. If VK_EXT_memory_budget is
+			 * enabled the heaps also contain the usage and budget the driver reports for this process.
+			 **/
+			EEMemoryStats GetMemoryStats() const;
+
 			/**
 			 * Creates a command pool to allocate command buffers from
 			 *
@@ -0,0 +1,147 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: vulkanGeometryHeap.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "vulkanGeometryHeap.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace EE;
+
+/* @brief Size of a new page, pages for bigger data are as big as the data */
+#define VERTEX_PAGE_SIZE (VkDeviceSize(32u) * 1024u * 1024u)
+#define INDEX_PAGE_SIZE (VkDeviceSize(16u) * 1024u * 1024u)
+
+
+vulkan::GeometryHeap::GeometryHeap(Device const* pDevice)
+	: pDevice(pDevice)
+{}
+
+vulkan::GeometryHeap::~GeometryHeap()
+{
+	for (size_t i = 0u; i < pages.size(); i++) {
+		// Every range should be free again
+		if (pages[i]->freeRanges.size() != 1u || pages[i]->freeRanges.begin()->second != pages[i]->size) {
+			EE_PRINTA("[GEOMETRY_HEAP] Page of stride %u destroyed while ranges are still in use!\n", pages[i]->stride);
+		}
+
+		vkDestroyBuffer(*pDevice, pages[i]->buffer, pDevice->pAllocator);
+		pDevice->FreeMemory(pages[i]->memory);
+		delete pages[i];
+	}
+}
+
+void vulkan::GeometryHeap::AllocateVertices(uint32_t stride, VkDeviceSize size, Allocation* pAllocationOut)
+{
+	Allocate(stride, 0u, size, pAllocationOut);
+}
+
+void vulkan::GeometryHeap::AllocateIndices(uint32_t indexSize, VkDeviceSize size, Allocation* pAllocationOut)
+{
+	Allocate(0u, indexSize, size, pAllocationOut);
+}
+
+void vulkan::GeometryHeap::Allocate(uint32_t stride, uint32_t indexSize, VkDeviceSize size, Allocation* pAllocationOut)
+{
+	VkDeviceSize alignment = (stride) ? stride : indexSize;
+
+	// Existing pages of the stride first
+	for (size_t i = 0u; i < pages.size(); i++) {
+		if (pages[i]->stride != stride || pages[i]->indexSize != indexSize) continue;
+		if (AllocateFromPage(pages[i], alignment, size, pAllocationOut)) return;
+	}
+
+	// New page, a multiple of the stride so the whole page can be used
+	VkDeviceSize pageSize = std::max((stride) ? VERTEX_PAGE_SIZE : INDEX_PAGE_SIZE, size);
+	pageSize -= pageSize % alignment;
+	if (pageSize < size) pageSize += alignment;
+
+	Page* pPage = new Page;
+	pPage->size = pageSize;
+	pPage->stride = stride;
+	pPage->indexSize = indexSize;
+	pPage->freeRanges[0u] = pageSize;
+
+	VkBufferUsageFlags usage = ((stride) ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT) | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	VK_CHECK(pDevice->CreateBuffer(usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, EE_MEMORY_CATEGORY_MESH, pageSize,
+																 &pPage->buffer, &pPage->memory));
+	pages.push_back(pPage);
+
+	AllocateFromPage(pPage, alignment, size, pAllocationOut);
+}
+
+bool vulkan::GeometryHeap::AllocateFromPage(Page* pPage, VkDeviceSize alignment, VkDeviceSize size, Allocation* pAllocationOut)
+{
+	// First range that fits after aligning its begin
+	for (auto it = pPage->freeRanges.begin(); it != pPage->freeRanges.end(); ++it) {
+		VkDeviceSize rangeBegin = it->first;
+		VkDeviceSize rangeEnd = it->first + it->second;
+		VkDeviceSize alignedBegin = ((rangeBegin + alignment - 1u) / alignment) * alignment;
+		if (alignedBegin + size > rangeEnd) continue;
+
+		// The parts in front and behind stay free
+		pPage->freeRanges.erase(it);
+		if (alignedBegin > rangeBegin) pPage->freeRanges[rangeBegin] = alignedBegin - rangeBegin;
+		if (alignedBegin + size < rangeEnd) pPage->freeRanges[alignedBegin + size] = rangeEnd - (alignedBegin + size);
+
+		pAllocationOut->pPage = pPage;
+		pAllocationOut->offset = alignedBegin;
+		pAllocationOut->size = size;
+		return true;
+	}
+	return false;
+}
+
+void vulkan::GeometryHeap::Free(Allocation& allocation)
+{
+	if (!allocation.pPage) return;
+	std::map<VkDeviceSize, VkDeviceSize>& freeRanges = allocation.pPage->freeRanges;
+
+	// Merge with the free neighbours
+	VkDeviceSize begin = allocation.offset;
+	VkDeviceSize end = allocation.offset + allocation.size;
+
+	auto next = freeRanges.lower_bound(begin);
+	if (next != freeRanges.end() && next->first == end) {
+		end += next->second;
+		next = freeRanges.erase(next);
+	}
+	if (next != freeRanges.begin()) {
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == begin) {
+			begin = previous->first;
+			freeRanges.erase(previous);
+		}
+	}
+	freeRanges[begin] = end - begin;
+
+	allocation = Allocation();
+}
+
+void vulkan::GeometryHeap::Upload(Allocation const& allocation, VkDeviceSize offset, void const* pData, VkDeviceSize size) const
+{
+	if (!allocation.pPage || size == 0u) return;
+
+	// Create the staging buffer holding the data
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	VK_CHECK(pDevice->CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+																 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, EE_MEMORY_CATEGORY_STAGING,
+																 size, &stagingBuffer, &stagingBufferMemory, pData));
+
+	// Copy it into the range of the page
+	ExecBuffer execBuffer(pDevice, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	VkBufferCopy copyRegion;
+	copyRegion.srcOffset = 0u;
+	copyRegion.dstOffset = allocation.offset + offset;
+	copyRegion.size = size;
+	vkCmdCopyBuffer(execBuffer.cmdBuffer, stagingBuffer, allocation.pPage->buffer, 1u, &copyRegion);
+	execBuffer.EndRecording();
+	execBuffer.Execute();
+
+	// Free the staging buffer
+	pDevice->FreeMemory(stagingBufferMemory);
+	vkDestroyBuffer(*pDevice, stagingBuffer, pDevice->pAllocator);
+}
@@ -0,0 +1,118 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: vulkanGeometryHeap.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <map>
+
+#include "vulkanDevice.h"
+
+namespace EE
+{
+	namespace vulkan
+	{
+		/**
+		 * Vertex and index data of many meshes suballocated from a few big device local buffers.
+		 * Vertex pages only hold vertices of one stride, so a mesh is drawn with the vertexOffset
+		 * and firstIndex of its ranges and meshes in the same pages share their buffer binds.
+		 * Index pages only hold indices of one size, so the index type of a bound page is known.
+		 * A new page is only created once the existing ones of the stride are full.
+		 **/
+		struct GeometryHeap
+		{
+			/* @brief One big buffer of the heap */
+			struct Page {
+				VkBuffer buffer;
+				VkDeviceMemory memory;
+				VkDeviceSize size;
+				/* @brief Stride of the vertices in this page, zero for index pages */
+				uint32_t stride;
+				/* @brief Size of the indices in this page (2 or 4 bytes), zero for vertex pages */
+				uint32_t indexSize;
+				/* @brief Free ranges of the page (offset to size), neighbours are always merged */
+				std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+			};
+
+			/* @brief A range within a page */
+			struct Allocation {
+				Page* pPage{ nullptr };
+				VkDeviceSize offset{ 0u };
+				VkDeviceSize size{ 0u };
+			};
+
+			/* @brief Device the pages are created on */
+			Device const* pDevice;
+
+			/* @brief All pages of all strides, pages are kept till the heap is destroyed */
+			std::vector<Page*> pages;
+
+			/**
+			 * Default constructor
+			 *
+			 * @param pDevice		Device the pages will be created on
+			 **/
+			GeometryHeap(Device const* pDevice);
+
+			/**
+			 * Destructor, all allocations need to be freed before
+			 **/
+			~GeometryHeap();
+
+			/**
+			 * Suballocates a range for vertices of the stride passed in (aligned to a whole vertex)
+			 *
+			 * @param stride				Size of one vertex in bytes
+			 * @param size					Size of the vertex data in bytes
+			 * @param pAllocationOut	The range that was allocated
+			 **/
+			void AllocateVertices(uint32_t stride, VkDeviceSize size, Allocation* pAllocationOut);
+
+			/**
+			 * Suballocates a range for indices of the size passed in (aligned to a whole index)
+			 *
+			 * @param indexSize			Size of one index in bytes (2 or 4)
+			 * @param size					Size of the index data in bytes
+			 * @param pAllocationOut	The range that was allocated
+			 **/
+			void AllocateIndices(uint32_t indexSize, VkDeviceSize size, Allocation* pAllocationOut);
+
+			/**
+			 * Returns the range to its page and resets the allocation
+			 **/
+			void Free(Allocation& allocation);
+
+			/**
+			 * Copies the data into the allocation via a staging buffer and waits till it finished
+			 *
+			 * @param allocation		The destination range
+			 * @param offset				Offset in bytes within the range
+			 * @param pData					Pointer to the data
+			 * @param size					Size of the data in bytes
+			 **/
+			void Upload(Allocation const& allocation, VkDeviceSize offset, void const* pData, VkDeviceSize size) const;
+
+			/**
+			 * Allocates a range out of the pages of the stride/index size or a new page if none has
+			 * enough space. The offset of the range is a multiple of the stride or index size.
+			 *
+			 * @param stride		Stride of the vertices (zero for indices)
+			 * @param indexSize	Size of the indices (zero for vertices)
+			 **/
+			void Allocate(uint32_t stride, uint32_t indexSize, VkDeviceSize size, Allocation* pAllocationOut);
+
+			/**
+			 * Tries to allocate a range out of the page, returns false if there is no range big enough
+			 **/
+			static bool AllocateFromPage(Page* pPage, VkDeviceSize alignment, VkDeviceSize size, Allocation* pAllocationOut);
+
+
+			/* @brief Delete copy/move constructor/assignements */
+			GeometryHeap(GeometryHeap const&) = delete;
+			GeometryHeap(GeometryHeap&&) = delete;
+			GeometryHeap& operator=(GeometryHeap const&) = delete;
+			GeometryHeap& operator=(GeometryHeap&&) = delete;
+		};
+	}
+}
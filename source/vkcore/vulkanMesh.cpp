@@ -5,6 +5,12 @@
 /////////////////////////////////////////////////////////////////////
 #include "vulkanMesh.h"
 
+#include <cfloat>
+#include <cstring>
+
+#include "eemeshloader.h"
+#include "eeprofiler.h"
+
 /* @brief Defines for better code readibility */
 #define EEDEVICE (pRenderer->pSwapchain->pDevice)
 #define LDEVICE (*EEDEVICE)
@@ -27,13 +33,12 @@ EE::Mesh::Mesh(vulkan::Renderer const* pRenderer)
 EE::Mesh::~Mesh()
 {
 	if (isCreated) {
-		if (CUR_INDEX_BUFFER.bufferSize) {
-			vkFreeMemory(LDEVICE, CUR_INDEX_BUFFER.memory, ALLOCATOR);
-			vkDestroyBuffer(LDEVICE, CUR_INDEX_BUFFER.buffer, ALLOCATOR);
+		// Both buffers of each kind, the other one is still alive if an update wasn't recorded yet
+		for (size_t i = 0u; i < indexBuffers.size(); i++) {
+			ReleaseIndexBuffer(indexBuffers[i]);
 		}
-		if (CUR_VERTEX_BUFFER.bufferSize) {
-			vkFreeMemory(LDEVICE, CUR_VERTEX_BUFFER.memory, ALLOCATOR);
-			vkDestroyBuffer(LDEVICE, CUR_VERTEX_BUFFER.buffer, ALLOCATOR);
+		for (size_t i = 0u; i < vertexBuffers.size(); i++) {
+			ReleaseVertexBuffer(vertexBuffers[i]);
 		}
 
 		isCreated = false;
@@ -46,38 +51,120 @@ void EE::Mesh::Create(char const* fileName)
 		EE_PRINT("[MESH] Already created!\n");
 		return;
 	}
-	// @TODO
-	EE_PRINT("[MESH] Obj loading function not yet implemented!\n");
+
+	std::vector<EEPredefinedVertex> vertices;
+	std::vector<uint32_t> indices;
+	if (!tools::loadObj(fileName, vertices, indices)) {
+		EE_PRINT("[MESH] Failed to load the obj file!\n");
+		return;
+	}
+
+	// The predefined vertex input gives the mesh bounds and lets it share the geometry heap
+	Create(vertices.data(), sizeof(EEPredefinedVertex) * vertices.size(), indices, &tools::predefinedVertexInput());
+}
+
+void EE::Mesh::CreateFromMeshFile(char const* fileName)
+{
+	EE_PROFILE_SCOPE("Mesh::CreateFromMeshFile");
+
+	if (isCreated) {
+		EE_PRINT("[MESH] Already created!\n");
+		return;
+	}
+
+	tools::MeshFile meshFile;
+	if (!tools::openMeshFile(fileName, meshFile)) {
+		EE_PRINT("[MESH] Failed to open the mesh file!\n");
+		return;
+	}
+	tools::MeshFileHeader const& header = *meshFile.pHeader;
+
+	std::vector<EEShaderInputDesc> inputDescs(header.amountInputs);
+	for (uint32_t i = 0u; i < header.amountInputs; i++) {
+		inputDescs[i].location = meshFile.pInputs[i].location;
+		inputDescs[i].format = EEFormat(meshFile.pInputs[i].format);
+		inputDescs[i].offset = meshFile.pInputs[i].offset;
+	}
+	EEVertexInput vertexInput;
+	vertexInput.amountInputs = header.amountInputs;
+	vertexInput.pInputDescs = inputDescs.data();
+	vertexInput.inputStride = header.vertexStride;
+	SetVertexInput(&vertexInput);
+
+	// The bounds were computed by the converter, so the vertices are only read by the copy into the staging buffer
+	if (positionInput.components && header.boundsMin[0] <= header.boundsMax[0]) {
+		bounds.min = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+		bounds.max = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+		bounds.isValid = true;
+		bounds.version++;
+	}
+
+	CreateBuffers(meshFile.pVertices, size_t(header.vertexStride * header.amountVertices),
+								meshFile.pIndices, header.indexSize, uint32_t(header.amountIndices));
+
+	tools::closeMeshFile(meshFile);
 }
 
-void EE::Mesh::Create(void const* pData, size_t bufferSize, std::vector<uint32_t> const& indices)
+void EE::Mesh::Create(void const* pData, size_t bufferSize, std::vector<uint32_t> const& indices, EEVertexInput const* pVertexInput)
 {
 	if (isCreated) {
 		EE_PRINT("[MESH] Already created!\n");
 		return;
 	}
 
+	// Remember where the position is for the bounds of all following updates
+	SetVertexInput(pVertexInput);
+	ComputeBounds(pData, bufferSize, false);
+
+	std::vector<uint16_t> packedIndices;
+	void const* pIndexData;
+	uint32_t indexSize = PackIndices(indices.data(), uint32_t(indices.size()), packedIndices, &pIndexData);
+
+	CreateBuffers(pData, bufferSize, pIndexData, indexSize, uint32_t(indices.size()));
+}
+
+void EE::Mesh::SetVertexInput(EEVertexInput const* pVertexInput)
+{
+	if (pVertexInput) {
+		// Vertices of a known size can share the buffers of the geometry heap
+		vertexStride = pVertexInput->inputStride;
+
+		for (uint32_t i = 0u; i < pVertexInput->amountInputs; i++) {
+			EEShaderInputDesc const& input = pVertexInput->pInputDescs[i];
+			if (input.location != 0u) continue;
+
+			if (input.format == EE_FORMAT_R32G32_SFLOAT || input.format == EE_FORMAT_R32G32B32_SFLOAT) {
+				positionInput.stride = pVertexInput->inputStride;
+				positionInput.offset = input.offset;
+				positionInput.components = (input.format == EE_FORMAT_R32G32_SFLOAT) ? 2u : 3u;
+			} else {
+				EE_PRINT("[MESH] Position (location 0) is no float vector, the mesh won't have bounds!\n");
+			}
+		}
+	}
+}
+
+void EE::Mesh::CreateBuffers(void const* pData, size_t bufferSize, void const* pIndices, uint32_t indexSize, uint32_t amountIndices)
+{
 	// Initialize buffer buffering vectors
 	vertexBuffers.resize(2);
 	indexBuffers.resize(2);
 
 	// Store amount of indices
-	CUR_INDEX_BUFFER.count = uint32_t(indices.size());
+	CUR_INDEX_BUFFER.count = amountIndices;
+	capacity.vertexSize = static_cast<VkDeviceSize>(bufferSize);
+	capacity.amountIndices = amountIndices;
 
 	// Create the vertex buffer
-	CUR_VERTEX_BUFFER.bufferSize = static_cast<VkDeviceSize>(bufferSize);
-	if (CUR_VERTEX_BUFFER.bufferSize) {
-		EEDEVICE->CreateDeviceLocalBuffer(pData, CUR_VERTEX_BUFFER.bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-																			&(CUR_VERTEX_BUFFER.buffer), &(CUR_VERTEX_BUFFER.memory));
+	if (bufferSize) {
+		CreateVertexBuffer(CUR_VERTEX_BUFFER, pData, static_cast<VkDeviceSize>(bufferSize));
 	} else {
 		changeVertexBuffer = true;
 	}
 	
 	// Create the index buffer
-	CUR_INDEX_BUFFER.bufferSize = static_cast<VkDeviceSize>(sizeof(uint32_t) * CUR_INDEX_BUFFER.count);
-	if (CUR_INDEX_BUFFER.bufferSize) {
-		EEDEVICE->CreateDeviceLocalBuffer(indices.data(), CUR_INDEX_BUFFER.bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-																			&(CUR_INDEX_BUFFER.buffer), &(CUR_INDEX_BUFFER.memory));
+	if (CUR_INDEX_BUFFER.count) {
+		CreateIndexBuffer(CUR_INDEX_BUFFER, pIndices, indexSize, amountIndices);
 	} else {
 		changeIndexBuffer = true;
 	}
@@ -88,13 +175,21 @@ void EE::Mesh::Create(void const* pData, size_t bufferSize, std::vector<uint32_t
 
 void EE::Mesh::Update(void const* pData, size_t bufferSize, std::vector<uint32_t> const& indices)
 {
+	EE_PROFILE_SCOPE("Mesh::Update");
+
 	if (!isCreated) {
 		EE_PRINT("[MESH] Please create the mesh before you want to update it!\n");
 		return;
 	}
 
+	std::vector<uint16_t> packedIndices;
+	void const* pIndexData;
+	uint32_t indexSize = PackIndices(indices.data(), uint32_t(indices.size()), packedIndices, &pIndexData);
+
 	VkDeviceSize newVertexBufferSize = static_cast<VkDeviceSize>(bufferSize);
-	VkDeviceSize newIndexBufferSize = static_cast<VkDeviceSize>(sizeof(uint32_t) * indices.size());
+	VkDeviceSize newIndexBufferSize = static_cast<VkDeviceSize>(indexSize) * indices.size();
+
+	ComputeBounds(pData, bufferSize, false);
 
 
 	// VERTEX BUFFER
@@ -104,35 +199,32 @@ void EE::Mesh::Update(void const* pData, size_t bufferSize, std::vector<uint32_t
 			// note: if changeVertexBuffer is already true this method was called at least twice before
 			// the draw call and we need to release/destroy/free the previous "new" vertex buffer
 			if (changeVertexBuffer) {
-				vkFreeMemory(LDEVICE, OTHER_VERTEX_BUFFER.memory, ALLOCATOR);
-				vkDestroyBuffer(LDEVICE, OTHER_VERTEX_BUFFER.buffer, ALLOCATOR);
+				ReleaseVertexBuffer(OTHER_VERTEX_BUFFER);
 			} else {
 				changeVertexBuffer = true;
 			}
 
-			OTHER_VERTEX_BUFFER.bufferSize = newVertexBufferSize;
-			EEDEVICE->CreateDeviceLocalBuffer(pData, OTHER_VERTEX_BUFFER.bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-				&(OTHER_VERTEX_BUFFER.buffer), &(OTHER_VERTEX_BUFFER.memory));
+			CreateVertexBuffer(OTHER_VERTEX_BUFFER, pData, newVertexBufferSize);
 
 	} else if (newVertexBufferSize > 0) {
 			// Create the staging buffers
 			VkBuffer stagingBuffer;
 			VkDeviceMemory stagingBufferMemory;
 			VK_CHECK(EEDEVICE->CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-																			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+																			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, EE_MEMORY_CATEGORY_STAGING,
 																			newVertexBufferSize, &stagingBuffer, &stagingBufferMemory, pData));
 			// Copy vertex data
 			vulkan::ExecBuffer execBuffer(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true, true);
 			VkBufferCopy copyRegion;
 			copyRegion.srcOffset = 0u;
-			copyRegion.dstOffset = 0u;
+			copyRegion.dstOffset = CUR_VERTEX_BUFFER.allocation.offset;
 			copyRegion.size = newVertexBufferSize;
 			vkCmdCopyBuffer(execBuffer.cmdBuffer, stagingBuffer, CUR_VERTEX_BUFFER.buffer, 1u, &copyRegion);
 			execBuffer.EndRecording();
 			execBuffer.Execute();
 
 			// Free staging buffers
-			vkFreeMemory(LDEVICE, stagingBufferMemory, ALLOCATOR);
+			EEDEVICE->FreeMemory(stagingBufferMemory);
 			vkDestroyBuffer(LDEVICE, stagingBuffer, ALLOCATOR);
 
 	} else {
@@ -142,58 +234,114 @@ void EE::Mesh::Update(void const* pData, size_t bufferSize, std::vector<uint32_t
 
 
 	// INDEX BUFFER
-	if (newIndexBufferSize > 0 && newIndexBufferSize != CUR_INDEX_BUFFER.bufferSize) {
+	if (newIndexBufferSize > 0 && (newIndexBufferSize != CUR_INDEX_BUFFER.bufferSize || indexSize != CUR_INDEX_BUFFER.indexSize)) {
 		// Create the other index buffer and indicate for the next record to use this buffer
 		// note: if changeIndexBuffer is already true this method was called at least twice before
 		// the draw call and we need to release/destroy/free the previous "new" index buffer
 		if (changeIndexBuffer) {
-			vkFreeMemory(LDEVICE, OTHER_INDEX_BUFFER.memory, ALLOCATOR);
-			vkDestroyBuffer(LDEVICE, OTHER_INDEX_BUFFER.buffer, ALLOCATOR);
+			ReleaseIndexBuffer(OTHER_INDEX_BUFFER);
 		} else {
 			changeIndexBuffer = true;
 		}
 
-		OTHER_INDEX_BUFFER.bufferSize = newIndexBufferSize;
-		OTHER_INDEX_BUFFER.count = uint32_t(indices.size());
-		EEDEVICE->CreateDeviceLocalBuffer(indices.data(), OTHER_INDEX_BUFFER.bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-			&(OTHER_INDEX_BUFFER).buffer, &(OTHER_INDEX_BUFFER).memory);
+		CreateIndexBuffer(OTHER_INDEX_BUFFER, pIndexData, indexSize, uint32_t(indices.size()));
 
 	} else if (newIndexBufferSize > 0) {
 		// Also create a staging buffers
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
 		VK_CHECK(EEDEVICE->CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-																		VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-																		newIndexBufferSize, &stagingBuffer, &stagingBufferMemory, indices.data()));
+																		VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, EE_MEMORY_CATEGORY_STAGING,
+																		newIndexBufferSize, &stagingBuffer, &stagingBufferMemory, pIndexData));
 		// Copy index data
 		vulkan::ExecBuffer execBuffer(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true, true);
 		VkBufferCopy copyRegion;
 		copyRegion.srcOffset = 0u;
-		copyRegion.dstOffset = 0u;
+		copyRegion.dstOffset = CUR_INDEX_BUFFER.allocation.offset;
 		copyRegion.size = newIndexBufferSize;
 		vkCmdCopyBuffer(execBuffer.cmdBuffer, stagingBuffer, CUR_INDEX_BUFFER.buffer, 1u, &copyRegion);
 		execBuffer.EndRecording();
 		execBuffer.Execute();
 
 		// Free staging buffers
-		vkFreeMemory(LDEVICE, stagingBufferMemory, ALLOCATOR);
+		EEDEVICE->FreeMemory(stagingBufferMemory);
 		vkDestroyBuffer(LDEVICE, stagingBuffer, ALLOCATOR);
 
+		// A previous range update may have lowered the drawn index count
+		CUR_INDEX_BUFFER.count = uint32_t(indices.size());
+
 	} else {
 		changeIndexBuffer = true;
 	}
 }
 
-void EE::Mesh::Record(VkCommandBuffer cmdBuffer)
+bool EE::Mesh::UpdateRange(void const* pData, size_t dataOffset, size_t dataSize, uint32_t indexCount)
+{
+	if (!isCreated) {
+		EE_PRINT("[MESH] Please create the mesh before you want to update it!\n");
+		return false;
+	}
+
+	// If a new buffer is waiting for the next record we need to write into that one,
+	// otherwise the changes would get lost when the buffers are switched
+	VertexBuffer& vertexBuffer = (changeVertexBuffer) ? OTHER_VERTEX_BUFFER : CUR_VERTEX_BUFFER;
+	IndexBuffer& indexBuffer = (changeIndexBuffer) ? OTHER_INDEX_BUFFER : CUR_INDEX_BUFFER;
+
+	// Check the capacity, the caller needs to do a full update if this is exceeded
+	if (dataOffset + dataSize > vertexBuffer.bufferSize
+			|| static_cast<VkDeviceSize>(indexBuffer.indexSize) * indexCount > indexBuffer.bufferSize) {
+		return false;
+	}
+
+	if (dataSize > 0) {
+		// The bounds only grow, the rest of the buffer is still there
+		ComputeBounds(pData, dataSize, true);
+
+		// Create the staging buffer just as big as the changed range
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		VK_CHECK(EEDEVICE->CreateBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+																		VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, EE_MEMORY_CATEGORY_STAGING,
+																		static_cast<VkDeviceSize>(dataSize), &stagingBuffer, &stagingBufferMemory, pData));
+		// Copy the vertex data to the desired offset
+		vulkan::ExecBuffer execBuffer(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true, true);
+		VkBufferCopy copyRegion;
+		copyRegion.srcOffset = 0u;
+		copyRegion.dstOffset = vertexBuffer.allocation.offset + static_cast<VkDeviceSize>(dataOffset);
+		copyRegion.size = static_cast<VkDeviceSize>(dataSize);
+		vkCmdCopyBuffer(execBuffer.cmdBuffer, stagingBuffer, vertexBuffer.buffer, 1u, &copyRegion);
+		execBuffer.EndRecording();
+		execBuffer.Execute();
+
+		// Free staging buffers
+		EEDEVICE->FreeMemory(stagingBufferMemory);
+		vkDestroyBuffer(LDEVICE, stagingBuffer, ALLOCATOR);
+	}
+
+	// The index data stays as it is, just the amount that is drawn changes
+	indexBuffer.count = indexCount;
+
+	return true;
+}
+
+void EE::Mesh::Record(VkCommandBuffer cmdBuffer, uint32_t firstIndex, uint32_t indexCount, vulkan::RecordStats* pStats, vulkan::BindState* pBindState)
+{
+	if (!Bind(cmdBuffer, pStats, pBindState)) return;
+
+	// Draw the desired range if any of it is valid
+	indexCount = ClampIndexCount(firstIndex, indexCount);
+	if (indexCount == 0u) return;
+
+	vkCmdDrawIndexed(cmdBuffer, indexCount, 1u, GetFirstIndex() + firstIndex, GetVertexOffset(), 0u);
+	if (pStats) pStats->drawCalls++;
+}
+
+void EE::Mesh::SwitchBuffers()
 {
 	// Will destroy the current vertex buffer if it exists and will switch to the other one
 	// if it exists. Will only be entered once, per "set-to-true" of changeVertexBuffer
 	if (changeVertexBuffer) {
-		if (CUR_VERTEX_BUFFER.bufferSize) {
-			vkFreeMemory(LDEVICE, CUR_VERTEX_BUFFER.memory, ALLOCATOR);
-			vkDestroyBuffer(LDEVICE, CUR_VERTEX_BUFFER.buffer, ALLOCATOR);
-			CUR_VERTEX_BUFFER.bufferSize = 0;
-		}
+		ReleaseVertexBuffer(CUR_VERTEX_BUFFER);
 
 		if (OTHER_VERTEX_BUFFER.bufferSize) {
 			curVertexBuffer = (curVertexBuffer + 1) % 2;
@@ -204,11 +352,7 @@ void EE::Mesh::Record(VkCommandBuffer cmdBuffer)
 
 	// Similiar to the vertex buffer check above
 	if (changeIndexBuffer) {
-		if (CUR_INDEX_BUFFER.bufferSize) {
-			vkFreeMemory(LDEVICE, CUR_INDEX_BUFFER.memory, ALLOCATOR);
-			vkDestroyBuffer(LDEVICE, CUR_INDEX_BUFFER.buffer, ALLOCATOR);
-			CUR_INDEX_BUFFER.bufferSize = 0;
-		}
+		ReleaseIndexBuffer(CUR_INDEX_BUFFER);
 
 		// Only switch if other exists
 		if (OTHER_INDEX_BUFFER.bufferSize) {
@@ -217,15 +361,154 @@ void EE::Mesh::Record(VkCommandBuffer cmdBuffer)
 
 		changeIndexBuffer = false;
 	}
+}
+
+bool EE::Mesh::Bind(VkCommandBuffer cmdBuffer, vulkan::RecordStats* pStats, vulkan::BindState* pBindState)
+{
+	SwitchBuffers();
+
+	// Only a mesh with both buffers can be drawn
+	if (!CUR_VERTEX_BUFFER.bufferSize || !CUR_INDEX_BUFFER.bufferSize) return false;
+
+	// Meshes of the same geometry heap pages share their binds
+	if (pBindState && pBindState->vertexBuffer == CUR_VERTEX_BUFFER.buffer && pBindState->indexBuffer == CUR_INDEX_BUFFER.buffer) {
+		return true;
+	}
+
+	VkDeviceSize offset{ 0 };
+	vkCmdBindVertexBuffers(cmdBuffer, 0u, 1u, &(CUR_VERTEX_BUFFER.buffer), &offset);
+	vkCmdBindIndexBuffer(cmdBuffer, CUR_INDEX_BUFFER.buffer, 0,
+											 (CUR_INDEX_BUFFER.indexSize == sizeof(uint16_t)) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+	if (pStats) pStats->bufferBinds++;
+
+	if (pBindState) {
+		pBindState->vertexBuffer = CUR_VERTEX_BUFFER.buffer;
+		pBindState->indexBuffer = CUR_INDEX_BUFFER.buffer;
+	}
+	return true;
+}
+
+VkBuffer EE::Mesh::GetVertexBuffer() const
+{
+	return (vertexBuffers.size() && CUR_VERTEX_BUFFER.bufferSize) ? CUR_VERTEX_BUFFER.buffer : VK_NULL_HANDLE;
+}
+
+VkBuffer EE::Mesh::GetIndexBuffer() const
+{
+	return (indexBuffers.size() && CUR_INDEX_BUFFER.bufferSize) ? CUR_INDEX_BUFFER.buffer : VK_NULL_HANDLE;
+}
+
+uint32_t EE::Mesh::GetFirstIndex() const
+{
+	return uint32_t(CUR_INDEX_BUFFER.allocation.offset / CUR_INDEX_BUFFER.indexSize);
+}
+
+int32_t EE::Mesh::GetVertexOffset() const
+{
+	return (vertexStride) ? int32_t(CUR_VERTEX_BUFFER.allocation.offset / vertexStride) : 0;
+}
+
+void EE::Mesh::CreateVertexBuffer(VertexBuffer& vertexBuffer, void const* pData, VkDeviceSize size)
+{
+	vertexBuffer.bufferSize = size;
+
+	// Without a known stride the vertex offset of a range couldn't be computed
+	if (vertexStride) {
+		pRenderer->pGeometryHeap->AllocateVertices(vertexStride, size, &vertexBuffer.allocation);
+		pRenderer->pGeometryHeap->Upload(vertexBuffer.allocation, 0u, pData, size);
+		vertexBuffer.buffer = vertexBuffer.allocation.pPage->buffer;
+		vertexBuffer.memory = VK_NULL_HANDLE;
+	} else {
+		EEDEVICE->CreateDeviceLocalBuffer(pData, size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, EE_MEMORY_CATEGORY_MESH,
+																			&(vertexBuffer.buffer), &(vertexBuffer.memory));
+	}
+}
+
+void EE::Mesh::CreateIndexBuffer(IndexBuffer& indexBuffer, void const* pIndices, uint32_t indexSize, uint32_t amountIndices)
+{
+	VkDeviceSize size = static_cast<VkDeviceSize>(indexSize) * amountIndices;
+	indexBuffer.count = amountIndices;
+	indexBuffer.indexSize = indexSize;
+	indexBuffer.bufferSize = size;
+
+	if (vertexStride) {
+		pRenderer->pGeometryHeap->AllocateIndices(indexSize, size, &indexBuffer.allocation);
+		pRenderer->pGeometryHeap->Upload(indexBuffer.allocation, 0u, pIndices, size);
+		indexBuffer.buffer = indexBuffer.allocation.pPage->buffer;
+		indexBuffer.memory = VK_NULL_HANDLE;
+	} else {
+		EEDEVICE->CreateDeviceLocalBuffer(pIndices, size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, EE_MEMORY_CATEGORY_MESH,
+																			&(indexBuffer.buffer), &(indexBuffer.memory));
+	}
+}
+
+uint32_t EE::Mesh::PackIndices(uint32_t const* pIndices, uint32_t amountIndices, std::vector<uint16_t>& packedOut, void const** ppDataOut)
+{
+	*ppDataOut = pIndices;
+	for (uint32_t i = 0u; i < amountIndices; i++) {
+		if (pIndices[i] > UINT16_MAX) return sizeof(uint32_t);
+	}
+
+	packedOut.resize(amountIndices);
+	for (uint32_t i = 0u; i < amountIndices; i++) packedOut[i] = uint16_t(pIndices[i]);
+	*ppDataOut = packedOut.data();
+	return sizeof(uint16_t);
+}
+
+void EE::Mesh::ReleaseVertexBuffer(VertexBuffer& vertexBuffer)
+{
+	if (!vertexBuffer.bufferSize) return;
+
+	if (vertexBuffer.allocation.pPage) {
+		pRenderer->pGeometryHeap->Free(vertexBuffer.allocation);
+	} else {
+		EEDEVICE->FreeMemory(vertexBuffer.memory);
+		vkDestroyBuffer(LDEVICE, vertexBuffer.buffer, ALLOCATOR);
+	}
+	vertexBuffer.bufferSize = 0u;
+}
+
+void EE::Mesh::ReleaseIndexBuffer(IndexBuffer& indexBuffer)
+{
+	if (!indexBuffer.bufferSize) return;
+
+	if (indexBuffer.allocation.pPage) {
+		pRenderer->pGeometryHeap->Free(indexBuffer.allocation);
+	} else {
+		EEDEVICE->FreeMemory(indexBuffer.memory);
+		vkDestroyBuffer(LDEVICE, indexBuffer.buffer, ALLOCATOR);
+	}
+	indexBuffer.bufferSize = 0u;
+}
+
+uint32_t EE::Mesh::ClampIndexCount(uint32_t firstIndex, uint32_t indexCount) const
+{
+	// Clamp the desired range to the indices that are currently valid
+	if (firstIndex >= CUR_INDEX_BUFFER.count) return 0u;
+	uint32_t maxCount = CUR_INDEX_BUFFER.count - firstIndex;
+	return (indexCount && indexCount < maxCount) ? indexCount : maxCount;
+}
+
+void EE::Mesh::ComputeBounds(void const* pData, size_t dataSize, bool extend)
+{
+	if (positionInput.components == 0u || !pData) return;
 
-	// Draw this mesh if the index/vertex buffer exist
-	if (CUR_VERTEX_BUFFER.bufferSize && CUR_INDEX_BUFFER.bufferSize) {
-		// Bind buffer
-		VkDeviceSize offset{ 0 };
-		vkCmdBindVertexBuffers(cmdBuffer, 0u, 1u, &(CUR_VERTEX_BUFFER.buffer), &offset);
-		vkCmdBindIndexBuffer(cmdBuffer, CUR_INDEX_BUFFER.buffer, 0, VK_INDEX_TYPE_UINT32);
+	size_t amountVertices = dataSize / positionInput.stride;
+	if (amountVertices == 0u) return;
 
-		// Draw indexed
-		vkCmdDrawIndexed(cmdBuffer, CUR_INDEX_BUFFER.count, 1u, 0u, 0u, 0u);
+	if (!extend || !bounds.isValid) {
+		bounds.min = glm::vec3(FLT_MAX);
+		bounds.max = glm::vec3(-FLT_MAX);
 	}
-}
\ No newline at end of file
+
+	unsigned char const* pVertex = static_cast<unsigned char const*>(pData) + positionInput.offset;
+	for (size_t i = 0u; i < amountVertices; i++, pVertex += positionInput.stride) {
+		float position[3] = { 0.0f, 0.0f, 0.0f };
+		memcpy(position, pVertex, sizeof(float) * positionInput.components);
+
+		bounds.min = glm::min(bounds.min, glm::vec3(position[0], position[1], position[2]));
+		bounds.max = glm::max(bounds.max, glm::vec3(position[0], position[1], position[2]));
+	}
+	bounds.isValid = true;
+	bounds.version++;
+}
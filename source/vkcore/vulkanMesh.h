@@ -6,6 +6,7 @@
 #pragma once
 
 #include "vulkanRenderer.h"
+#include "vulkanGeometryHeap.h"
 
 namespace EE
 {
@@ -14,19 +15,28 @@ namespace EE
 		/* @brief The renderer this mesh uses */
 		vulkan::Renderer const* pRenderer;
 
-		/* @brief Holds informations about the vertex buffer */
+		/**
+		 * Holds informations about the vertex buffer. If it was allocated from the renderer's geometry
+		 * heap, buffer is the page's buffer and the data starts at the allocation's offset.
+		 **/
 		struct VertexBuffer{
 			VkDeviceSize bufferSize{ 0u };
 			VkBuffer buffer;
 			VkDeviceMemory memory;
+			vulkan::GeometryHeap::Allocation allocation;
 		};
 
-		/* @brief Holds informations about the index buffer */
+		/**
+		 * Holds informations about the index buffer (allocated like the vertex buffer). Indices are
+		 * stored with 16 bit whenever all of them fit, which halves the index bandwidth.
+		 **/
 		struct IndexBuffer {
 			uint32_t count;
+			uint32_t indexSize{ sizeof(uint32_t) };
 			VkDeviceSize bufferSize{ 0u };
 			VkBuffer buffer;
 			VkDeviceMemory memory;
+			vulkan::GeometryHeap::Allocation allocation;
 		};
 
 		std::vector<VertexBuffer> vertexBuffers;
@@ -40,6 +50,37 @@ namespace EE
 		/* @brief Indicates wether this mesh can be used */
 		bool isCreated{ false };
 
+		/* @brief Size of a vertex, only known if the vertex input was passed in. Otherwise the buffers are dedicated */
+		uint32_t vertexStride{ 0u };
+
+		/**
+		 * Where the position (the vertex input at location 0) is within a vertex, only known if the
+		 * vertex input was passed in on creation. Without it the mesh has no bounds.
+		 **/
+		struct {
+			uint32_t stride{ 0u };
+			uint32_t offset{ 0u };
+			uint32_t components{ 0u };
+		} positionInput;
+
+		/* @brief Axis aligned bounding box of all vertex positions in the vertex buffer */
+		struct {
+			glm::vec3 min;
+			glm::vec3 max;
+			bool isValid{ false };
+			/* @brief Increased every time the bounds change, so users of them know when to update */
+			uint32_t version{ 0u };
+		} bounds;
+
+		/**
+		 * Capacity of the buffers after every update requested so far, also the ones the render
+		 * thread didn't apply yet. Only touched by the thread updating the mesh (see Graphics).
+		 **/
+		struct {
+			VkDeviceSize vertexSize{ 0u };
+			uint32_t amountIndices{ 0u };
+		} capacity;
+
 		/**
 		 * Default constructor
 		 *
@@ -53,25 +94,33 @@ namespace EE
 		~Mesh();
 
 		/**
-		 * Creates the mesh from an obj wavefront file
-		 *
-		 * @TODO:: Not implemented yet, cause no priority here
+		 * Creates the mesh from an obj wavefront file, the vertices are EEPredefinedVertex
+		 * (see tools::loadObj). The mesh stays uncreated if the file couldn't be loaded.
 		 **/
 		void Create(char const* fileName);
 
+		/**
+		 * Creates the mesh from a binary mesh file (see tools::writeMeshFile). The file is mapped, so
+		 * the vertices and indices are copied straight from the mapping into the staging buffers.
+		 * The mesh stays uncreated if the file isn't a valid mesh file.
+		 **/
+		void CreateFromMeshFile(char const* fileName);
+
 		/**
 		 * Creates a mesh from the void data and indices passed in.
 		 * The data passed in needs to match the custom defined vertex input descriptions
 		 * the shader was created with.
 		 *
-		 * @param pData				Pointer to the vertex data
-		 * @param bufferSize	Size of the vertex data in bytes
-		 * @param indices			List of indices (always have to be uint32_t)
+		 * @param pData					Pointer to the vertex data
+		 * @param bufferSize		Size of the vertex data in bytes
+		 * @param indices				List of indices (stored as 16 bit if all of them fit)
+		 * @param pVertexInput	Vertex input the data matches, used to compute the bounds (optional)
 		 **/
 		void Create(
 			void const*									 pData,
 			size_t											 bufferSize,
-			std::vector<uint32_t> const& indices);
+			std::vector<uint32_t> const& indices,
+			EEVertexInput const*				 pVertexInput = nullptr);
 
 		/**
 		 * Updates the data of the mesh.
@@ -87,13 +136,126 @@ namespace EE
 			size_t											 bufferSize,
 			std::vector<uint32_t> const& indices);
 
+		/**
+		 * Overwrites a part of the vertex data and sets the amount of indices that will be drawn,
+		 * without reallocating any buffer. Used for data that is only partially changing like
+		 * texts while typing, where the buffers were created with spare capacity.
+		 * @note Targets the buffer that will be used by the next record
+		 *
+		 * @param pData				Pointer to the new vertex data (can be nullptr if dataSize is zero)
+		 * @param dataOffset	Offset in bytes into the vertex buffer where the data will be written to
+		 * @param dataSize		Size of the new vertex data in bytes
+		 * @param indexCount	The amount of indices that will be drawn from now on
+		 *
+		 * @return False if the range or index count exceeds the current capacity of the buffers
+		 **/
+		bool UpdateRange(
+			void const*	pData,
+			size_t			dataOffset,
+			size_t			dataSize,
+			uint32_t		indexCount);
+
 		/**
 		 * Records the draw calls of this mesh using the previous recorded shader
 		 * on the passed in command buffer.
 		 *
 		 * @param cmdBuffer		Command buffer this mesh will be record on
+		 * @param firstIndex	First index to draw (defaulted)
+		 * @param indexCount	Amount of indices to draw, zero draws all indices behind firstIndex (defaulted)
+		 * @param pStats			Counts of the recorded commands that will be incremented (optional)
+		 * @param pBindState	Buffers currently bound to the command buffer, they aren't bound again (optional)
+		 **/
+		void Record(VkCommandBuffer cmdBuffer, uint32_t firstIndex = 0u, uint32_t indexCount = 0u,
+								vulkan::RecordStats* pStats = nullptr, vulkan::BindState* pBindState = nullptr);
+
+		/**
+		 * Switches to the buffers of the last update if there are some, the previous ones are released
+		 **/
+		void SwitchBuffers();
+
+		/**
+		 * Switches the buffers if needed and binds the vertex and index buffer to the passed in
+		 * command buffer, unless they are already bound
+		 *
+		 * @param cmdBuffer		Command buffer the buffers are bound to
+		 * @param pStats			Counts of the recorded commands that will be incremented (optional)
+		 * @param pBindState	Buffers currently bound to the command buffer, updated if they change (optional)
+		 *
+		 * @return False if there is no vertex or index buffer to draw from
+		 **/
+		bool Bind(VkCommandBuffer cmdBuffer, vulkan::RecordStats* pStats = nullptr, vulkan::BindState* pBindState = nullptr);
+
+		/* @brief Returns the vertex/index buffer that is drawn from (VK_NULL_HANDLE if there is none) */
+		VkBuffer GetVertexBuffer() const;
+		VkBuffer GetIndexBuffer() const;
+
+		/* @brief Returns the first index and vertex offset of this mesh within its buffers */
+		uint32_t GetFirstIndex() const;
+		int32_t GetVertexOffset() const;
+
+		/**
+		 * Creates the vertex buffer with the data passed in, allocated from the geometry heap if the
+		 * vertex stride is known
+		 **/
+		void CreateVertexBuffer(VertexBuffer& vertexBuffer, void const* pData, VkDeviceSize size);
+
+		/**
+		 * Creates the index buffer with the indices passed in, allocated from the geometry heap
+		 * if the vertices are
+		 *
+		 * @param pIndices			Pointer to the indices
+		 * @param indexSize			Size of one of the indices in bytes (2 or 4)
+		 * @param amountIndices	Amount of indices
+		 **/
+		void CreateIndexBuffer(IndexBuffer& indexBuffer, void const* pIndices, uint32_t indexSize, uint32_t amountIndices);
+
+		/**
+		 * Packs the indices into 16 bit if every index is below 65536
+		 *
+		 * @param pIndices			Pointer to the indices
+		 * @param amountIndices	Amount of indices
+		 * @param packedOut			Will hold the packed indices if they fit
+		 * @param ppDataOut			Will point to the data to upload (the packed or the passed in indices)
+		 *
+		 * @return Size of one index of the data to upload
+		 **/
+		static uint32_t PackIndices(uint32_t const* pIndices, uint32_t amountIndices, std::vector<uint16_t>& packedOut, void const** ppDataOut);
+
+		/* @brief Releases the buffer or returns its range to the geometry heap */
+		void ReleaseVertexBuffer(VertexBuffer& vertexBuffer);
+		void ReleaseIndexBuffer(IndexBuffer& indexBuffer);
+
+		/**
+		 * Returns the amount of indices to draw of the range passed in, clamped to the indices that
+		 * are currently valid (zero if the range is completely outside of them)
+		 **/
+		uint32_t ClampIndexCount(uint32_t firstIndex, uint32_t indexCount) const;
+
+		/**
+		 * Remembers the vertex stride and where the position is within a vertex, if a vertex input
+		 * is passed in
+		 **/
+		void SetVertexInput(EEVertexInput const* pVertexInput);
+
+		/**
+		 * Creates the first vertex and index buffers and marks the mesh as created
+		 *
+		 * @param pData					Pointer to the vertex data
+		 * @param bufferSize		Size of the vertex data in bytes
+		 * @param pIndices			Pointer to the indices
+		 * @param indexSize			Size of one of the indices in bytes (2 or 4)
+		 * @param amountIndices	Amount of indices
+		 **/
+		void CreateBuffers(void const* pData, size_t bufferSize, void const* pIndices, uint32_t indexSize, uint32_t amountIndices);
+
+		/**
+		 * Computes the bounds of the vertex data passed in, if the position input is known
+		 *
+		 * @param pData			Pointer to whole vertices
+		 * @param dataSize	Size of the vertex data in bytes
+		 * @param extend		Wether the current bounds are extended or replaced
 		 **/
-		void Record(VkCommandBuffer cmdBuffer);
+		void ComputeBounds(void const* pData, size_t dataSize, bool extend);
 
 
 		/* @brief Delete copy/move constructor/assignements */
@@ -59,13 +59,24 @@ bool EE::Object::Create(std::vector<EEObjectResourceBinding> const& bindings,
 	return true;
 }
 
+void EE::Object::SetTexture(uint32_t binding, Texture const* pTexture)
+{
+	assert(isCreated && pShader->settings.amountDescriptors);
+	pShader->UpdateDescriptorTexture(descriptorSet, binding, pTexture);
+}
+
 void EE::Object::Record(VkCommandBuffer cmdBuffer)
 {
 	if (!isVisible) return;
 
+	Record(cmdBuffer, firstIndex, indexCount);
+}
+
+void EE::Object::Record(VkCommandBuffer cmdBuffer, uint32_t firstIndex, uint32_t indexCount, vulkan::RecordStats* pStats, vulkan::BindState* pBindState)
+{
 	// Record shader
-	pShader->Record(cmdBuffer, (pShader->settings.amountDescriptors) ? &descriptorSet : nullptr);
+	pShader->Record(cmdBuffer, (pShader->settings.amountDescriptors) ? &descriptorSet : nullptr, pStats);
 
 	// Record now the mesh and its draw call
-	pMesh->Record(cmdBuffer);
+	pMesh->Record(cmdBuffer, firstIndex, indexCount, pStats, pBindState);
 }
\ No newline at end of file
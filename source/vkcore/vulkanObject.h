@@ -34,6 +34,24 @@ namespace EE
 
 		bool isVisible{ true };
 
+		/* @brief Range of the mesh' indices this object draws (indexCount of zero draws the whole mesh) */
+		uint32_t firstIndex{ 0u };
+		uint32_t indexCount{ 0u };
+
+		/* @brief World matrix the bounds of the mesh are transformed with for culling */
+		glm::mat4 world{ 1.0f };
+
+		/* @brief State of the 3d culling, only used by the renderer while recording */
+		struct {
+			/* @brief Leaf of this object in the renderer's tree (NULL_PROXY if not inserted) */
+			int32_t proxy{ -1 };
+			/* @brief World matrix and bounds version the leaf was last updated with */
+			glm::mat4 world{ 1.0f };
+			uint32_t boundsVersion{ 0u };
+			/* @brief Last frame this object was inside of the frustum */
+			uint32_t visibleFrame{ 0u };
+		} culling;
+
 		/* @brief Indicates wether this object is created to a state where it can be used */
 		bool isCreated{ false };
 
@@ -70,6 +88,15 @@ namespace EE
 			std::vector<Texture*> const&								textures,
 			std::vector<Buffer*> const&								buffers);
 
+		/**
+		 * Binds another texture to a sampler of this object. Must not be called while
+		 * a pending command buffer uses the object.
+		 *
+		 * @param binding			Binding of the sampler
+		 * @param pTexture		The texture that will be bound
+		 **/
+		void SetTexture(uint32_t binding, Texture const* pTexture);
+
 		/**
 		 * Record this object into the passed in command buffer
 		 *
@@ -77,6 +104,18 @@ namespace EE
 		 **/
 		void Record(VkCommandBuffer cmdBuffer);
 
+		/**
+		 * Record this object drawing only the range of the mesh passed in, regardless of its visibility
+		 *
+		 * @param cmdBuffer		The command buffer this objects calls will be recorded to
+		 * @param firstIndex	First index of the mesh to draw
+		 * @param indexCount	Amount of indices to draw (zero draws all indices behind firstIndex)
+		 * @param pStats			Counts of the recorded commands that will be incremented (optional)
+		 * @param pBindState	Buffers currently bound to the command buffer (optional)
+		 **/
+		void Record(VkCommandBuffer cmdBuffer, uint32_t firstIndex, uint32_t indexCount,
+								vulkan::RecordStats* pStats = nullptr, vulkan::BindState* pBindState = nullptr);
+
 
 		// Delete copy/move constructor/assignements
 		Object(Object const&) = delete;
@@ -107,7 +107,7 @@ EE::Pipeline::~Pipeline()
 	}
 }
 
-void EE::Pipeline::Create(VkDescriptorSetLayout* pDescriptorSetLayout, bool use2D)
+void EE::Pipeline::Create(VkDescriptorSetLayout* pDescriptorSetLayout, bool use2D, bool useDrawData)
 {
 	if (!isInitialized) {
 		EE_PRINT("[PIPELINE] Creation failed pipeline was not initialzed!\n");
@@ -123,19 +123,27 @@ void EE::Pipeline::Create(VkDescriptorSetLayout* pDescriptorSetLayout, bool use2
 		vertexShaderStageCInfo, fragmentShaderStageCInfo
 	};
 
+	// Set 0 is the shader's own, the draw data of indirect draws is set 1 (set 0 is empty if the shader has none)
+	std::vector<VkDescriptorSetLayout> setLayouts;
+	if (pDescriptorSetLayout) setLayouts.push_back(*pDescriptorSetLayout);
+	if (useDrawData) {
+		if (setLayouts.empty()) setLayouts.push_back(pRenderer->indirect.emptySetLayout);
+		setLayouts.push_back(pRenderer->indirect.setLayout);
+	}
+
 	// Create the pipeline layout
 	VkPipelineLayoutCreateInfo pipelineLayoutCInfo;
 	pipelineLayoutCInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutCInfo.pNext = nullptr;
 	pipelineLayoutCInfo.flags = 0;
-	pipelineLayoutCInfo.setLayoutCount = 1u;
-	pipelineLayoutCInfo.pSetLayouts = pDescriptorSetLayout;
+	pipelineLayoutCInfo.setLayoutCount = uint32_t(setLayouts.size());
+	pipelineLayoutCInfo.pSetLayouts = setLayouts.data();
 	pipelineLayoutCInfo.pushConstantRangeCount = uint32_t(pushConstants.size());
 	pipelineLayoutCInfo.pPushConstantRanges = pushConstants.data();
 	VK_CHECK(vkCreatePipelineLayout(LDEVICE, &pipelineLayoutCInfo, ALLOCATOR, &pipelineLayout));
 
-	// Determine renderpass that should be used
-	VkRenderPass usedRenderPass = (use2D) ? pRenderer->renderPass2D : pRenderer->renderPass3D;
+	// Both renderers share one render pass, they are distinguished by the subpass
+	uint32_t usedSubpass = (use2D) ? pRenderer->subpass2D : pRenderer->subpass3D;
 	if (use2D && !pRenderer->isCreated2D) {
 		EE_PRINT("[PIPELINE] 2D renderer desired but was never created!\n");
 		tools::exitFatal("[PIPELINE] 2D renderer desired but was never created!\n");
@@ -161,8 +169,8 @@ void EE::Pipeline::Create(VkDescriptorSetLayout* pDescriptorSetLayout, bool use2
 	pipelineCInfo.pColorBlendState = &colorBlendCInfo;
 	pipelineCInfo.pDynamicState = &dynamicsCInfo;
 	pipelineCInfo.layout = pipelineLayout;
-	pipelineCInfo.renderPass = usedRenderPass;
-	pipelineCInfo.subpass = 0;
+	pipelineCInfo.renderPass = pRenderer->renderPass;
+	pipelineCInfo.subpass = usedSubpass;
 	pipelineCInfo.basePipelineHandle = VK_NULL_HANDLE; // If used at some time, set flags to derivative bit
 	pipelineCInfo.basePipelineIndex = -1;
 	VK_CHECK(vkCreateGraphicsPipelines(LDEVICE, pipelineCache, 1u, &pipelineCInfo, ALLOCATOR, &pipeline));
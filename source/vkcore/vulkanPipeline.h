@@ -78,8 +78,9 @@ namespace EE
 		 *
 		 * @param pDescriptorSetLayout	Layout of the descriptor sets desired for the shader
 		 * @param use2DRenderPass				Indicate wether which renderer should be used
+		 * @param useDrawData					Wether the renderer's draw data is bound as set 1 (indirect draws)
 		 **/
-		void Create(VkDescriptorSetLayout* pDescriptorSetLayout, bool use2DRenderPass);
+		void Create(VkDescriptorSetLayout* pDescriptorSetLayout, bool use2DRenderPass, bool useDrawData = false);
 
 		/**
 		 * Call before the create method so it can use the here created pipeline cache
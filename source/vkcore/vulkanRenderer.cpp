@@ -5,8 +5,14 @@
 /////////////////////////////////////////////////////////////////////
 #include "vulkanRenderer.h"
 
+#include <algorithm>
+
 #include "eehelper.h"
+#include "eeprofiler.h"
 #include "vulkanObject.h"
+#include "vulkanMesh.h"
+#include "vulkanShader.h"
+#include "vulkanGeometryHeap.h"
 
 using namespace EE;
 
@@ -14,6 +20,11 @@ using namespace EE;
 #define LDEVICE *(EEDEVICE)
 #define ALLOCATOR EEDEVICE->pAllocator
 
+/* @brief Begin/end timestamp of the 3d and 2d subpass */
+#define TIMESTAMPS_PER_IMAGE 4u
+/* @brief Amount of commands the indirect buffers of a render buffer can hold at least */
+#define MIN_INDIRECT_CAPACITY 64u
+
 
 //-------------------------------------------------------------------
 // DepthImage
@@ -105,7 +116,7 @@ void vulkan::DepthImage::Create()
 	VkMemoryAllocateInfo allocInfo = initializers::memoryAllocateInfo();
 	allocInfo.allocationSize = memReqs.size;
 	allocInfo.memoryTypeIndex = EEDEVICE->GetMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	VK_CHECK(vkAllocateMemory(LDEVICE, &allocInfo, ALLOCATOR, &imageMemory));
+	VK_CHECK(EEDEVICE->AllocateMemory(allocInfo, EE_MEMORY_CATEGORY_DEPTH_IMAGE, &imageMemory));
 
 	// Bind image to memory
 	VK_CHECK(vkBindImageMemory(LDEVICE, image, imageMemory, 0u));
@@ -150,7 +161,7 @@ void vulkan::DepthImage::Release()
 {
 	if (isCreated) {
 		vkDestroyImageView(LDEVICE, imageView, ALLOCATOR);
-		vkFreeMemory(LDEVICE, imageMemory, ALLOCATOR);
+		EEDEVICE->FreeMemory(imageMemory);
 		vkDestroyImage(LDEVICE, image, ALLOCATOR);
 
 		isCreated = false;
@@ -170,6 +181,9 @@ vulkan::Renderer::Renderer(Swapchain* pSwapchain, EEApplicationCreateInfo const&
 	// Store settings
 	this->settings.splitscreen = settings.splitscreen;
 
+	// The meshes' vertex and index data
+	pGeometryHeap = new GeometryHeap(pSwapchain->pDevice);
+
 	// Input assembly state info
 	inputAssemblyState = initializers::inputAssemblyStateCInfo();
 
@@ -243,43 +257,37 @@ vulkan::Renderer::Renderer(Swapchain* pSwapchain, EEApplicationCreateInfo const&
 	blendState.blendConstants[3] = 0.0f;
 
 
-	// Initialize buffer lists for both to the desired size no matter if needed
-	buffers2D.resize(pSwapchain->buffers.size());
-	buffers3D.resize(pSwapchain->buffers.size());
+	// One render buffer per swapchain image
+	buffers.resize(pSwapchain->buffers.size());
+
+	// Gpu timings
+	CreateTimestampPool();
 }
 
 vulkan::Renderer::~Renderer()
 {
-	// 3D Renderer
-	if (isCreated3D) {
-		vkDestroyRenderPass(LDEVICE, renderPass3D, ALLOCATOR);
-
-		for (size_t i = 0u; i < buffers3D.size(); i++) {
-			vkDestroyFramebuffer(LDEVICE, buffers3D[i].framebuffer, ALLOCATOR);
-		}
+	if (isCreated3D || isCreated2D) {
+		ReleaseRenderBuffers();
+		vkDestroyRenderPass(LDEVICE, renderPass, ALLOCATOR);
 
-		if (pDepthImage) delete pDepthImage;
-
-		vkDestroySemaphore(LDEVICE, semaphores.imageRendered3D, ALLOCATOR);
+		vkDestroySemaphore(LDEVICE, semaphores.imageRendered, ALLOCATOR);
+		vkDestroySemaphore(LDEVICE, semaphores.imageAvailable, ALLOCATOR);
 
 		isCreated3D = false;
+		isCreated2D = false;
 	}
 
+	if (pDepthImage) delete pDepthImage;
+	if (pGeometryHeap) delete pGeometryHeap;
 
-	// 2D Renderer
-	if (isCreated2D) {
-		vkDestroyRenderPass(LDEVICE, renderPass2D, ALLOCATOR);
-
-		for (size_t i = 0u; i < buffers2D.size(); i++) {
-			vkDestroyFramebuffer(LDEVICE, buffers2D[i].framebuffer, ALLOCATOR);
-		}
-
-		vkDestroySemaphore(LDEVICE, semaphores.imageRendered2D, ALLOCATOR);
-
-		isCreated2D = false;
+	if (indirect.setLayout != VK_NULL_HANDLE) {
+		vkDestroyDescriptorSetLayout(LDEVICE, indirect.setLayout, ALLOCATOR);
+		vkDestroyDescriptorSetLayout(LDEVICE, indirect.emptySetLayout, ALLOCATOR);
 	}
 
-	vkDestroySemaphore(LDEVICE, semaphores.imageAvailable, ALLOCATOR);
+	if (timestamps.pool != VK_NULL_HANDLE) {
+		vkDestroyQueryPool(LDEVICE, timestamps.pool, ALLOCATOR);
+	}
 }
 
 void vulkan::Renderer::Create3D()
@@ -295,237 +303,201 @@ void vulkan::Renderer::Create3D()
 	// Creates/Recreates the pDepthImage
 	pDepthImage->Create();
 
+	isCreated3D = true;
+	CreateRenderPass();
+}
+
+void vulkan::Renderer::Create2D()
+{
+	if (isCreated2D) return;
+
+	isCreated2D = true;
+	CreateRenderPass();
+}
+
+void vulkan::Renderer::CreateRenderPass()
+{
+	// Release the render pass with less subpasses
+	if (renderPass != VK_NULL_HANDLE) {
+		ReleaseRenderBuffers();
+		vkDestroyRenderPass(LDEVICE, renderPass, ALLOCATOR);
+		renderPass = VK_NULL_HANDLE;
+	}
+
+	// The 2d overlay is always the last subpass
+	subpass3D = 0u;
+	subpass2D = (isCreated3D) ? 1u : 0u;
+
+	// Set up the attachment the this render pass will get
+	std::vector<VkAttachmentDescription> attachmentDescriptions(1);
+	// Color attachment, cleared once and stored after the 2d overlay was drawn on top of the 3d scene
+	attachmentDescriptions[0].flags = 0;
+	attachmentDescriptions[0].format = pSwapchain->settings.surfaceFormat.format;
+	attachmentDescriptions[0].samples = settings.sampleCount;
+	attachmentDescriptions[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachmentDescriptions[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachmentDescriptions[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachmentDescriptions[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachmentDescriptions[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachmentDescriptions[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// Depth attachment, only used by the 3d subpass
+	if (isCreated3D) {
+		attachmentDescriptions.push_back(pDepthImage->depthAttachmentDescription);
+	}
+
+	// Reference to these attachments
+	VkAttachmentReference colorReference;
+	colorReference.attachment = 0;
+	colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	VkAttachmentReference depthReference;
+	depthReference.attachment = 1;
+	depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	// Describe our subpasses, they only differ in the depth attachment
+	std::vector<VkSubpassDescription> subpasses(uint32_t(isCreated3D) + uint32_t(isCreated2D));
+	for (size_t i = 0u; i < subpasses.size(); i++) {
+		subpasses[i].flags = 0;
+		subpasses[i].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[i].inputAttachmentCount = 0u;
+		subpasses[i].pInputAttachments = nullptr;
+		subpasses[i].colorAttachmentCount = 1u;
+		subpasses[i].pColorAttachments = &colorReference;
+		subpasses[i].pResolveAttachments = nullptr;
+		subpasses[i].pDepthStencilAttachment = nullptr;
+		subpasses[i].preserveAttachmentCount = 0u;
+		subpasses[i].pPreserveAttachments = nullptr;
+	}
+	if (isCreated3D) {
+		subpasses[subpass3D].pDepthStencilAttachment = &depthReference;
+	}
+
+	// Subpass dependencies
+	std::vector<VkSubpassDependency> dependencies(2);
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+	dependencies[1].srcSubpass = uint32_t(subpasses.size()) - 1u;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+	dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+	// The 2d overlay blends onto the pixels the 3d subpass wrote, per pixel so it can stay on chip
+	if (isCreated3D && isCreated2D) {
+		VkSubpassDependency overlayDependency;
+		overlayDependency.srcSubpass = subpass3D;
+		overlayDependency.dstSubpass = subpass2D;
+		overlayDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		overlayDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		overlayDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		overlayDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		overlayDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+		dependencies.push_back(overlayDependency);
+	}
+
 	// Create the render pass
-	{
-		// Set up the attachment the this render pass will get
-		std::vector<VkAttachmentDescription> attachmentDescriptions(2);
-		// Color attachment
-		attachmentDescriptions[0].flags = 0;
-		attachmentDescriptions[0].format = pSwapchain->settings.surfaceFormat.format;
-		attachmentDescriptions[0].samples = settings.sampleCount;
-		attachmentDescriptions[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		attachmentDescriptions[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		attachmentDescriptions[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		attachmentDescriptions[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		attachmentDescriptions[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachmentDescriptions[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-		// Depth attachment
-		attachmentDescriptions[1] = pDepthImage->depthAttachmentDescription;
-
-		// Reference to these attachments
-		VkAttachmentReference colorReference;
-		colorReference.attachment = 0;
-		colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		VkAttachmentReference depthReference;
-		depthReference.attachment = 1;
-		depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		// Describe our subpass
-		std::vector<VkSubpassDescription> subpasses(1);
-		subpasses[0].flags = 0;
-		subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpasses[0].inputAttachmentCount = 0u;
-		subpasses[0].pInputAttachments = nullptr;
-		subpasses[0].colorAttachmentCount = 1u;
-		subpasses[0].pColorAttachments = &colorReference;
-		subpasses[0].pResolveAttachments = nullptr;
-		subpasses[0].pDepthStencilAttachment = &depthReference;
-		subpasses[0].preserveAttachmentCount = 0u;
-		subpasses[0].pPreserveAttachments = nullptr;
-
-		// Subpass dependencies
-		std::vector<VkSubpassDependency> dependencies(2);
-		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[0].dstSubpass = 0;
-		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-		dependencies[1].srcSubpass = 0;
-		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-		dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-		// Create the 3d render pass
-		VkRenderPassCreateInfo renderPassCInfo;
-		renderPassCInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassCInfo.pNext = nullptr;
-		renderPassCInfo.flags = 0;
-		renderPassCInfo.attachmentCount = uint32_t(attachmentDescriptions.size());
-		renderPassCInfo.pAttachments = attachmentDescriptions.data();
-		renderPassCInfo.subpassCount = uint32_t(subpasses.size());
-		renderPassCInfo.pSubpasses = subpasses.data();
-		renderPassCInfo.dependencyCount = uint32_t(dependencies.size());
-		renderPassCInfo.pDependencies = dependencies.data();
-
-		VK_CHECK(vkCreateRenderPass(LDEVICE, &renderPassCInfo, ALLOCATOR, &renderPass3D));
-
-		// Free memory
-		attachmentDescriptions.~vector();
-		subpasses.~vector();
-		dependencies.~vector();
-	}
-
-	// Create render buffers
-	{
-		for (size_t i = 0u; i < buffers3D.size(); i++) {
-			// Create the command buffer
-			buffers3D[i].execBuffer.Create(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-
-			// Now set tjhe actual attachment resources for the framebuffer to use
-			std::vector<VkImageView> attachments = {
-				pSwapchain->buffers[i].imageView,
-				pDepthImage->imageView
-			};
-
-			// Create the frame buffer of this swapchain buffer
-			VkFramebufferCreateInfo framebufferCInfo;
-			framebufferCInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferCInfo.pNext = nullptr;
-			framebufferCInfo.flags = 0;
-			framebufferCInfo.renderPass = renderPass3D;
-			framebufferCInfo.attachmentCount = uint32_t(attachments.size());
-			framebufferCInfo.pAttachments = attachments.data();
-			framebufferCInfo.width = pSwapchain->settings.extent.width;
-			framebufferCInfo.height = pSwapchain->settings.extent.height;
-			framebufferCInfo.layers = 1u;
-
-			VK_CHECK(vkCreateFramebuffer(LDEVICE, &framebufferCInfo, ALLOCATOR, &(buffers3D[i].framebuffer)));
-		}
+	VkRenderPassCreateInfo renderPassCInfo;
+	renderPassCInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCInfo.pNext = nullptr;
+	renderPassCInfo.flags = 0;
+	renderPassCInfo.attachmentCount = uint32_t(attachmentDescriptions.size());
+	renderPassCInfo.pAttachments = attachmentDescriptions.data();
+	renderPassCInfo.subpassCount = uint32_t(subpasses.size());
+	renderPassCInfo.pSubpasses = subpasses.data();
+	renderPassCInfo.dependencyCount = uint32_t(dependencies.size());
+	renderPassCInfo.pDependencies = dependencies.data();
+
+	VK_CHECK(vkCreateRenderPass(LDEVICE, &renderPassCInfo, ALLOCATOR, &renderPass));
+
+	// Layout of the draw data of indirect shaders, created once like the semaphores below
+	if (indirect.setLayout == VK_NULL_HANDLE) {
+		VkDescriptorSetLayoutBinding drawDataBinding = initializers::descriptorSetLayoutBinding(
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT, 0u);
+
+		VkDescriptorSetLayoutCreateInfo setLayoutCInfo;
+		setLayoutCInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		setLayoutCInfo.pNext = nullptr;
+		setLayoutCInfo.flags = 0;
+		setLayoutCInfo.bindingCount = 1u;
+		setLayoutCInfo.pBindings = &drawDataBinding;
+		VK_CHECK(vkCreateDescriptorSetLayout(LDEVICE, &setLayoutCInfo, ALLOCATOR, &indirect.setLayout));
+
+		setLayoutCInfo.bindingCount = 0u;
+		setLayoutCInfo.pBindings = nullptr;
+		VK_CHECK(vkCreateDescriptorSetLayout(LDEVICE, &setLayoutCInfo, ALLOCATOR, &indirect.emptySetLayout));
 	}
 
-	// Create 3d render specific semaphore
+	CreateRenderBuffers();
+
+	// Create the semaphores if they weren't already created by a previous call
 	VkSemaphoreCreateInfo semCInfo = initializers::semaphoreCreateInfo();
-	if (semaphores.imageRendered3D == VK_NULL_HANDLE) {
-		VK_CHECK(vkCreateSemaphore(LDEVICE, &semCInfo, ALLOCATOR, &semaphores.imageRendered3D));
+	if (semaphores.imageRendered == VK_NULL_HANDLE) {
+		VK_CHECK(vkCreateSemaphore(LDEVICE, &semCInfo, ALLOCATOR, &semaphores.imageRendered));
 	}
-
-	// Create semaphore that is needed for 2d and 3d if it wasnt already created with Create2D method
 	if (semaphores.imageAvailable == VK_NULL_HANDLE) {
 		VK_CHECK(vkCreateSemaphore(LDEVICE, &semCInfo, ALLOCATOR, &semaphores.imageAvailable));
 	}
-
-	isCreated3D = true;
 }
 
-void vulkan::Renderer::Create2D()
+void vulkan::Renderer::CreateRenderBuffers()
 {
-	if (isCreated2D) return;
-
-	// RENDER PASS
-	{
-		std::vector<VkAttachmentDescription> attachments(1);
-		// Color attachment
-		attachments[0].flags = 0;
-		attachments[0].format = pSwapchain->settings.surfaceFormat.format;
-		attachments[0].samples = settings.sampleCount;
-		attachments[0].loadOp = (isCreated3D) ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR; // Load because we do want to render on top for an interface
-		attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		attachments[0].initialLayout = (isCreated3D) ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		// Reference to the color attachment
-		VkAttachmentReference colorReference;
-		colorReference.attachment = 0;
-		colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		// Describe our subpass
-		std::vector<VkSubpassDescription> subpasses(1);
-		subpasses[0].flags = 0;
-		subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpasses[0].inputAttachmentCount = 0u;
-		subpasses[0].pInputAttachments = nullptr;
-		subpasses[0].colorAttachmentCount = 1u;
-		subpasses[0].pColorAttachments = &colorReference;
-		subpasses[0].pResolveAttachments = nullptr;
-		subpasses[0].pDepthStencilAttachment = nullptr;
-		subpasses[0].preserveAttachmentCount = 0u;
-		subpasses[0].pPreserveAttachments = nullptr;
-
-		// Subpass dependencies
-		std::vector<VkSubpassDependency> dependencies(2);
-		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[0].dstSubpass = 0;
-		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-		dependencies[1].srcSubpass = 0;
-		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-		dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-		// Create the 2d render pass
-		VkRenderPassCreateInfo renderPassCInfo;
-		renderPassCInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassCInfo.pNext = nullptr;
-		renderPassCInfo.flags = 0;
-		renderPassCInfo.attachmentCount = uint32_t(attachments.size());
-		renderPassCInfo.pAttachments = attachments.data();
-		renderPassCInfo.subpassCount = uint32_t(subpasses.size());
-		renderPassCInfo.pSubpasses = subpasses.data();
-		renderPassCInfo.dependencyCount = uint32_t(dependencies.size());
-		renderPassCInfo.pDependencies = dependencies.data();
-
-		VK_CHECK(vkCreateRenderPass(LDEVICE, &renderPassCInfo, ALLOCATOR, &renderPass2D));
-
-		// Free memory
-		attachments.~vector();
-		subpasses.~vector();
-		dependencies.~vector();
-	}
-
-	// Create render buffers
-	{
-		for (size_t i = 0u; i < buffers2D.size(); i++) {
-			// Create the command buffer
-			buffers2D[i].execBuffer.Create(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-
-			// Now set tjhe actual attachment resources for the framebuffer to use
-			std::vector<VkImageView> attachments = {
-				pSwapchain->buffers[i].imageView
-			};
-
-			// Create the frame buffer of this swapchain buffer
-			VkFramebufferCreateInfo framebufferCInfo;
-			framebufferCInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferCInfo.pNext = nullptr;
-			framebufferCInfo.flags = 0;
-			framebufferCInfo.renderPass = renderPass2D;
-			framebufferCInfo.attachmentCount = uint32_t(attachments.size());
-			framebufferCInfo.pAttachments = attachments.data();
-			framebufferCInfo.width = pSwapchain->settings.extent.width;
-			framebufferCInfo.height = pSwapchain->settings.extent.height;
-			framebufferCInfo.layers = 1u;
-
-			VK_CHECK(vkCreateFramebuffer(LDEVICE, &framebufferCInfo, ALLOCATOR, &(buffers2D[i].framebuffer)));
-		}
+	for (size_t i = 0u; i < buffers.size(); i++) {
+		// Create the command buffer
+		buffers[i].execBuffer.Create(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+		// Now set tjhe actual attachment resources for the framebuffer to use
+		std::vector<VkImageView> attachments = {
+			pSwapchain->buffers[i].imageView
+		};
+		if (isCreated3D) attachments.push_back(pDepthImage->imageView);
+
+		// Create the frame buffer of this swapchain buffer
+		VkFramebufferCreateInfo framebufferCInfo;
+		framebufferCInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCInfo.pNext = nullptr;
+		framebufferCInfo.flags = 0;
+		framebufferCInfo.renderPass = renderPass;
+		framebufferCInfo.attachmentCount = uint32_t(attachments.size());
+		framebufferCInfo.pAttachments = attachments.data();
+		framebufferCInfo.width = pSwapchain->settings.extent.width;
+		framebufferCInfo.height = pSwapchain->settings.extent.height;
+		framebufferCInfo.layers = 1u;
+
+		VK_CHECK(vkCreateFramebuffer(LDEVICE, &framebufferCInfo, ALLOCATOR, &(buffers[i].framebuffer)));
 	}
 
-	// Create 2d render specific semaphore
-	VkSemaphoreCreateInfo semCInfo = initializers::semaphoreCreateInfo();
-	if (semaphores.imageRendered2D == VK_NULL_HANDLE) {
-		VK_CHECK(vkCreateSemaphore(LDEVICE, &semCInfo, ALLOCATOR, &semaphores.imageRendered2D));
-	}
+	// One draw data descriptor set per render buffer, allocated with its indirect buffers
+	VkDescriptorPoolSize poolSize = initializers::descriptorPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, uint32_t(buffers.size()));
+	VkDescriptorPoolCreateInfo poolCInfo;
+	poolCInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCInfo.pNext = nullptr;
+	poolCInfo.flags = 0;
+	poolCInfo.maxSets = uint32_t(buffers.size());
+	poolCInfo.poolSizeCount = 1u;
+	poolCInfo.pPoolSizes = &poolSize;
+	VK_CHECK(vkCreateDescriptorPool(LDEVICE, &poolCInfo, ALLOCATOR, &indirect.descriptorPool));
+}
 
-	// Create semaphore that is needed for 2d and 3d if it wasnt already created with Create2D method
-	if (semaphores.imageAvailable == VK_NULL_HANDLE) {
-		VK_CHECK(vkCreateSemaphore(LDEVICE, &semCInfo, ALLOCATOR, &semaphores.imageAvailable));
+void vulkan::Renderer::ReleaseRenderBuffers()
+{
+	for (size_t i = 0u; i < buffers.size(); i++) {
+		buffers[i].execBuffer.Release();
+		vkDestroyFramebuffer(LDEVICE, buffers[i].framebuffer, ALLOCATOR);
+
+		ReleaseIndirectBuffers(buffers[i]);
+		buffers[i].indirect.descriptorSet = VK_NULL_HANDLE;
 	}
 
-	isCreated2D = true;
+	// Frees the descriptor sets too
+	vkDestroyDescriptorPool(LDEVICE, indirect.descriptorPool, ALLOCATOR);
+	indirect.descriptorPool = VK_NULL_HANDLE;
 }
 
 void vulkan::Renderer::Resize(std::vector<Object*> const& objectsToDraw)
@@ -533,40 +505,25 @@ void vulkan::Renderer::Resize(std::vector<Object*> const& objectsToDraw)
 	// Wait until device is idle
 	vkDeviceWaitIdle(LDEVICE);
 
-	// Let the depth image release its data
-	pDepthImage->Release();
-
-	// Free the render pass, command buffers and their framebuffers for 2d and 3d
-	if (isCreated3D) {
-		for (size_t i = 0u; i < buffers3D.size(); i++) {
-			buffers3D[i].execBuffer.Release();
-			vkDestroyFramebuffer(LDEVICE, buffers3D[i].framebuffer, ALLOCATOR);
-		}
-		vkDestroyRenderPass(LDEVICE, renderPass3D, ALLOCATOR);
-	}
-	if (isCreated2D) {
-		for (size_t i = 0u; i < buffers2D.size(); i++) {
-			buffers2D[i].execBuffer.Release();
-			vkDestroyFramebuffer(LDEVICE, buffers2D[i].framebuffer, ALLOCATOR);
-		}
-		vkDestroyRenderPass(LDEVICE, renderPass2D, ALLOCATOR);
+	// Free the command buffers and their framebuffers, the render pass stays valid for the new size
+	if (isCreated3D || isCreated2D) {
+		ReleaseRenderBuffers();
 	}
 
 	// [TURNING_POINT] Let the swapchain recreate itself 
 	pSwapchain->Create();
 
-	// Recreate the renderer that were created before
-	bool tempIsCreated2D = isCreated2D;
-	bool tempIsCreated3D = isCreated3D;
-	isCreated2D = false;
-	isCreated3D = false;
-
-	if (tempIsCreated3D) {
-		Create3D();
+	// Recreate the depth image in the new size
+	if (isCreated3D) {
+		pDepthImage->Create();
 	}
-	if (tempIsCreated2D) {
-		Create2D();
+
+	// The amount of images might have changed
+	buffers.resize(pSwapchain->buffers.size());
+	if (isCreated3D || isCreated2D) {
+		CreateRenderBuffers();
 	}
+	CreateTimestampPool();
 
 	// Record the objects again
 	RecordDrawCommands(objectsToDraw);
@@ -588,6 +545,19 @@ void vulkan::Renderer::CreateShaderModule(char const* fileName, VkShaderModule&
 
 void vulkan::Renderer::RecordDrawCommands(std::vector<Object*> const& objects, EEColor const& color)
 {
+	// Only visible objects are drawn, with the range they currently have set
+	std::vector<DrawItem> items;
+	items.reserve(objects.size());
+	for (size_t i = 0u; i < objects.size(); i++) {
+		if (objects[i]->isVisible) items.push_back({ objects[i], objects[i]->firstIndex, objects[i]->indexCount, objects[i]->world });
+	}
+	RecordDrawCommands(items, color);
+}
+
+void vulkan::Renderer::RecordDrawCommands(std::vector<DrawItem> const& items, EEColor const& color)
+{
+	EE_PROFILE_SCOPE("Renderer::RecordDrawCommands");
+
 	// Clear values are the same over all buffers
 	VkClearValue clearColor = { color.r, color.g, color.b, color.a };
 	VkClearValue depthClearValue = { 1.0f, 0 }; // Depth, stencil
@@ -596,137 +566,460 @@ void vulkan::Renderer::RecordDrawCommands(std::vector<Object*> const& objects, E
 	scissor.offset = { 0,0 };
 	scissor.extent = { pSwapchain->settings.extent.width,pSwapchain->settings.extent.height };
 
-	// Are set to the same size in the constructor
-	assert(buffers3D.size() == buffers2D.size());
+	// Every image records the same commands, so only the ones of the first image are counted
+	RecordStats stats;
+
+	// 3d objects are culled with the frustum of the 3d camera, every field of a splitscreen might use
+	// another camera though
+	bool const cull3D = isCreated3D && culling.hasCamera3D && settings.splitscreen == EE_SPLITSCREEN_MODE_NONE;
+	if (cull3D) {
+		UpdateCulling3D(items);
+	}
+
+	// Objects completely outside of the screen are not recorded at all
+	culling.visibleItems.clear();
+	uint32_t culledObjects2D{ 0u };
+	uint32_t culledObjects3D{ 0u };
+	for (size_t i = 0u; i < items.size(); i++) {
+		Object const* pObject = items[i].pObject;
+		if (pObject->is2DObject && !IsOnScreen2D(items[i])) {
+			culledObjects2D++;
+			continue;
+		}
+		if (!pObject->is2DObject && cull3D && pObject->culling.proxy != CORETOOLS::AABBTree::NULL_PROXY
+			&& pObject->culling.visibleFrame != culling.frame) {
+			culledObjects3D++;
+			continue;
+		}
+		culling.visibleItems.push_back(items[i]);
+	}
+	std::vector<DrawItem> const& visibleItems = culling.visibleItems;
+
+	// Objects of indirect shaders sharing the geometry heap buffers are drawn together
+	BuildIndirectBatches(visibleItems);
 
 	// Recording
-	for (size_t i = 0u; i < buffers3D.size(); i++) {
+	for (size_t i = 0u; i < buffers.size(); i++) {
+		VkCommandBuffer cmdBuffer = buffers[i].execBuffer;
+		uint32_t firstQuery = uint32_t(i) * TIMESTAMPS_PER_IMAGE;
+
 		VkRenderPassBeginInfo renderPassBeginInfo;
 		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		renderPassBeginInfo.pNext = nullptr;
+		renderPassBeginInfo.renderPass = renderPass;
+		renderPassBeginInfo.framebuffer = buffers[i].framebuffer;
 		renderPassBeginInfo.renderArea.offset = { 0, 0 };
 		renderPassBeginInfo.renderArea.extent = pSwapchain->settings.extent;
+		renderPassBeginInfo.clearValueCount = (isCreated3D) ? 2u : 1u;
+		renderPassBeginInfo.pClearValues = clearValues;
+
+		buffers[i].execBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+		// The previous submission of this buffer is finished, so its indirect buffers can be written
+		ReserveIndirectBuffers(buffers[i], uint32_t(indirect.commandItems.size()));
+		if (timestamps.pool != VK_NULL_HANDLE) {
+			vkCmdResetQueryPool(cmdBuffer, timestamps.pool, firstQuery, TIMESTAMPS_PER_IMAGE);
+		}
+		vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
+		// 3D subpass
 		if (isCreated3D) {
-			renderPassBeginInfo.renderPass = renderPass3D;
-			renderPassBeginInfo.framebuffer = buffers3D[i].framebuffer;
-			renderPassBeginInfo.clearValueCount = 2u;
-			renderPassBeginInfo.pClearValues = clearValues;
-			buffers3D[i].execBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
-			vkCmdBeginRenderPass(buffers3D[i].execBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+			if (timestamps.pool != VK_NULL_HANDLE) {
+				vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamps.pool, firstQuery);
+			}
+			vkCmdSetScissor(cmdBuffer, 0u, 1u, &scissor);
+			RecordSubpass(buffers[i], visibleItems, false, (i == 0u) ? &stats : nullptr);
+			if (timestamps.pool != VK_NULL_HANDLE) {
+				vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamps.pool, firstQuery + 1u);
+			}
 		}
+
+		// 2D overlay subpass
 		if (isCreated2D) {
-			renderPassBeginInfo.renderPass = renderPass2D;
-			renderPassBeginInfo.framebuffer = buffers2D[i].framebuffer;
-			renderPassBeginInfo.clearValueCount = 1u;
-			renderPassBeginInfo.pClearValues = &clearColor;
-			buffers2D[i].execBuffer.BeginRecording(VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
-			vkCmdBeginRenderPass(buffers2D[i].execBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+			if (isCreated3D) vkCmdNextSubpass(cmdBuffer, VK_SUBPASS_CONTENTS_INLINE);
+			if (timestamps.pool != VK_NULL_HANDLE) {
+				vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamps.pool, firstQuery + 2u);
+			}
+			vkCmdSetScissor(cmdBuffer, 0u, 1u, &scissor);
+			RecordSubpass(buffers[i], visibleItems, true, (i == 0u) ? &stats : nullptr);
+			if (timestamps.pool != VK_NULL_HANDLE) {
+				vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamps.pool, firstQuery + 3u);
+			}
 		}
 
-		// Set scissor
-		if (isCreated2D)vkCmdSetScissor(buffers2D[i].execBuffer, 0u, 1u, &scissor);
-		if (isCreated3D)vkCmdSetScissor(buffers3D[i].execBuffer, 0u, 1u, &scissor);
+		// End recording of render pass and the command buffer
+		vkCmdEndRenderPass(cmdBuffer);
+		buffers[i].execBuffer.EndRecording();
+	}
 
-		// Default viewport
-		VkViewport vp;
-		vp.x = 0.0f;
-		vp.y = 0.0f;
-		vp.width = float(pSwapchain->settings.extent.width);
-		vp.height = float(pSwapchain->settings.extent.height);
-		vp.minDepth = 0.0f;
-		vp.maxDepth = 1.0f;
+	frameStats.drawCalls = stats.drawCalls;
+	frameStats.pipelineBinds = stats.pipelineBinds;
+	frameStats.descriptorBinds = stats.descriptorBinds;
+	frameStats.bufferBinds = stats.bufferBinds;
+	frameStats.culledObjects2D = culledObjects2D;
+	frameStats.culledObjects3D = culledObjects3D;
+}
+
+void vulkan::Renderer::RecordSubpass(RenderBuffer& buffer, std::vector<DrawItem> const& items, bool record2D, RecordStats* pStats)
+{
+	VkCommandBuffer cmdBuffer = buffer.execBuffer;
+	BindState bindState;
+
+	// Default viewport
+	VkViewport vp;
+	vp.x = 0.0f;
+	vp.y = 0.0f;
+	vp.width = float(pSwapchain->settings.extent.width);
+	vp.height = float(pSwapchain->settings.extent.height);
+	vp.minDepth = 0.0f;
+	vp.maxDepth = 1.0f;
+
+	// Change viewports size according to splitscreen mode
+	if (settings.splitscreen & EE_SPLITSCREEN_MODE_VERTICAL) {
+		vp.width /= 2.0f;
+	}
+	if (settings.splitscreen & EE_SPLITSCREEN_MODE_HORIZONTAL) {
+		vp.height /= 2.0f;
+	}
 
-		// Change viewports size according to splitscreen mode
-		if (settings.splitscreen & EE_SPLITSCREEN_MODE_VERTICAL) {
-			vp.width /= 2.0f;
+	// Objects of a renderer that doesn't exist are reported once while recording the other subpass
+	for (size_t j = 0u; j < items.size(); j++) {
+		if (bool(items[j].pObject->is2DObject) == record2D) continue;
+		if (record2D && !isCreated3D) {
+			EE_PRINT("[RENDERER] 3D object requested to be rendered, but no 3D renderer created!\n");
+			EE::tools::warning("[RENDERER] 3D object requested to be rendered, but no 3D renderer created!\n");
+		} else if (!record2D && !isCreated2D) {
+			EE_PRINT("[RENDERER] 2D object requested to be rendered, but no 2D renderer created!\n");
+			EE::tools::warning("[RENDERER] 2D object requested to be rendered, but no 2d renderer created!\n");
 		}
-		if (settings.splitscreen & EE_SPLITSCREEN_MODE_HORIZONTAL) {
-			vp.height /= 2.0f;
+	}
+
+	// No splitscreen just one viewport valid for all objects
+	if (settings.splitscreen == EE_SPLITSCREEN_MODE_NONE) {
+		vkCmdSetViewport(cmdBuffer, 0u, 1u, &vp);
+		for (size_t j = 0u; j < items.size(); j++) {
+			if (bool(items[j].pObject->is2DObject) != record2D) continue;
+
+			// Batches are recorded at their first item
+			if (indirect.itemBatches[j] != NO_BATCH) {
+				IndirectBatch const& batch = indirect.batches[indirect.itemBatches[j]];
+				if (batch.firstItem == j) RecordIndirectBatch(buffer, items, batch, pStats, &bindState);
+				continue;
+			}
+			items[j].pObject->Record(cmdBuffer, items[j].firstIndex, items[j].indexCount, pStats, &bindState);
 		}
+		return;
+	}
 
-		// Record each object with its viewports position defined by the splitscreen position of this object
-		if (settings.splitscreen != EE_SPLITSCREEN_MODE_NONE) {
-			// Iterate through all objects
-			for (size_t j = 0u; j < objects.size(); j++) {
-				// Compute viewport position for the current object
-				vp.x = (objects[j]->splitscreen & EE_SPLITSCREEN_RIGHT)
-					? float(pSwapchain->settings.extent.width / 2.0f)
-					: 0.0f;
-				vp.y = (objects[j]->splitscreen & EE_SPLITSCREEN_BOTTOM)
-					? float(pSwapchain->settings.extent.height / 2.0f)
-					: 0.0f;
-
-				// 3D object
-				if(!objects[j]->is2DObject) {
-					// 3D renderer requested but not created
-					if (!isCreated3D) {
-						EE_PRINT("[RENDERER] 3D object requested to be rendered, but no 3D renderer created!\n");
-						EE::tools::warning("[RENDERER] 3D object requested to be rendered, but no 3D renderer created!\n");
-					}
-					// Set the viewport and let the object record itself
-					vkCmdSetViewport(buffers3D[i].execBuffer, 0u, 1u, &vp);
-					objects[j]->Record(buffers3D[i].execBuffer);
-
-				// 2D object
-				} else if (isCreated2D) {
-					// Set the viewport and let the object record itself
-					vkCmdSetViewport(buffers2D[i].execBuffer, 0u, 1u, &vp);
-					objects[j]->Record(buffers2D[i].execBuffer);
-
-				// 2D renderer requested but not created
-				} else {
-					EE_PRINT("[RENDERER] 2D object requested to be rendered, but no 2D renderer created!\n");
-					EE::tools::warning("[RENDERER] 2D object requested to be rendered, but no 2d renderer created!\n");
+	// Splitscreen: the objects are grouped by their field, so the viewport is only set once per field.
+	// Objects on all fields are recorded again in every field, the shaders can't select a viewport
+	// themselves (that would need a geometry shader writing gl_ViewportIndex) to broadcast one draw.
+	uint32_t const columns = (settings.splitscreen & EE_SPLITSCREEN_MODE_VERTICAL) ? 2u : 1u;
+	uint32_t const rows = (settings.splitscreen & EE_SPLITSCREEN_MODE_HORIZONTAL) ? 2u : 1u;
+	for (uint32_t row = 0u; row < rows; row++) {
+		for (uint32_t column = 0u; column < columns; column++) {
+			bool viewportSet = false;
+
+			for (size_t j = 0u; j < items.size(); j++) {
+				if (bool(items[j].pObject->is2DObject) != record2D) continue;
+
+				// Field of the object, only the halfs the splitscreen mode splits into are distinguished
+				EESplitscreen splitscreen = items[j].pObject->splitscreen;
+				if (splitscreen != EE_SPLITSCREEN_ALL) {
+					uint32_t objectColumn = (columns > 1u && (splitscreen & EE_SPLITSCREEN_RIGHT)) ? 1u : 0u;
+					uint32_t objectRow = (rows > 1u && (splitscreen & EE_SPLITSCREEN_BOTTOM)) ? 1u : 0u;
+					if (objectColumn != column || objectRow != row) continue;
 				}
-			}
 
-		// No splitscreen just one viewport valid for all objects
-		} else {
-			if (isCreated3D) vkCmdSetViewport(buffers3D[i].execBuffer, 0u, 1u, &vp);
-			if (isCreated2D) vkCmdSetViewport(buffers2D[i].execBuffer, 0u, 1u, &vp);
-
-			// Iterate through all objects
-			for (size_t j = 0u; j < objects.size(); j++) {
-				// 3D object
-				if (!objects[j]->is2DObject) {
-					// 3D renderer requested but not created
-					if (!isCreated3D) {
-						EE_PRINT("[RENDERER] 3D object requested to be rendered, but no 3D renderer created!\n");
-						EE::tools::warning("[RENDERER] 3D object requested to be rendered, but no 3D renderer created!\n");
-					}
-					// Set the viewport and let the object record itself
-					vkCmdSetViewport(buffers3D[i].execBuffer, 0u, 1u, &vp);
-					objects[j]->Record(buffers3D[i].execBuffer);
-
-				// 2D object
-				} else if (isCreated2D) {
-					// Set the viewport and let the object record itself
-					vkCmdSetViewport(buffers2D[i].execBuffer, 0u, 1u, &vp);
-					objects[j]->Record(buffers2D[i].execBuffer);
-
-				// 2D renderer requested but not created
-				} else {
-					EE_PRINT("[RENDERER] 2D object requested to be rendered, but no 2D renderer created!\n");
-					EE::tools::warning("[RENDERER] 2D object requested to be rendered, but no 2d renderer created!\n");
+				// Empty fields don't set their viewport at all
+				if (!viewportSet) {
+					vp.x = (column == 1u) ? float(pSwapchain->settings.extent.width / 2.0f) : 0.0f;
+					vp.y = (row == 1u) ? float(pSwapchain->settings.extent.height / 2.0f) : 0.0f;
+					vkCmdSetViewport(cmdBuffer, 0u, 1u, &vp);
+					viewportSet = true;
+				}
+
+				// Batches only contain objects of the same field and are recorded at their first item
+				if (indirect.itemBatches[j] != NO_BATCH) {
+					IndirectBatch const& batch = indirect.batches[indirect.itemBatches[j]];
+					if (batch.firstItem == j) RecordIndirectBatch(buffer, items, batch, pStats, &bindState);
+					continue;
 				}
+
+				// Let the object record itself
+				items[j].pObject->Record(cmdBuffer, items[j].firstIndex, items[j].indexCount, pStats, &bindState);
 			}
 		}
+	}
+}
 
-		// End recording of render pass and the command buffer
-		if (isCreated3D) {
-			vkCmdEndRenderPass(buffers3D[i].execBuffer);
-			buffers3D[i].execBuffer.EndRecording();
+bool vulkan::Renderer::IsOnScreen2D(DrawItem const& item) const
+{
+	Mesh const* pMesh = item.pObject->pMesh;
+	if (!pMesh->bounds.isValid) return true;
+
+	// Compare every corner in clip space, the box is off screen if all corners are beyond the same edge
+	glm::mat4 worldViewProjection = culling.viewProjection2D * item.world;
+	bool allLeft{ true }, allRight{ true }, allBelow{ true }, allAbove{ true };
+	for (uint32_t i = 0u; i < 8u; i++) {
+		glm::vec4 corner(
+			(i & 1u) ? pMesh->bounds.max.x : pMesh->bounds.min.x,
+			(i & 2u) ? pMesh->bounds.max.y : pMesh->bounds.min.y,
+			(i & 4u) ? pMesh->bounds.max.z : pMesh->bounds.min.z,
+			1.0f);
+		glm::vec4 clip = worldViewProjection * corner;
+
+		allLeft = allLeft && (clip.x < -clip.w);
+		allRight = allRight && (clip.x > clip.w);
+		allBelow = allBelow && (clip.y < -clip.w);
+		allAbove = allAbove && (clip.y > clip.w);
+	}
+
+	return !(allLeft || allRight || allBelow || allAbove);
+}
+
+void vulkan::Renderer::BuildIndirectBatches(std::vector<DrawItem> const& items)
+{
+	indirect.batches.clear();
+	indirect.itemBatches.assign(items.size(), uint32_t(NO_BATCH));
+	indirect.commandItems.clear();
+
+	for (size_t i = 0u; i < items.size(); i++) {
+		if (!items[i].pObject->pShader->settings.indirectDraw) continue;
+
+		// The batches are built with the buffers the meshes will be drawn from
+		items[i].pObject->pMesh->SwitchBuffers();
+		indirect.commandItems.push_back(uint32_t(i));
+	}
+	if (indirect.commandItems.empty()) return;
+
+	// Sort the 3d items so every batch is consecutive, stable so the first item of a batch stays in front.
+	// The 2d items keep their order since it is their z-order, so only neighbours in the draw list are batched
+	bool const splitByField = (settings.splitscreen != EE_SPLITSCREEN_MODE_NONE);
+	std::stable_sort(indirect.commandItems.begin(), indirect.commandItems.end(), [&](uint32_t a, uint32_t b) {
+		Object const* pA = items[a].pObject;
+		Object const* pB = items[b].pObject;
+		if (pA->is2DObject != pB->is2DObject) return bool(pB->is2DObject);
+		if (pA->is2DObject) return false;
+		if (pA->pShader != pB->pShader) return pA->pShader < pB->pShader;
+		if (pA->pMesh->GetVertexBuffer() != pB->pMesh->GetVertexBuffer()) return pA->pMesh->GetVertexBuffer() < pB->pMesh->GetVertexBuffer();
+		if (pA->pMesh->GetIndexBuffer() != pB->pMesh->GetIndexBuffer()) return pA->pMesh->GetIndexBuffer() < pB->pMesh->GetIndexBuffer();
+		return splitByField && pA->splitscreen < pB->splitscreen;
+	});
+
+	for (uint32_t command = 0u; command < uint32_t(indirect.commandItems.size()); command++) {
+		uint32_t item = indirect.commandItems[command];
+		Object const* pObject = items[item].pObject;
+
+		bool newBatch = indirect.batches.empty();
+		if (!newBatch) {
+			Object const* pFirst = items[indirect.batches.back().firstItem].pObject;
+			newBatch = pFirst->pShader != pObject->pShader
+				|| pFirst->pMesh->GetVertexBuffer() != pObject->pMesh->GetVertexBuffer()
+				|| pFirst->pMesh->GetIndexBuffer() != pObject->pMesh->GetIndexBuffer()
+				|| (splitByField && pFirst->splitscreen != pObject->splitscreen)
+				|| (pObject->is2DObject && item != indirect.commandItems[command - 1u] + 1u);
 		}
-		if (isCreated2D) {
-			vkCmdEndRenderPass(buffers2D[i].execBuffer);
-			buffers2D[i].execBuffer.EndRecording();
+		if (newBatch) indirect.batches.push_back({ item, command, 0u });
+
+		indirect.batches.back().amountCommands++;
+		indirect.itemBatches[item] = uint32_t(indirect.batches.size() - 1u);
+	}
+}
+
+void vulkan::Renderer::RecordIndirectBatch(RenderBuffer& buffer, std::vector<DrawItem> const& items, IndirectBatch const& batch,
+																					 RecordStats* pStats, BindState* pBindState)
+{
+	VkCommandBuffer cmdBuffer = buffer.execBuffer;
+	Object* pFirst = items[batch.firstItem].pObject;
+	Shader const* pShader = pFirst->pShader;
+
+	// Resources of the first object are used for the whole batch, the draw data is set 1
+	pShader->Record(cmdBuffer, (pShader->settings.amountDescriptors) ? &pFirst->descriptorSet : nullptr, pStats);
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pShader->pPipeline->pipelineLayout,
+													1u, 1u, &buffer.indirect.descriptorSet, 0u, nullptr);
+	if (pStats) pStats->descriptorBinds++;
+
+	// All meshes of the batch share the buffers of the first one
+	if (!pFirst->pMesh->Bind(cmdBuffer, pStats, pBindState)) return;
+
+	// Commands with the range of every object, the first instance is the index of the draw data
+	for (uint32_t command = batch.firstCommand; command < batch.firstCommand + batch.amountCommands; command++) {
+		DrawItem const& item = items[indirect.commandItems[command]];
+
+		Mesh const* pMesh = item.pObject->pMesh;
+		VkDrawIndexedIndirectCommand& drawCommand = buffer.indirect.pCommands[command];
+		drawCommand.indexCount = pMesh->ClampIndexCount(item.firstIndex, item.indexCount);
+		drawCommand.instanceCount = 1u;
+		drawCommand.firstIndex = pMesh->GetFirstIndex() + item.firstIndex;
+		drawCommand.vertexOffset = pMesh->GetVertexOffset();
+		drawCommand.firstInstance = command;
+
+		buffer.indirect.pDrawData[command] = item.world;
+	}
+
+	VkDeviceSize offset = VkDeviceSize(batch.firstCommand) * sizeof(VkDrawIndexedIndirectCommand);
+	uint32_t const stride = uint32_t(sizeof(VkDrawIndexedIndirectCommand));
+	if (!EEDEVICE->enabledFeatures.drawIndirectFirstInstance) {
+		// Indirect commands would need a first instance of zero, so the commands are drawn directly
+		for (uint32_t command = batch.firstCommand; command < batch.firstCommand + batch.amountCommands; command++) {
+			VkDrawIndexedIndirectCommand const& drawCommand = buffer.indirect.pCommands[command];
+			if (drawCommand.indexCount == 0u) continue;
+			vkCmdDrawIndexed(cmdBuffer, drawCommand.indexCount, 1u, drawCommand.firstIndex, drawCommand.vertexOffset, drawCommand.firstInstance);
+			if (pStats) pStats->drawCalls++;
+		}
+	} else if (EEDEVICE->enabledFeatures.multiDrawIndirect) {
+		vkCmdDrawIndexedIndirect(cmdBuffer, buffer.indirect.commands, offset, batch.amountCommands, stride);
+		if (pStats) pStats->drawCalls++;
+	} else {
+		for (uint32_t i = 0u; i < batch.amountCommands; i++, offset += stride) {
+			vkCmdDrawIndexedIndirect(cmdBuffer, buffer.indirect.commands, offset, 1u, stride);
+			if (pStats) pStats->drawCalls++;
 		}
 	}
 }
 
-void vulkan::Renderer::Draw() const
+void vulkan::Renderer::ReserveIndirectBuffers(RenderBuffer& buffer, uint32_t amountCommands)
 {
+	if (amountCommands <= buffer.indirect.capacity) return;
+
+	// Grow by doubling so a slowly growing scene doesn't reallocate every frame
+	uint32_t capacity = std::max(std::max(amountCommands, buffer.indirect.capacity * 2u), MIN_INDIRECT_CAPACITY);
+	ReleaseIndirectBuffers(buffer);
+
+	// Host visible and mapped for their whole lifetime, they are rewritten every recording
+	VkMemoryPropertyFlags const memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	VkDeviceSize commandsSize = VkDeviceSize(capacity) * sizeof(VkDrawIndexedIndirectCommand);
+	VkDeviceSize drawDataSize = VkDeviceSize(capacity) * sizeof(glm::mat4);
+	VK_CHECK(EEDEVICE->CreateBuffer(VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, memoryProperties, EE_MEMORY_CATEGORY_BUFFER,
+																	commandsSize, &buffer.indirect.commands, &buffer.indirect.commandsMemory));
+	VK_CHECK(EEDEVICE->CreateBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, memoryProperties, EE_MEMORY_CATEGORY_BUFFER,
+																	drawDataSize, &buffer.indirect.drawData, &buffer.indirect.drawDataMemory));
+	VK_CHECK(vkMapMemory(LDEVICE, buffer.indirect.commandsMemory, 0, commandsSize, 0, (void**)&buffer.indirect.pCommands));
+	VK_CHECK(vkMapMemory(LDEVICE, buffer.indirect.drawDataMemory, 0, drawDataSize, 0, (void**)&buffer.indirect.pDrawData));
+	buffer.indirect.capacity = capacity;
+
+	// Point the descriptor set to the new draw data
+	if (buffer.indirect.descriptorSet == VK_NULL_HANDLE) {
+		VkDescriptorSetAllocateInfo allocInfo;
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.pNext = nullptr;
+		allocInfo.descriptorPool = indirect.descriptorPool;
+		allocInfo.descriptorSetCount = 1u;
+		allocInfo.pSetLayouts = &indirect.setLayout;
+		VK_CHECK(vkAllocateDescriptorSets(LDEVICE, &allocInfo, &buffer.indirect.descriptorSet));
+	}
+
+	VkDescriptorBufferInfo bufferInfo;
+	bufferInfo.buffer = buffer.indirect.drawData;
+	bufferInfo.offset = 0u;
+	bufferInfo.range = VK_WHOLE_SIZE;
+
+	VkWriteDescriptorSet write;
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.pNext = nullptr;
+	write.dstSet = buffer.indirect.descriptorSet;
+	write.dstBinding = 0u;
+	write.dstArrayElement = 0u;
+	write.descriptorCount = 1u;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pImageInfo = nullptr;
+	write.pBufferInfo = &bufferInfo;
+	write.pTexelBufferView = nullptr;
+	vkUpdateDescriptorSets(LDEVICE, 1u, &write, 0u, nullptr);
+}
+
+void vulkan::Renderer::ReleaseIndirectBuffers(RenderBuffer& buffer)
+{
+	if (buffer.indirect.capacity == 0u) return;
+
+	// Freeing the memory unmaps it
+	vkDestroyBuffer(LDEVICE, buffer.indirect.commands, ALLOCATOR);
+	EEDEVICE->FreeMemory(buffer.indirect.commandsMemory);
+	vkDestroyBuffer(LDEVICE, buffer.indirect.drawData, ALLOCATOR);
+	EEDEVICE->FreeMemory(buffer.indirect.drawDataMemory);
+
+	buffer.indirect.commands = VK_NULL_HANDLE;
+	buffer.indirect.drawData = VK_NULL_HANDLE;
+	buffer.indirect.capacity = 0u;
+}
+
+void vulkan::Renderer::UpdateCulling3D(std::vector<DrawItem> const& items)
+{
+	EE_PROFILE_SCOPE("Renderer::UpdateCulling3D");
+
+	// Keep the leafs uptodate, only objects that moved or which mesh changed are touched
+	for (size_t i = 0u; i < items.size(); i++) {
+		Object* pObject = items[i].pObject;
+		if (pObject->is2DObject) continue;
+
+		Mesh const* pMesh = pObject->pMesh;
+		if (!pMesh->bounds.isValid) {
+			RemoveFromCulling(pObject);
+			continue;
+		}
+		if (pObject->culling.proxy != CORETOOLS::AABBTree::NULL_PROXY
+			&& pObject->culling.boundsVersion == pMesh->bounds.version && pObject->culling.world == items[i].world) {
+			continue;
+		}
+
+		// World box of the transformed mesh box: the center is transformed, the extents are projected
+		// onto the world axes with the absolute rotation/scale part of the matrix
+		glm::vec3 center = (pMesh->bounds.max + pMesh->bounds.min) * 0.5f;
+		glm::vec3 extents = (pMesh->bounds.max - pMesh->bounds.min) * 0.5f;
+		glm::mat4 const& world = items[i].world;
+		glm::vec3 worldCenter = glm::vec3(world * glm::vec4(center, 1.0f));
+		glm::vec3 worldExtents(0.0f);
+		for (int column = 0; column < 3; column++) {
+			worldExtents += glm::abs(glm::vec3(world[column])) * extents[column];
+		}
+
+		CORETOOLS::AABB aabb;
+		for (int axis = 0; axis < 3; axis++) {
+			aabb.min[axis] = worldCenter[axis] - worldExtents[axis];
+			aabb.max[axis] = worldCenter[axis] + worldExtents[axis];
+		}
+
+		if (pObject->culling.proxy == CORETOOLS::AABBTree::NULL_PROXY) {
+			pObject->culling.proxy = culling.tree3D.CreateProxy(aabb, pObject);
+		} else {
+			culling.tree3D.MoveProxy(pObject->culling.proxy, aabb);
+		}
+		pObject->culling.world = world;
+		pObject->culling.boundsVersion = pMesh->bounds.version;
+	}
+
+	// Planes of the frustum from the rows of the view projection matrix (clip space z within [-w, w])
+	glm::mat4 const& m = culling.viewProjection3D;
+	CORETOOLS::Frustum frustum;
+	for (int plane = 0; plane < 6; plane++) {
+		int row = plane / 2;
+		float sign = (plane % 2 == 0) ? 1.0f : -1.0f;
+		for (int column = 0; column < 4; column++) {
+			frustum.planes[plane][column] = m[column][3] + sign * m[column][row];
+		}
+	}
+
+	// Flag everything within the frustum with the current frame
+	culling.frame++;
+	culling.visible3D.clear();
+	culling.tree3D.Query(frustum, culling.visible3D);
+	for (size_t i = 0u; i < culling.visible3D.size(); i++) {
+		static_cast<Object*>(culling.visible3D[i])->culling.visibleFrame = culling.frame;
+	}
+}
+
+void vulkan::Renderer::RemoveFromCulling(Object* pObject)
+{
+	if (pObject->culling.proxy == CORETOOLS::AABBTree::NULL_PROXY) return;
+
+	culling.tree3D.DestroyProxy(pObject->culling.proxy);
+	pObject->culling.proxy = CORETOOLS::AABBTree::NULL_PROXY;
+}
+
+void vulkan::Renderer::Draw()
+{
+	EE_PROFILE_SCOPE("Renderer::Draw");
+
 #ifdef _DEBUG
 	static bool lastTimeFocused{ true };
 	if (!pSwapchain->pWindow->isFocused) {
@@ -744,58 +1037,36 @@ void vulkan::Renderer::Draw() const
 	uint32_t imageIndex;
 	pSwapchain->AcquireNextImage(semaphores.imageAvailable, &imageIndex);
 
-	/// ODERS
-	// Both enabled:
-	//	 -> sem::imageAvailable  -> cmd::render3D -> sem::imageRendered3D -> cmd::render2D
-	//	 -> sem::imageRenderer2D -> cmd::present
-	// 3D only:
-	//	 -> sem::imageAvailable  -> cmd::render3D -> sem::imageRendered3D -> cmd::present
-	// 2D only:
-	//	 -> sem::imageAvailable  -> cmd::render2D -> sem::imageRendered2D -> cmd::present
+	// The timings of the last frame that used this image, submitting waits for it anyways
+	ReadTimestamps(imageIndex);
+
+	/// ODER
+	//	 -> sem::imageAvailable -> cmd::render (3d and 2d subpass) -> sem::imageRendered -> cmd::present
 	// @where:
 	// sem -> cmd: means that cmd will wait till sem was signaled
 	// cmd -> sem: the sem will be signaled when cmd has finished
-
-	// General submit info set up that is valid for 2d and 3d
 	VkSubmitInfo submitInfo;
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	submitInfo.pNext = nullptr;
 	VkPipelineStageFlags waitStageMask[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 	submitInfo.pWaitDstStageMask = waitStageMask;
-
-	VkSemaphore waitSemaphore = semaphores.imageAvailable;
-
-	if (isCreated3D) {
-		submitInfo.waitSemaphoreCount = 1u;
-		submitInfo.pWaitSemaphores = &waitSemaphore;
-		submitInfo.commandBufferCount = 1u;
-		submitInfo.pCommandBuffers = &(buffers3D[imageIndex].execBuffer.cmdBuffer);
-		submitInfo.signalSemaphoreCount = 1u;
-		submitInfo.pSignalSemaphores = &semaphores.imageRendered3D;
-		buffers3D[imageIndex].execBuffer.Execute(&submitInfo, false);
-
-		// Change wait semaphore to one that will be signaled when 3d process has finished
-		waitSemaphore = semaphores.imageRendered3D;
-	}
-
-	if (isCreated2D) {
-		submitInfo.waitSemaphoreCount = 1u;
-		submitInfo.pWaitSemaphores = &waitSemaphore;
-		submitInfo.commandBufferCount = 1u;
-		submitInfo.pCommandBuffers = &(buffers2D[imageIndex].execBuffer.cmdBuffer);
-		submitInfo.signalSemaphoreCount = 1u;
-		submitInfo.pSignalSemaphores = &semaphores.imageRendered2D;
-		buffers2D[imageIndex].execBuffer.Execute(&submitInfo, false);
-
-		// Change wait semaphore to one that will be signaled when 2d process has finished
-		waitSemaphore = semaphores.imageRendered2D;
+	submitInfo.waitSemaphoreCount = 1u;
+	submitInfo.pWaitSemaphores = &semaphores.imageAvailable;
+	submitInfo.commandBufferCount = 1u;
+	submitInfo.pCommandBuffers = &(buffers[imageIndex].execBuffer.cmdBuffer);
+	submitInfo.signalSemaphoreCount = 1u;
+	submitInfo.pSignalSemaphores = &semaphores.imageRendered;
+	buffers[imageIndex].execBuffer.Execute(&submitInfo, false);
+
+	if (timestamps.pool != VK_NULL_HANDLE) {
+		timestamps.isPending[imageIndex] = true;
 	}
 
 	VkPresentInfoKHR presentInfo;
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	presentInfo.pNext = nullptr;
 	presentInfo.waitSemaphoreCount = 1u;
-	presentInfo.pWaitSemaphores = &waitSemaphore;
+	presentInfo.pWaitSemaphores = &semaphores.imageRendered;
 	presentInfo.swapchainCount = 1u;
 	presentInfo.pSwapchains = &(pSwapchain->swapchain);
 	presentInfo.pImageIndices = &imageIndex;
@@ -806,14 +1077,63 @@ void vulkan::Renderer::Draw() const
 
 void vulkan::Renderer::WaitTillIdle() const
 {
-	if (isCreated2D) {
-		for (size_t i = 0u; i < buffers2D.size(); i++) {
-			buffers2D[i].execBuffer.Wait();
+	if (isCreated3D || isCreated2D) {
+		for (size_t i = 0u; i < buffers.size(); i++) {
+			buffers[i].execBuffer.Wait();
 		}
 	}
+}
+
+void vulkan::Renderer::CreateTimestampPool()
+{
+	if (timestamps.pool != VK_NULL_HANDLE) {
+		vkDestroyQueryPool(LDEVICE, timestamps.pool, ALLOCATOR);
+		timestamps.pool = VK_NULL_HANDLE;
+	}
+	timestamps.isPending.assign(buffers.size(), false);
+	frameStats.gpuTimingsValid = EE_FALSE;
+
+	// Zero valid bits means the queue can't write timestamps at all
+	uint32_t validBits = EEDEVICE->queueFamilyProperties[EEDEVICE->queueIndices.graphics].timestampValidBits;
+	if (validBits == 0u) {
+		EE_PRINT("[RENDERER] Graphics queue doesn't support timestamps, gpu timings are disabled!\n");
+		return;
+	}
+	timestamps.validMask = (validBits >= 64u) ? ~uint64_t(0u) : ((uint64_t(1u) << validBits) - 1u);
+	timestamps.period = double(EEDEVICE->properties.limits.timestampPeriod);
+
+	VkQueryPoolCreateInfo cinfo;
+	cinfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	cinfo.pNext = nullptr;
+	cinfo.flags = 0;
+	cinfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	cinfo.queryCount = uint32_t(buffers.size()) * TIMESTAMPS_PER_IMAGE;
+	cinfo.pipelineStatistics = 0;
+	VK_CHECK(vkCreateQueryPool(LDEVICE, &cinfo, ALLOCATOR, &timestamps.pool));
+}
+
+void vulkan::Renderer::ReadTimestamps(uint32_t imageIndex)
+{
+	if (timestamps.pool == VK_NULL_HANDLE || !timestamps.isPending[imageIndex]) return;
+
+	// Only needs to wait if the gpu is more than a swapchain length behind, submitting would wait too
+	buffers[imageIndex].execBuffer.Wait();
+
+	// Never waits for the results, if they aren't available the last timings are kept
+	uint64_t ticks[2];
+	uint32_t first = imageIndex * TIMESTAMPS_PER_IMAGE;
+	bool valid = true;
 	if (isCreated3D) {
-		for (size_t i = 0u; i < buffers3D.size(); i++) {
-			buffers3D[i].execBuffer.Wait();
-		}
+		if (vkGetQueryPoolResults(LDEVICE, timestamps.pool, first, 2u, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+			frameStats.gpuTime3D = double((ticks[1] - ticks[0]) & timestamps.validMask) * timestamps.period / 1000000.0;
+		} else valid = false;
 	}
+	if (isCreated2D) {
+		if (vkGetQueryPoolResults(LDEVICE, timestamps.pool, first + 2u, 2u, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+			frameStats.gpuTime2D = double((ticks[1] - ticks[0]) & timestamps.validMask) * timestamps.period / 1000000.0;
+		} else valid = false;
+	}
+
+	frameStats.gpuTimingsValid = valid ? EE_TRUE : EE_FALSE;
+	timestamps.isPending[imageIndex] = false;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "vulkanSwapchain.h" //& vulkanDevice vulkanDebug vulkanInstance vulkanTools vulkanInitializers vulkan
+#include "coretools/AABBTree.h"
 
 
 namespace EE
@@ -17,6 +18,8 @@ namespace EE
 
 	namespace vulkan
 	{
+		struct GeometryHeap;
+
 		//-------------------------------------------------------------------
 		// DepthImage
 		//-------------------------------------------------------------------
@@ -50,43 +53,164 @@ namespace EE
 		};
 
 
+		//-------------------------------------------------------------------
+		// RecordStats
+		//-------------------------------------------------------------------
+		/* @brief Amount of commands recorded into a command buffer */
+		struct RecordStats
+		{
+			uint32_t drawCalls{ 0u };
+			uint32_t pipelineBinds{ 0u };
+			uint32_t descriptorBinds{ 0u };
+			uint32_t bufferBinds{ 0u };
+		};
+
+		/* @brief Vertex and index buffer bound while recording, meshes sharing them don't bind again */
+		struct BindState
+		{
+			VkBuffer vertexBuffer{ VK_NULL_HANDLE };
+			VkBuffer indexBuffer{ VK_NULL_HANDLE };
+		};
+
+
 		//-------------------------------------------------------------------
 		// Renderer
 		//-------------------------------------------------------------------
 		struct Renderer
 		{
+			/* @brief An object to draw with the range of its mesh' indices (indexCount of zero draws the whole mesh) */
+			struct DrawItem {
+				Object* pObject;
+				uint32_t firstIndex;
+				uint32_t indexCount;
+				/* @brief World matrix the object is culled with */
+				glm::mat4 world;
+			};
+
 			/* @brief Struct representing a render buffer by combining a framebuffer with its cmd buffer */
 			struct RenderBuffer {
 				ExecBuffer execBuffer;
 				VkFramebuffer framebuffer;
+
+				/**
+				 * Indirect commands and draw data (world matrices) of the objects drawn indirectly. Only
+				 * written while recording this buffer, its previous submission is finished then.
+				 **/
+				struct {
+					VkBuffer commands{ VK_NULL_HANDLE };
+					VkDeviceMemory commandsMemory;
+					VkDrawIndexedIndirectCommand* pCommands;
+					VkBuffer drawData{ VK_NULL_HANDLE };
+					VkDeviceMemory drawDataMemory;
+					glm::mat4* pDrawData;
+					/* @brief Amount of commands (and draw data) both buffers can hold */
+					uint32_t capacity{ 0u };
+					VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+				} indirect;
 			};
 
+			/* @brief Objects of one indirect shader whose meshes share the vertex/index buffers, drawn with the descriptor set of the first one */
+			struct IndirectBatch {
+				/* @brief Index of the batch' first item in the draw list, the whole batch is recorded there */
+				uint32_t firstItem;
+				uint32_t firstCommand;
+				uint32_t amountCommands;
+			};
+			static constexpr uint32_t NO_BATCH{ ~0u };
+
 			/* @brief Swapchain this renderer will use to present */
 			Swapchain* pSwapchain;
 
-			/* @brief Handle of the 3d render pass */
-			VkRenderPass renderPass3D{ VK_NULL_HANDLE };
-			/* @brief List of the render buffers per image passed in for 3d rendering */
-			std::vector<RenderBuffer> buffers3D;
+			/* @brief Shared vertex and index buffers the meshes suballocate from */
+			GeometryHeap* pGeometryHeap{ nullptr };
+
+			/**
+			 * Handle of the render pass, it has a subpass for 3d and a subpass for the 2d overlay
+			 * (only the ones that were created). The 2d subpass draws on top of the 3d one without the
+			 * color attachment leaving the tile memory, all of it is recorded into one command buffer.
+			 **/
+			VkRenderPass renderPass{ VK_NULL_HANDLE };
+			/* @brief Index of the 3d and 2d subpass within the render pass */
+			uint32_t subpass3D{ 0u };
+			uint32_t subpass2D{ 0u };
+			/* @brief List of the render buffers per swapchain image */
+			std::vector<RenderBuffer> buffers;
+
 			/* @brief Indicates wether the vulkan resources for 3d rendering were created or not */
 			bool isCreated3D{ false };
 			/* @brief Struct representing the depth image */
 			DepthImage* pDepthImage{ nullptr };
 
-			/* @brief Handle of the 2d render pass */
-			VkRenderPass renderPass2D{ VK_NULL_HANDLE };
-			/* @brief List of the render buffers per image passed in for 2d rendering */
-			std::vector<RenderBuffer> buffers2D;
 			/* @brief Indicates wether the vulkan resources for 2d rendering were created or not */
 			bool isCreated2D{ false };
 
 			/* @brief Encapsulates the needed semaphore for synchronizing the draw method */
 			struct {
 				VkSemaphore imageAvailable{ VK_NULL_HANDLE };
-				VkSemaphore imageRendered3D{ VK_NULL_HANDLE };
-				VkSemaphore imageRendered2D{ VK_NULL_HANDLE };
+				VkSemaphore imageRendered{ VK_NULL_HANDLE };
 			} semaphores;
 
+			/**
+			 * Timestamps written at the begin and end of the 3d and 2d pass, TIMESTAMPS_PER_IMAGE per
+			 * swapchain image. They are read back when the image is used again, so it never stalls.
+			 * If the graphics queue has no valid timestamp bits the pool isn't created at all.
+			 **/
+			struct {
+				VkQueryPool pool{ VK_NULL_HANDLE };
+				/* @brief Indicates wether the timestamps of an image were submitted and not read back yet */
+				std::vector<bool> isPending;
+				/* @brief Nanoseconds per tick and the bits of a timestamp that are valid */
+				double period;
+				uint64_t validMask;
+			} timestamps;
+
+			/* @brief Commands recorded for the last frame and gpu timings of the last finished one */
+			EEFrameStats frameStats{};
+
+			/* @brief Objects outside of the screen are skipped while recording */
+			struct {
+				/* @brief Ortho and view matrix of the 2d camera (EEShaderColor2D::CameraUBO) */
+				glm::mat4 viewProjection2D{ 1.0f };
+
+				/**
+				 * Projection and view matrix of the 3d camera, 3d objects are only culled if it was set.
+				 * Their world bounds are kept in a tree, so a frame only tests the nodes of the tree
+				 * that intersect with the frustum instead of every object.
+				 **/
+				glm::mat4 viewProjection3D{ 1.0f };
+				bool hasCamera3D{ false };
+				CORETOOLS::AABBTree tree3D;
+				/* @brief Objects found by the last query and the frame counter they are flagged with */
+				std::vector<void*> visible3D;
+				uint32_t frame{ 0u };
+
+				/* @brief Items that passed culling, kept to reuse its memory */
+				std::vector<DrawItem> visibleItems;
+			} culling;
+
+			/**
+			 * Objects of indirect shaders (EEShaderCreateInfo::indirectDraw) are batched by their shader
+			 * and mesh buffers (meshes of the same geometry heap pages share them), every batch is one
+			 * vkCmdDrawIndexedIndirect. Each object gets a command and
+			 * its world matrix in the draw data (set 1, binding 0), the shader indexes the draw data
+			 * with gl_InstanceIndex which is the index of the command. Without multiDrawIndirect every
+			 * command is drawn on its own, without drawIndirectFirstInstance they are drawn directly.
+			 **/
+			struct {
+				VkDescriptorSetLayout setLayout{ VK_NULL_HANDLE };
+				/* @brief Set 0 of indirect shaders without descriptors of their own */
+				VkDescriptorSetLayout emptySetLayout{ VK_NULL_HANDLE };
+				/* @brief Pool of the render buffers' draw data descriptor sets */
+				VkDescriptorPool descriptorPool{ VK_NULL_HANDLE };
+
+				/* @brief Batches of the current draw list */
+				std::vector<IndirectBatch> batches;
+				/* @brief Batch of each item in the draw list (NO_BATCH if its shader isn't indirect) */
+				std::vector<uint32_t> itemBatches;
+				/* @brief Item of each command, the commands of a batch are consecutive */
+				std::vector<uint32_t> commandItems;
+			} indirect;
+
 			/* @brief Descriptions that need to be used for all pipelines using this renderer */
 			VkPipelineInputAssemblyStateCreateInfo inputAssemblyState;
 			VkPipelineViewportStateCreateInfo viewportState;
@@ -111,15 +235,35 @@ namespace EE
 			~Renderer();
 
 			/**
-			 * @brief Creates the 3d render pass
+			 * Adds the 3d subpass to the render pass
+			 *
+			 * @note Needs to be called before Create2D and before any pipeline is created
 			 **/
 			void Create3D();
 
 			/**
-			 * @brief Creates the 2d render pass
+			 * Adds the 2d subpass to the render pass
+			 *
+			 * @note Needs to be called before any pipeline is created
 			 **/
 			void Create2D();
 
+			/**
+			 * (Re)creates the render pass with the subpasses of the renderers created so far and the
+			 * framebuffers and command buffers of every swapchain image
+			 **/
+			void CreateRenderPass();
+
+			/**
+			 * Creates a framebuffer and a command buffer for every swapchain image
+			 **/
+			void CreateRenderBuffers();
+
+			/**
+			 * Releases the framebuffer and command buffer of every swapchain image
+			 **/
+			void ReleaseRenderBuffers();
+
 			/**
 			 * Resizes the necessary vulkan resources to the new size
 			 *
@@ -148,16 +292,100 @@ namespace EE
 			 **/
 			void RecordDrawCommands(std::vector<Object*> const& objectsToDraw, EEColor const& color = { 0.0f, 0.0f, 0.0f, 1.0f });
 
+			/**
+			 * Records the draw calls of the passed in draw list in the command buffers. Unlike the
+			 * overload above the visibility and draw range are taken from the list and not from
+			 * the objects, so it can record a snapshot while the objects are already changed.
+			 *
+			 * @param items		Visible objects with the range of their mesh they draw
+			 * @param color		A custom clear color for the color attachment
+			 **/
+			void RecordDrawCommands(std::vector<DrawItem> const& items, EEColor const& color);
+
+			/**
+			 * Records the 3d or the 2d items of the draw list into the current subpass
+			 *
+			 * @param buffer			Render buffer that is recording the subpass
+			 * @param items				The whole draw list, only the items of the subpass are recorded
+			 * @param record2D		Wether the 2d or the 3d items are recorded
+			 * @param pStats			Counts the recorded commands if not nullptr
+			 **/
+			void RecordSubpass(RenderBuffer& buffer, std::vector<DrawItem> const& items, bool record2D, RecordStats* pStats);
+
+			/**
+			 * Groups the items of indirect shaders into batches of the same shader and buffers (and
+			 * splitscreen field) and assigns every item its command
+			 *
+			 * @param items		The draw list that will be recorded
+			 **/
+			void BuildIndirectBatches(std::vector<DrawItem> const& items);
+
+			/**
+			 * Writes the commands and draw data of the batch into the render buffer and records its draws
+			 *
+			 * @param buffer			Render buffer that is recording
+			 * @param items				The draw list the batches were built for
+			 * @param batch				The batch to record
+			 * @param pStats			Counts the recorded commands if not nullptr
+			 * @param pBindState	Buffers bound while recording the subpass
+			 **/
+			void RecordIndirectBatch(RenderBuffer& buffer, std::vector<DrawItem> const& items, IndirectBatch const& batch,
+															 RecordStats* pStats, BindState* pBindState);
+
+			/**
+			 * Makes sure the indirect buffers of the render buffer can hold the amount of commands
+			 *
+			 * @note The render buffer's previous submission needs to be finished
+			 **/
+			void ReserveIndirectBuffers(RenderBuffer& buffer, uint32_t amountCommands);
+
+			/**
+			 * Releases the indirect buffers of the render buffer (its descriptor set is kept)
+			 **/
+			void ReleaseIndirectBuffers(RenderBuffer& buffer);
+
+			/**
+			 * Returns wether the bounds of the item's mesh transformed with its world and the 2d camera
+			 * overlap the screen. Meshes without bounds are always visible.
+			 **/
+			bool IsOnScreen2D(DrawItem const& item) const;
+
+			/**
+			 * Updates the leafs of the 3d items in the tree if their world or bounds changed and flags
+			 * every object within the frustum of the 3d camera with the current frame
+			 *
+			 * @param items		The whole draw list, only the 3d items are used
+			 **/
+			void UpdateCulling3D(std::vector<DrawItem> const& items);
+
+			/**
+			 * Removes the object from the 3d culling tree
+			 *
+			 * @note Needs to be called before the object is deleted
+			 **/
+			void RemoveFromCulling(Object* pObject);
+
 			/**
 			 * Renders the next available image and presents it
 			 **/
-			void Draw() const;
+			void Draw();
 
 			/**
 			 * Returns if the renderer is idle
 			 **/
 			void WaitTillIdle() const;
 
+			/**
+			 * (Re)creates the timestamp query pool for the current amount of swapchain images
+			 **/
+			void CreateTimestampPool();
+
+			/**
+			 * Reads back the timestamps of the swapchain image passed in if they were submitted
+			 * before. The image's command buffers need to be finished (their fence signaled).
+			 **/
+			void ReadTimestamps(uint32_t imageIndex);
+
 
 			/* @brief Delete copy/move constructor/assignements */
 			Renderer(Renderer const&) = delete;
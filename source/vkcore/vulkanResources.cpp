@@ -9,6 +9,8 @@
 #include <cmath>
 
 #include "eehelper.h"
+#include "eeimage.h"
+#include "eeprofiler.h"
 
 ///////////////
 // STB IMAGE //
@@ -22,6 +24,29 @@
 #define ALLOCATOR (EEDEVICE->pAllocator)
 
 
+namespace {
+
+	/* @brief Returns wether the feature a compressed format needs was enabled on the device */
+	bool IsCompressionEnabled(VkFormat format, VkPhysicalDeviceFeatures const& enabledFeatures)
+	{
+		if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK) {
+			return enabledFeatures.textureCompressionBC == VK_TRUE;
+		}
+		if (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK) {
+			return enabledFeatures.textureCompressionETC2 == VK_TRUE;
+		}
+		return true;
+	}
+
+	/* @brief Returns wether the format stores srgb colors */
+	bool IsSrgb(VkFormat format)
+	{
+		return format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+			|| format == VK_FORMAT_BC3_SRGB_BLOCK;
+	}
+}
+
+
 //-------------------------------------------------------------------
 // Predefined Vertex
 //-------------------------------------------------------------------
@@ -83,6 +108,16 @@ EE::Texture::Texture(vulkan::Renderer const* pRenderer, char const* fileName,
 	// Store option to not use normalized coords
 	this->unnormalizedCoordinates = unnormalizedCoordinates;
 
+	// Compressed containers hold their levels already
+	if (vulkan::tools::isTextureFile(fileName)) {
+		if (!LoadTextureFile(fileName)) {
+			EE_PRINT("[TEXTURE] Failed to load texture file %s \n", fileName);
+			tools::exitFatal("Failed to load texture file!\n");
+		}
+		isInitialized = true;
+		return;
+	}
+
 	// Get the primitive data of the image
 	int width, height;
 	data.pixels = stbi_load(fileName, &width, &height, &data.channels, STBI_rgb_alpha);
@@ -97,15 +132,7 @@ EE::Texture::Texture(vulkan::Renderer const* pRenderer, char const* fileName,
 	data.width = uint32_t(width);
 	data.height = uint32_t(height);
 
-	if (mipMapping) {
-		// Check if linear blitting is supported since it is needed for generating the different
-		// mip levels. If not keep the miplevel value to 1
-		VkFormatProperties formatProperties;
-		vkGetPhysicalDeviceFormatProperties(EEDEVICE->physicalDevice, format, &formatProperties);
-		if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) {
-			mipLevels = uint32_t(std::floor(std::log2(std::max(width, height)))) + 1u;
-		}
-	}
+	if (mipMapping) SetupMipLevels();
 
 	// Data loaded and different vk settings specified
 	isInitialized = true;
@@ -154,6 +181,11 @@ EE::Texture::Texture(vulkan::Renderer const* pRenderer, EETextureCreateInfo cons
 		data.channels = 4;
 		break;
 
+	case EE_FORMAT_R8G8B8A8_SNORM:
+		format = VK_FORMAT_R8G8B8A8_SNORM;
+		data.channels = 4;
+		break;
+
 	default:
 		format = VK_FORMAT_UNDEFINED;
 		data.channels = -1;
@@ -170,6 +202,15 @@ EE::Texture::Texture(vulkan::Renderer const* pRenderer, EETextureCreateInfo cons
 	data.pixels = new unsigned char[bufferSize];
 	memcpy(data.pixels, textureCInfo.pData, bufferSize);
 
+	// Averaging integer or signed bytes would give wrong values
+	if (textureCInfo.enableMipMapping) {
+		if (format == VK_FORMAT_R8_UNORM || format == VK_FORMAT_R8G8B8A8_UNORM) {
+			SetupMipLevels();
+		} else {
+			EE_PRINT("[TEXTURE] Mip mapping is only supported for unorm formats, the texture keeps one level!\n");
+		}
+	}
+
 	isInitialized = true;
 }
 
@@ -177,6 +218,7 @@ EE::Texture::~Texture()
 {
 	if (isInitialized) {
 		delete[] data.pixels;
+		vulkan::tools::closeTextureFile(file);
 
 		isInitialized = false;
 	}
@@ -185,21 +227,117 @@ EE::Texture::~Texture()
 		vkDestroySampler(LDEVICE, sampler, ALLOCATOR);
 		vkDestroyImageView(LDEVICE, imageView, ALLOCATOR);
 		vkDestroyImage(LDEVICE, image, ALLOCATOR);
-		vkFreeMemory(LDEVICE, imageMemory, ALLOCATOR);
+		EEDEVICE->FreeMemory(imageMemory);
 
 		isUploaded = false;
 	}
 }
 
+bool EE::Texture::LoadTextureFile(char const* fileName)
+{
+	data.pixels = nullptr;
+	if (!vulkan::tools::openTextureFile(fileName, file)) return false;
+
+	data.width = file.width;
+	data.height = file.height;
+	data.channels = 4;
+	format = file.format;
+	mipLevels = (unnormalizedCoordinates) ? 1u : uint32_t(file.levels.size());
+	levels.assign(file.levels.begin(), file.levels.begin() + mipLevels);
+
+	// Use the data of the file as it is if the device can sample the format
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(EEDEVICE->physicalDevice, format, &formatProperties);
+	if ((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+			&& IsCompressionEnabled(format, EEDEVICE->enabledFeatures)) {
+		return true;
+	}
+
+	// Otherwise decode every level to RGBA8
+	VkDeviceSize decodedSize = 0u;
+	for (vulkan::MipLevel& level : levels) {
+		level.offset = decodedSize;
+		level.size = VkDeviceSize(level.width) * level.height * 4u;
+		decodedSize += level.size;
+	}
+
+	data.pixels = new unsigned char[decodedSize];
+	for (size_t i = 0u; i < levels.size(); i++) {
+		if (!vulkan::tools::decodeBlocks(file.format, file.pData + file.levels[i].offset, levels[i].width, levels[i].height,
+																		 data.pixels + levels[i].offset)) {
+			EE_PRINTA("[TEXTURE] Format %d of %s is neither supported by the device nor decodable!\n", int(file.format), fileName);
+			delete[] data.pixels;
+			data.pixels = nullptr;
+			vulkan::tools::closeTextureFile(file);
+			return false;
+		}
+	}
+	format = (IsSrgb(file.format)) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	vulkan::tools::closeTextureFile(file);
+
+	EE_PRINTA("[TEXTURE] %s decoded on the CPU since the device can't sample its format\n", fileName);
+	return true;
+}
+
+void EE::Texture::SetupMipLevels()
+{
+	// Samplers with unnormalized coordinates can only sample views of a single level
+	if (unnormalizedCoordinates) {
+		mipLevels = 1u;
+		return;
+	}
+
+	mipLevels = tools::mipLevelCount(data.width, data.height);
+	if (mipLevels == 1u) return;
+
+	// Blits are done on the device, but need linear filtering of the format
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(EEDEVICE->physicalDevice, format, &formatProperties);
+	if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) return;
+
+	// Build the chain behind the base level and upload all levels like the ones of a file
+	std::vector<tools::ImageLevel> imageLevels;
+	size_t chainSize = tools::mipChainLayout(data.width, data.height, uint32_t(data.channels), mipLevels, imageLevels);
+	unsigned char* pChain = new unsigned char[chainSize];
+	memcpy(pChain, data.pixels, imageLevels[0].size);
+	tools::generateMipChain(pChain, uint32_t(data.channels), imageLevels);
+
+	delete[] data.pixels;
+	data.pixels = pChain;
+
+	levels.resize(imageLevels.size());
+	for (size_t i = 0u; i < imageLevels.size(); i++) {
+		levels[i].offset = imageLevels[i].offset;
+		levels[i].size = imageLevels[i].size;
+		levels[i].width = imageLevels[i].width;
+		levels[i].height = imageLevels[i].height;
+	}
+}
+
 void EE::Texture::Upload()
 {
+	EE_PROFILE_SCOPE("Texture::Upload");
+
 	if (isUploaded) {
 		EE_PRINT("[TEXTURE] Texture already uploaded!\n");
 		return;
 	}
+	if (!isInitialized) {
+		EE_PRINT("[TEXTURE] Texture has no data to upload!\n");
+		return;
+	}
 
-	// Compute image size
+	// Levels from a file or the CPU are copied as they are, otherwise they are generated from the base level
+	bool generateLevels = mipLevels > 1u && levels.empty();
+
+	// Compute image size, with levels the size of the range they cover
 	VkDeviceSize imageSize = data.width * data.height * data.channels;
+	void const* pImageData = data.pixels;
+	if (!levels.empty()) {
+		imageSize = 0u;
+		for (vulkan::MipLevel const& level : levels) imageSize = std::max(imageSize, level.offset + level.size);
+	}
+	if (file.pData) pImageData = file.pData;
 
 	// Create the pure (empty) image and allocate its memory
 	{
@@ -208,7 +346,7 @@ void EE::Texture::Upload()
 		// If we have more than one mip level we will need to generate the different mip levels
 		// from the base mip level. So we would also need to set the image as a transfer src.
 		VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-		if (mipLevels > 1u) usageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		if (generateLevels) usageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
 		VkImageCreateInfo imageCInfo;
 		imageCInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -219,7 +357,8 @@ void EE::Texture::Upload()
 		imageCInfo.extent = { data.width, data.height, 1u };
 		imageCInfo.mipLevels = mipLevels;
 		imageCInfo.arrayLayers = 1u;
-		imageCInfo.samples = pRenderer->settings.sampleCount;
+		// Images with several levels or that are copied into can't be multisampled
+		imageCInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageCInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 		imageCInfo.usage = usageFlags;
 		imageCInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -234,7 +373,7 @@ void EE::Texture::Upload()
 		allocInfo.allocationSize = memReqs.size;
 		allocInfo.memoryTypeIndex =
 			EEDEVICE->GetMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-		VK_CHECK(vkAllocateMemory(LDEVICE, &allocInfo, ALLOCATOR, &imageMemory));
+		VK_CHECK(EEDEVICE->AllocateMemory(allocInfo, EE_MEMORY_CATEGORY_TEXTURE, &imageMemory));
 
 		vkBindImageMemory(LDEVICE, image, imageMemory, 0);
 	}
@@ -247,10 +386,11 @@ void EE::Texture::Upload()
 		EEDEVICE->CreateBuffer(
 			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			EE_MEMORY_CATEGORY_STAGING,
 			imageSize,
 			&stagingBuffer,
 			&stagingBufferMemory,
-			data.pixels);
+			pImageData);
 
 		// Get a cmd buffer that will be used to transfer the layout and copy to the image
 		vulkan::ExecBuffer execBuffer(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
@@ -264,21 +404,36 @@ void EE::Texture::Upload()
 																VK_IMAGE_LAYOUT_PREINITIALIZED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 																VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-		// Copy from buffer to image
-		vulkan::tools::bufferImageCopy(execBuffer.cmdBuffer,
-																	 stagingBuffer,
-																	 image,
-																	 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-																	 VK_IMAGE_ASPECT_COLOR_BIT,
-																	 data.width, data.height);
+		// Copy from buffer to image, all levels with one copy
+		if (levels.empty()) {
+			vulkan::tools::bufferImageCopy(execBuffer.cmdBuffer,
+																		 stagingBuffer,
+																		 image,
+																		 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+																		 VK_IMAGE_ASPECT_COLOR_BIT,
+																		 data.width, data.height);
+		} else {
+			std::vector<VkBufferImageCopy> copyRegions(levels.size());
+			for (size_t i = 0u; i < levels.size(); i++) {
+				copyRegions[i] = {};
+				copyRegions[i].bufferOffset = levels[i].offset;
+				copyRegions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				copyRegions[i].imageSubresource.mipLevel = uint32_t(i);
+				copyRegions[i].imageSubresource.layerCount = 1u;
+				copyRegions[i].imageExtent = { levels[i].width, levels[i].height, 1u };
+			}
+			vkCmdCopyBufferToImage(execBuffer.cmdBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+														 uint32_t(copyRegions.size()), copyRegions.data());
+		}
 
 		// End recording and execute
 		execBuffer.EndRecording();
 		execBuffer.Execute();
 
-		// Free staging buffer
+		// Free staging buffer, the file isn't needed anymore
 		vkDestroyBuffer(LDEVICE, stagingBuffer, ALLOCATOR);
-		vkFreeMemory(LDEVICE, stagingBufferMemory, ALLOCATOR);
+		EEDEVICE->FreeMemory(stagingBufferMemory);
+		vulkan::tools::closeTextureFile(file);
 	}
 
 	// Finish the image
@@ -289,7 +444,7 @@ void EE::Texture::Upload()
 		vulkan::ExecBuffer execBuffer(EEDEVICE, VK_COMMAND_BUFFER_LEVEL_PRIMARY, true, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
 		// If there are multiple mipmap levels generate these
-		if (mipLevels > 1u) {
+		if (generateLevels) {
 			vulkan::tools::generateMipmaps(execBuffer.cmdBuffer,
 																		 image,
 																		 format,
@@ -299,7 +454,7 @@ void EE::Texture::Upload()
 			vulkan::tools::imageBarrier(execBuffer.cmdBuffer,
 																	image,
 																	VK_IMAGE_ASPECT_COLOR_BIT,
-																	1u,
+																	mipLevels,
 																	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 																	VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
 		}
@@ -390,7 +545,7 @@ EE::Buffer::~Buffer()
 {
 	if (isCreated) {
 		// Free the vulkan buffer handles
-		vkFreeMemory(pDevice->logicalDevice, bufferMemory, pDevice->pAllocator);
+		pDevice->FreeMemory(bufferMemory);
 		vkDestroyBuffer(pDevice->logicalDevice, buffer, pDevice->pAllocator);
 
 		isCreated = false;
@@ -406,6 +561,7 @@ void EE::Buffer::Create(VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryPr
 	// Create the buffer
 	VK_CHECK(pDevice->CreateBuffer(settings.usage,
 		settings.memoryProperties,
+		EE_MEMORY_CATEGORY_BUFFER,
 		bufferSize,
 		&buffer, &bufferMemory));
 
@@ -414,6 +570,8 @@ void EE::Buffer::Create(VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryPr
 
 void EE::Buffer::Update(void const* pData) const
 {
+	EE_PROFILE_SCOPE("Buffer::Update");
+
 	if (!isCreated) {
 		EE_PRINT("[BUFFER] Please create the buffer before trying to update it!\n");
 		return;
@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 
 #include "vulkanRenderer.h"
+#include "vulkanTextureFile.h"
 
 namespace EE
 {
@@ -55,6 +56,13 @@ namespace EE
 
 		/* @brief Amount of mipmap levels */
 		uint32_t mipLevels{ 1u };
+		/**
+		 * Levels that are uploaded as they are instead of being generated from the base level,
+		 * their offsets are relative to the begin of the file data or pixels
+		 **/
+		std::vector<vulkan::MipLevel> levels;
+		/* @brief KTX2/DDS file the levels are copied from, closed after the upload */
+		vulkan::TextureFile file;
 		/* @brief Indicates wether this textures coordinates will be interpreted as normalized */
 		bool unnormalizedCoordinates{ false };
 		/* @brief Indicates that this texture is ready to be created */
@@ -63,11 +71,12 @@ namespace EE
 		bool isUploaded{ false };
 
 		/**
-		 * Default constructor: loads the image data
+		 * Default constructor: loads the image data. KTX2 and DDS files are uploaded with the levels
+		 * they contain (mipMapping is ignored for them).
 		 *
 		 * @param pRenderer								Pointer to the renderer to use
 		 * @param fileName								Destination of the image file to load/represent
-		 * @param mipMapping							If set to true mipmap levels will be created
+		 * @param mipMapping							If set to true mipmap levels will be created (by blits or on the CPU)
 		 * @param unnormalizedCoordinates Set to true to not use normalized coords [0,1]
 		 **/
 		Texture(
@@ -95,6 +104,21 @@ namespace EE
 		 **/
 		void Upload();
 
+		/**
+		 * Opens a KTX2/DDS file. If the device can't sample its format, BC1-5 blocks are decoded
+		 * to RGBA8 here, other formats fail.
+		 *
+		 * @return False if the file couldn't be used
+		 **/
+		bool LoadTextureFile(char const* fileName);
+
+		/**
+		 * Sets up the mip levels of the pixels. With linear blit support for the format they are
+		 * generated on the device while uploading, otherwise the chain is built here and uploaded
+		 * with one copy. Textures with unnormalized coordinates keep a single level.
+		 **/
+		void SetupMipLevels();
+
 
 		/* @brief Delete copy/move constructor/assignements */
 		Texture(Texture const&) = delete;
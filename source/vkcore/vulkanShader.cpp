@@ -26,6 +26,7 @@ EE::Shader::Shader(vulkan::Renderer const* pRenderer, EEShaderCreateInfo const&
 
 	// Store settings
 	settings.is2DShader = shaderCInfo.is2DShader;
+	settings.indirectDraw = shaderCInfo.indirectDraw;
 	settings.maxObjects = shaderCInfo.amountObjects;
 	settings.amountDescriptors = shaderCInfo.amountDescriptors;
 	settings.pDescriptors = new EEDescriptorDesc[settings.amountDescriptors];
@@ -216,7 +217,7 @@ bool EE::Shader::Create()
 	}
 
 	// Now create the pipeline
-	pPipeline->Create((settings.amountDescriptors) ? &descriptorSetLayout : nullptr, settings.is2DShader);
+	pPipeline->Create((settings.amountDescriptors) ? &descriptorSetLayout : nullptr, settings.is2DShader, settings.indirectDraw);
 
 	// Shader is successfully created and descriptor sets can be created and updated to the
 	// data desired until the maximum of objects passed in is reached
@@ -300,9 +301,31 @@ bool EE::Shader::UpdateDescriptorSet(VkDescriptorSet descriptorSet,
 	return true;
 }
 
-void EE::Shader::Record(VkCommandBuffer cmdBuffer, VkDescriptorSet const* pDescriptorSet) const
+void EE::Shader::UpdateDescriptorTexture(VkDescriptorSet descriptorSet, uint32_t binding, Texture const* pTexture) const
+{
+	VkDescriptorImageInfo imageInfo;
+	imageInfo.sampler = pTexture->sampler;
+	imageInfo.imageView = pTexture->imageView;
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkWriteDescriptorSet writeDescriptorSet;
+	writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writeDescriptorSet.pNext = nullptr;
+	writeDescriptorSet.dstSet = descriptorSet;
+	writeDescriptorSet.dstBinding = binding;
+	writeDescriptorSet.dstArrayElement = 0u;
+	writeDescriptorSet.descriptorCount = 1u;
+	writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	writeDescriptorSet.pImageInfo = &imageInfo;
+	writeDescriptorSet.pBufferInfo = nullptr;
+	writeDescriptorSet.pTexelBufferView = nullptr;
+	vkUpdateDescriptorSets(LDEVICE, 1u, &writeDescriptorSet, 0u, nullptr);
+}
+
+void EE::Shader::Record(VkCommandBuffer cmdBuffer, VkDescriptorSet const* pDescriptorSet, vulkan::RecordStats* pStats) const
 {
 	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->pipeline);
+	if (pStats) pStats->pipelineBinds++;
 
 	if (pushConstant.pData) {
 		vkCmdPushConstants(cmdBuffer, pPipeline->pipelineLayout, pushConstant.shaderStage,
@@ -311,5 +334,6 @@ void EE::Shader::Record(VkCommandBuffer cmdBuffer, VkDescriptorSet const* pDescr
 	if (settings.amountDescriptors && pDescriptorSet) {
 		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->pipelineLayout,
 														0u, 1u, pDescriptorSet, 0u, nullptr);
+		if (pStats) pStats->descriptorBinds++;
 	}
 }
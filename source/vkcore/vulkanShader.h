@@ -43,6 +43,8 @@ namespace EE
 		/* @brief Holds settings of this shader needed during the whole lifetime of this shader */
 		struct {
 			bool is2DShader;
+			/* @brief Objects are drawn with indirect draws and read their world from the renderer's draw data */
+			bool indirectDraw;
 			uint32_t maxObjects;
 			uint32_t amountDescriptors{ 0u };
 			EEDescriptorDesc* pDescriptors;
@@ -104,13 +106,27 @@ namespace EE
 			std::vector<Texture*> const&								textures,
 			std::vector<Buffer*> const&									buffers) const;
 
+		/**
+		 * Binds another texture to one sampler of the descriptor set, the other bindings stay as they are.
+		 * The descriptor set must not be used by a pending command buffer.
+		 *
+		 * @param descriptorSet		The descriptor set that is to update
+		 * @param binding					Binding of the sampler
+		 * @param pTexture				The texture that will be bound
+		 **/
+		void UpdateDescriptorTexture(
+			VkDescriptorSet descriptorSet,
+			uint32_t				binding,
+			Texture const*	pTexture) const;
+
 		/**
 		 * Records this shader into the passed in command buffer
 		 *
 		 * @param cmdBuffer			Command buffer this shader will be recorded to
 		 * @param pDescriptorSet	If descriptors are used in this shader this set will be recorded too
+		 * @param pStats				Counts of the recorded commands that will be incremented (optional)
 		 **/
-		void Record(VkCommandBuffer cmdBuffer, VkDescriptorSet const* pDescriptorSet = nullptr) const;
+		void Record(VkCommandBuffer cmdBuffer, VkDescriptorSet const* pDescriptorSet = nullptr, vulkan::RecordStats* pStats = nullptr) const;
 
 
 		/* @brief Delete copy/move constructor/assignements */
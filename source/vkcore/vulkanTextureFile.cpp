@@ -0,0 +1,376 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: vulkanTextureFile.cpp
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#include "vulkanTextureFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+/* @brief File identifiers */
+#define DDS_MAGIC 0x20534444u	//< "DDS "
+#define FOURCC(a, b, c, d) (uint32_t(a) | (uint32_t(b) << 8u) | (uint32_t(c) << 16u) | (uint32_t(d) << 24u))
+
+/* @brief DDS header flags */
+#define DDSD_MIPMAPCOUNT 0x20000u
+#define DDPF_FOURCC 0x4u
+#define DDPF_RGB 0x40u
+#define DDSCAPS2_CUBEMAP 0x200u
+#define DDSCAPS2_VOLUME 0x200000u
+
+/* @brief Sizes of the headers in front of the data */
+#define DDS_HEADER_SIZE 128u
+#define DDS_HEADER_DXT10_SIZE 20u
+#define KTX2_HEADER_SIZE 80u
+#define KTX2_LEVEL_INDEX_SIZE 24u
+
+
+namespace {
+
+	static unsigned char const KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	template<typename T>
+	inline T Read(unsigned char const* pData, size_t offset)
+	{
+		T value;
+		memcpy(&value, pData + offset, sizeof(T));
+		return value;
+	}
+
+	inline bool EndsWith(char const* str, char const* suffix)
+	{
+		size_t length = strlen(str), suffixLength = strlen(suffix);
+		if (suffixLength > length) return false;
+		for (size_t i = 0u; i < suffixLength; i++) {
+			char c = str[length - suffixLength + i];
+			if (c >= 'A' && c <= 'Z') c = char(c - 'A' + 'a');
+			if (c != suffix[i]) return false;
+		}
+		return true;
+	}
+
+	/* @brief Returns the format of a DXGI_FORMAT of the DX10 header */
+	VkFormat DxgiToVk(uint32_t dxgiFormat)
+	{
+		switch (dxgiFormat)
+		{
+		case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+		case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+		case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+		case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+		case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+		case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+		case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+		case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+		case 87: return VK_FORMAT_B8G8R8A8_UNORM;
+		case 91: return VK_FORMAT_B8G8R8A8_SRGB;
+		case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+		case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+		default: return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	/* @brief Reads the header of a DDS file, the levels follow each other directly */
+	bool ParseDds(unsigned char const* pData, size_t size, EE::vulkan::TextureFile& textureFile, uint32_t& amountLevelsOut, size_t& dataOffsetOut)
+	{
+		if (size < DDS_HEADER_SIZE || Read<uint32_t>(pData, 0u) != DDS_MAGIC || Read<uint32_t>(pData, 4u) != 124u) return false;
+
+		uint32_t flags = Read<uint32_t>(pData, 8u);
+		textureFile.height = Read<uint32_t>(pData, 12u);
+		textureFile.width = Read<uint32_t>(pData, 16u);
+		amountLevelsOut = (flags & DDSD_MIPMAPCOUNT) ? std::max(1u, Read<uint32_t>(pData, 28u)) : 1u;
+		if (Read<uint32_t>(pData, 112u) & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) return false;
+
+		uint32_t pixelFormatFlags = Read<uint32_t>(pData, 80u);
+		uint32_t fourCC = Read<uint32_t>(pData, 84u);
+		dataOffsetOut = DDS_HEADER_SIZE;
+
+		if ((pixelFormatFlags & DDPF_FOURCC) && fourCC == FOURCC('D', 'X', '1', '0')) {
+			if (size < DDS_HEADER_SIZE + DDS_HEADER_DXT10_SIZE) return false;
+			// Only single 2D textures (resource dimension 3, array size 1)
+			if (Read<uint32_t>(pData, 132u) != 3u || Read<uint32_t>(pData, 140u) > 1u) return false;
+			textureFile.format = DxgiToVk(Read<uint32_t>(pData, 128u));
+			dataOffsetOut += DDS_HEADER_DXT10_SIZE;
+
+		} else if (pixelFormatFlags & DDPF_FOURCC) {
+			switch (fourCC)
+			{
+			case FOURCC('D', 'X', 'T', '1'): textureFile.format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK; break;
+			case FOURCC('D', 'X', 'T', '5'): textureFile.format = VK_FORMAT_BC3_UNORM_BLOCK; break;
+			case FOURCC('A', 'T', 'I', '1'):
+			case FOURCC('B', 'C', '4', 'U'): textureFile.format = VK_FORMAT_BC4_UNORM_BLOCK; break;
+			case FOURCC('A', 'T', 'I', '2'):
+			case FOURCC('B', 'C', '5', 'U'): textureFile.format = VK_FORMAT_BC5_UNORM_BLOCK; break;
+			default: textureFile.format = VK_FORMAT_UNDEFINED;
+			}
+
+		} else if ((pixelFormatFlags & DDPF_RGB) && Read<uint32_t>(pData, 88u) == 32u) {
+			// 32 bit RGBA, the red mask tells the channel order
+			uint32_t redMask = Read<uint32_t>(pData, 92u);
+			textureFile.format = (redMask == 0x000000FFu) ? VK_FORMAT_R8G8B8A8_UNORM
+				: (redMask == 0x00FF0000u) ? VK_FORMAT_B8G8R8A8_UNORM : VK_FORMAT_UNDEFINED;
+		}
+
+		return textureFile.format != VK_FORMAT_UNDEFINED;
+	}
+
+	/* @brief Reads the header of a KTX2 file, the levels are stored from the smallest to the biggest */
+	bool ParseKtx2(unsigned char const* pData, size_t size, EE::vulkan::TextureFile& textureFile, uint32_t& amountLevelsOut)
+	{
+		if (size < KTX2_HEADER_SIZE || memcmp(pData, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) return false;
+
+		textureFile.format = VkFormat(Read<uint32_t>(pData, 12u));
+		textureFile.width = Read<uint32_t>(pData, 20u);
+		textureFile.height = Read<uint32_t>(pData, 24u);
+
+		// Only single 2D textures without supercompression (BasisLZ/zstd would need a transcoder)
+		if (Read<uint32_t>(pData, 28u) > 1u || Read<uint32_t>(pData, 32u) > 1u || Read<uint32_t>(pData, 36u) != 1u) return false;
+		if (Read<uint32_t>(pData, 44u) != 0u) return false;
+
+		amountLevelsOut = std::max(1u, Read<uint32_t>(pData, 40u));
+		return size >= KTX2_HEADER_SIZE + size_t(amountLevelsOut) * KTX2_LEVEL_INDEX_SIZE;
+	}
+
+	/* @brief Expands a RGB565 color */
+	inline void DecodeColor565(uint16_t color, unsigned char* pOut)
+	{
+		uint32_t r = (color >> 11u) & 31u, g = (color >> 5u) & 63u, b = color & 31u;
+		pOut[0] = (unsigned char)((r << 3u) | (r >> 2u));
+		pOut[1] = (unsigned char)((g << 2u) | (g >> 4u));
+		pOut[2] = (unsigned char)((b << 3u) | (b >> 2u));
+		pOut[3] = 255u;
+	}
+
+	/* @brief Decodes the 16 colors of a BC1 block, BC3 blocks always use four colors */
+	void DecodeColorBlock(unsigned char const* pBlock, bool fourColorsOnly, bool hasAlpha, unsigned char pixelsOut[16][4])
+	{
+		uint16_t c0 = Read<uint16_t>(pBlock, 0u), c1 = Read<uint16_t>(pBlock, 2u);
+		uint32_t selectors = Read<uint32_t>(pBlock, 4u);
+
+		unsigned char colors[4][4];
+		DecodeColor565(c0, colors[0]);
+		DecodeColor565(c1, colors[1]);
+		for (uint32_t c = 0u; c < 3u; c++) {
+			if (c0 > c1 || fourColorsOnly) {
+				colors[2][c] = (unsigned char)((2u * colors[0][c] + colors[1][c]) / 3u);
+				colors[3][c] = (unsigned char)((colors[0][c] + 2u * colors[1][c]) / 3u);
+			} else {
+				colors[2][c] = (unsigned char)((colors[0][c] + colors[1][c]) / 2u);
+				colors[3][c] = 0u;
+			}
+		}
+		colors[2][3] = 255u;
+		colors[3][3] = (c0 > c1 || fourColorsOnly || !hasAlpha) ? 255u : 0u;
+
+		for (uint32_t i = 0u; i < 16u; i++) memcpy(pixelsOut[i], colors[(selectors >> (2u * i)) & 3u], 4u);
+	}
+
+	/* @brief Decodes the 16 values of a BC4 block (also the alpha of BC3 and each channel of BC5) */
+	void DecodeChannelBlock(unsigned char const* pBlock, unsigned char valuesOut[16])
+	{
+		uint32_t v0 = pBlock[0], v1 = pBlock[1];
+		unsigned char values[8];
+		values[0] = (unsigned char)v0;
+		values[1] = (unsigned char)v1;
+		if (v0 > v1) {
+			for (uint32_t i = 1u; i < 7u; i++) values[i + 1u] = (unsigned char)(((7u - i) * v0 + i * v1) / 7u);
+		} else {
+			for (uint32_t i = 1u; i < 5u; i++) values[i + 1u] = (unsigned char)(((5u - i) * v0 + i * v1) / 5u);
+			values[6] = 0u;
+			values[7] = 255u;
+		}
+
+		// 16 selectors of 3 bits
+		uint64_t selectors = 0u;
+		for (uint32_t i = 0u; i < 6u; i++) selectors |= uint64_t(pBlock[2u + i]) << (8u * i);
+		for (uint32_t i = 0u; i < 16u; i++) valuesOut[i] = values[(selectors >> (3u * i)) & 7u];
+	}
+}
+
+
+bool EE::vulkan::tools::isTextureFile(char const* fileName)
+{
+	return fileName && (EndsWith(fileName, ".ktx2") || EndsWith(fileName, ".dds"));
+}
+
+bool EE::vulkan::tools::getBlockInfo(VkFormat format, uint32_t& blockSizeOut, uint32_t& blockExtentOut)
+{
+	blockExtentOut = 4u;
+	switch (format)
+	{
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_B8G8R8A8_SRGB:
+		blockSizeOut = 4u;
+		blockExtentOut = 1u;
+		return true;
+
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+	case VK_FORMAT_BC4_SNORM_BLOCK:
+	case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+	case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+	case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+	case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+		blockSizeOut = 8u;
+		return true;
+
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC5_SNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+	case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+	case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+		blockSizeOut = 16u;
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool EE::vulkan::tools::openTextureFile(char const* fileName, TextureFile& textureFileOut)
+{
+	textureFileOut = TextureFile();
+
+	EE::tools::MappedFile file;
+	if (!EE::tools::mapFile(fileName, file)) {
+		EE_PRINTA("[TEXTURE_FILE] Failed to map texture file %s!\n", fileName);
+		return false;
+	}
+	unsigned char const* pData = static_cast<unsigned char const*>(file.pData);
+
+	uint32_t amountLevels = 0u;
+	size_t ddsDataOffset = 0u;
+	bool isKtx2 = file.size >= sizeof(KTX2_IDENTIFIER) && memcmp(pData, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0;
+	bool isValid = (isKtx2) ? ParseKtx2(pData, file.size, textureFileOut, amountLevels)
+		: ParseDds(pData, file.size, textureFileOut, amountLevels, ddsDataOffset);
+
+	uint32_t blockSize, blockExtent;
+	isValid = isValid && textureFileOut.width && textureFileOut.height && getBlockInfo(textureFileOut.format, blockSize, blockExtent);
+	if (!isValid) {
+		EE_PRINTA("[TEXTURE_FILE] %s is no supported KTX2/DDS texture (plain 2D BCn, ETC2 or RGBA8 only)!\n", fileName);
+		EE::tools::unmapFile(file);
+		textureFileOut = TextureFile();
+		return false;
+	}
+
+	// A chain can't be longer than the one down to 1x1
+	uint32_t maxLevels = 1u;
+	while ((std::max(textureFileOut.width, textureFileOut.height) >> maxLevels) > 0u) maxLevels++;
+	amountLevels = std::min(amountLevels, maxLevels);
+
+	// File range of every level
+	uint64_t dataBegin = UINT64_MAX, dataEnd = 0u, ddsOffset = ddsDataOffset;
+	std::vector<uint64_t> fileOffsets(amountLevels);
+	textureFileOut.levels.resize(amountLevels);
+	for (uint32_t i = 0u; i < amountLevels; i++) {
+		MipLevel& level = textureFileOut.levels[i];
+		level.width = std::max(1u, textureFileOut.width >> i);
+		level.height = std::max(1u, textureFileOut.height >> i);
+		level.size = VkDeviceSize((level.width + blockExtent - 1u) / blockExtent) * ((level.height + blockExtent - 1u) / blockExtent) * blockSize;
+
+		if (isKtx2) {
+			size_t indexOffset = KTX2_HEADER_SIZE + size_t(i) * KTX2_LEVEL_INDEX_SIZE;
+			fileOffsets[i] = Read<uint64_t>(pData, indexOffset);
+			if (Read<uint64_t>(pData, indexOffset + 8u) < level.size) isValid = false;
+		} else {
+			fileOffsets[i] = ddsOffset;
+			ddsOffset += level.size;
+		}
+
+		if (fileOffsets[i] > file.size || level.size > file.size - fileOffsets[i]) isValid = false;
+		dataBegin = std::min(dataBegin, fileOffsets[i]);
+		dataEnd = std::max(dataEnd, fileOffsets[i] + level.size);
+	}
+	if (!isValid) {
+		EE_PRINTA("[TEXTURE_FILE] The levels of %s exceed the file!\n", fileName);
+		EE::tools::unmapFile(file);
+		textureFileOut = TextureFile();
+		return false;
+	}
+
+	// All levels lie in one range, their offsets are relative to it so one copy uploads all of them.
+	// A copy needs offsets that are a multiple of the block size and of 4 within the staging buffer.
+	for (uint32_t i = 0u; i < amountLevels; i++) {
+		textureFileOut.levels[i].offset = fileOffsets[i] - dataBegin;
+		if (textureFileOut.levels[i].offset % std::max(blockSize, 4u)) isValid = false;
+	}
+	if (!isValid) {
+		EE_PRINTA("[TEXTURE_FILE] The levels of %s aren't aligned to their blocks!\n", fileName);
+		EE::tools::unmapFile(file);
+		textureFileOut = TextureFile();
+		return false;
+	}
+	textureFileOut.file = file;
+	textureFileOut.pData = pData + dataBegin;
+	textureFileOut.dataSize = dataEnd - dataBegin;
+	return true;
+}
+
+void EE::vulkan::tools::closeTextureFile(TextureFile& textureFile)
+{
+	EE::tools::unmapFile(textureFile.file);
+	textureFile = TextureFile();
+}
+
+bool EE::vulkan::tools::decodeBlocks(VkFormat format, void const* pBlocks, uint32_t width, uint32_t height, unsigned char* pPixelsOut)
+{
+	uint32_t blockSize, blockExtent;
+	if (!getBlockInfo(format, blockSize, blockExtent) || blockExtent != 4u) return false;
+
+	bool isBC1 = format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK
+		|| format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	bool isBC3 = format == VK_FORMAT_BC3_UNORM_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK;
+	bool isBC4 = format == VK_FORMAT_BC4_UNORM_BLOCK;
+	bool isBC5 = format == VK_FORMAT_BC5_UNORM_BLOCK;
+	if (!isBC1 && !isBC3 && !isBC4 && !isBC5) return false;
+
+	bool hasAlpha = format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	unsigned char const* pBlock = static_cast<unsigned char const*>(pBlocks);
+	uint32_t blocksX = (width + 3u) / 4u, blocksY = (height + 3u) / 4u;
+
+	for (uint32_t by = 0u; by < blocksY; by++) {
+		for (uint32_t bx = 0u; bx < blocksX; bx++, pBlock += blockSize) {
+			unsigned char pixels[16][4];
+			unsigned char channel[16];
+
+			if (isBC1) {
+				DecodeColorBlock(pBlock, false, hasAlpha, pixels);
+			} else if (isBC3) {
+				DecodeColorBlock(pBlock + 8u, true, false, pixels);
+				DecodeChannelBlock(pBlock, channel);
+				for (uint32_t i = 0u; i < 16u; i++) pixels[i][3] = channel[i];
+			} else {
+				// Red (and green for BC5), the other channels read as 0 and alpha as 1
+				DecodeChannelBlock(pBlock, channel);
+				for (uint32_t i = 0u; i < 16u; i++) {
+					pixels[i][0] = channel[i];
+					pixels[i][1] = pixels[i][2] = 0u;
+					pixels[i][3] = 255u;
+				}
+				if (isBC5) {
+					DecodeChannelBlock(pBlock + 8u, channel);
+					for (uint32_t i = 0u; i < 16u; i++) pixels[i][1] = channel[i];
+				}
+			}
+
+			// Blocks at the border may be partially outside of the level
+			for (uint32_t y = 0u; y < 4u && by * 4u + y < height; y++) {
+				for (uint32_t x = 0u; x < 4u && bx * 4u + x < width; x++) {
+					memcpy(pPixelsOut + (size_t(by * 4u + y) * width + bx * 4u + x) * 4u, pixels[y * 4u + x], 4u);
+				}
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,77 @@
+/////////////////////////////////////////////////////////////////////
+// Filename: vulkanTextureFile.h
+//
+// (C) Copyright 2019 Madness Studio. All Rights Reserved
+/////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "vulkanTools.h"
+#include "eehelper.h"
+
+namespace EE
+{
+	namespace vulkan
+	{
+		/* @brief Offset and size of one mip level within the data of a texture */
+		struct MipLevel {
+			VkDeviceSize offset;
+			VkDeviceSize size;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		/**
+		 * A KTX2 or DDS texture mapped into memory. The levels of these containers are already in the
+		 * layout the device expects (e.g. BCn blocks), so they are copied into the staging buffer
+		 * straight out of the file. All levels lie in one range of the file, the offsets of the
+		 * levels are relative to its begin.
+		 **/
+		struct TextureFile {
+			EE::tools::MappedFile file;
+			VkFormat format{ VK_FORMAT_UNDEFINED };
+			uint32_t width{ 0u };
+			uint32_t height{ 0u };
+			unsigned char const* pData{ nullptr };
+			VkDeviceSize dataSize{ 0u };
+			std::vector<MipLevel> levels;
+		};
+
+		namespace tools {
+
+			/* @brief Returns wether the file is a KTX2 or DDS container (judged by its extension) */
+			extern bool isTextureFile(char const* fileName);
+
+			/**
+			 * Maps a KTX2 or DDS file and reads its format and levels. Only plain 2D textures
+			 * (no arrays, cube maps or supercompression) of the formats getBlockInfo knows are supported.
+			 *
+			 * @param fileName				Destination of the texture file
+			 * @param textureFileOut	Will hold the view of the file (must be released with closeTextureFile)
+			 *
+			 * @return False if the file couldn't be mapped or isn't supported
+			 **/
+			extern bool openTextureFile(char const* fileName, TextureFile& textureFileOut);
+			extern void closeTextureFile(TextureFile& textureFile);
+
+			/**
+			 * Returns the size in bytes of one block of the format and the amount of pixels it covers in
+			 * each dimension (one for uncompressed formats), false if the format isn't supported
+			 **/
+			extern bool getBlockInfo(VkFormat format, uint32_t& blockSizeOut, uint32_t& blockExtentOut);
+
+			/**
+			 * Decodes one level of BC1/BC3/BC4/BC5 blocks to RGBA8 on the CPU, for devices that can't
+			 * sample these formats. BC7 and ETC2 can only be used if the device supports them.
+			 *
+			 * @param format			Format of the blocks
+			 * @param pBlocks			Pointer to the blocks of the level
+			 * @param width				Width of the level in pixels
+			 * @param height			Height of the level in pixels
+			 * @param pPixelsOut	Destination of width * height RGBA8 pixels
+			 *
+			 * @return False if the format can't be decoded
+			 **/
+			extern bool decodeBlocks(VkFormat format, void const* pBlocks, uint32_t width, uint32_t height, unsigned char* pPixelsOut);
+		}
+	}
+}
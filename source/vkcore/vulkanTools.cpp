@@ -18,8 +18,15 @@ VkFormat EE::vulkan::tools::eeToVk(EEFormat format)
 		FCASE(R32G32B32_SFLOAT);
 		FCASE(R8_UINT);
 		FCASE(R8_UNORM);
+		FCASE(R8_SNORM);
 		FCASE(R8G8B8A8_UINT);
 		FCASE(R8G8B8A8_UNORM);
+		FCASE(R16G16_SFLOAT);
+		FCASE(R16G16B16A16_SFLOAT);
+		FCASE(R16G16B16A16_SNORM);
+		FCASE(R8G8B8A8_SNORM);
+		FCASE(A2B10G10R10_UNORM_PACK32);
+		FCASE(A2B10G10R10_SNORM_PACK32);
 	default: return VK_FORMAT_UNDEFINED;
 	}
 #undef FCASE